@@ -0,0 +1,24 @@
+#!/bin/bash
+# Run the bot as several local processes sharing one token and one assets directory.
+# Usage: ./run_local_clusters.sh [clusters] [shards] [binary]
+# Every process starts the shards with shard % clusters == its cluster id, posts only to the
+# channels of its own guilds and logs to botpp-cluster<N>.log. Ctrl+C stops all of them.
+set -e
+CLUSTERS="${1:-2}"
+SHARDS="${2:-$CLUSTERS}"
+BINARY="${3:-./build/standalone/default/debug/botpp}"
+
+if [ ! -x "$BINARY" ]; then
+  echo "Bot binary not found: $BINARY (build it with ./build_default_debug.sh)" >&2
+  exit 1
+fi
+
+PIDS=()
+trap 'kill -TERM "${PIDS[@]}" 2>/dev/null; wait' INT TERM
+for ((CLUSTER = 0; CLUSTER < CLUSTERS; CLUSTER++)); do
+  BOTPP_SHARD_COUNT="$SHARDS" BOTPP_CLUSTER_ID="$CLUSTER" BOTPP_MAX_CLUSTERS="$CLUSTERS" \
+    "$BINARY" > "botpp-cluster$CLUSTER.log" 2>&1 &
+  PIDS+=($!)
+  echo "Cluster $CLUSTER/$CLUSTERS started as PID $!"
+done
+wait
@@ -0,0 +1,387 @@
+#include "DeliveryArchive.hpp"
+#include <Logger/Logger.hpp>
+#include <zlib.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+  constexpr char BLOCK_MAGIC[4] = { 'D', 'A', 'B', '1' };
+  // magic, record count, raw size, compressed size, first and last posting time
+  constexpr size_t BLOCK_HEADER_SIZE = 4 + 4 + 4 + 4 + 8 + 8;
+
+  void putVarint (std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+      out += static_cast<char> ((value & 0x7F) | 0x80);
+      value >>= 7;
+    }
+    out += static_cast<char> (value);
+  }
+
+  bool getVarint (const char*& pos, const char* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; pos < end && shift < 64; shift += 7) {
+      unsigned char byte = static_cast<unsigned char> (*pos++);
+      value |= static_cast<uint64_t> (byte & 0x7F) << shift;
+      if (!(byte & 0x80))
+        return true;
+    }
+    return false;
+  }
+
+  void putString (std::string& out, const std::string& value) {
+    putVarint (out, value.size ());
+    out += value;
+  }
+
+  bool getString (const char*& pos, const char* end, std::string& value) {
+    uint64_t length = 0;
+    if (!getVarint (pos, end, length) || length > static_cast<uint64_t> (end - pos))
+      return false;
+    value.assign (pos, static_cast<size_t> (length));
+    pos += length;
+    return true;
+  }
+
+  void serialize (std::string& out, const ArchiveRecord& record) {
+    putVarint (out, static_cast<uint64_t> (record.postedAt));
+    putVarint (out, static_cast<uint64_t> (record.queuedAt));
+    putVarint (out, record.channelId);
+    putVarint (out, record.messageId);
+    putString (out, record.sourceUrl);
+    putString (out, record.title);
+    putString (out, record.link);
+  }
+
+  bool deserialize (const char*& pos, const char* end, ArchiveRecord& record) {
+    uint64_t postedAt = 0;
+    uint64_t queuedAt = 0;
+    if (!getVarint (pos, end, postedAt) || !getVarint (pos, end, queuedAt)
+        || !getVarint (pos, end, record.channelId) || !getVarint (pos, end, record.messageId)
+        || !getString (pos, end, record.sourceUrl) || !getString (pos, end, record.title)
+        || !getString (pos, end, record.link))
+      return false;
+    record.postedAt = static_cast<std::time_t> (postedAt);
+    record.queuedAt = static_cast<std::time_t> (queuedAt);
+    return true;
+  }
+
+  std::vector<ArchiveRecord> deserializeAll (const std::string& data) {
+    std::vector<ArchiveRecord> records;
+    const char* pos = data.data ();
+    const char* end = pos + data.size ();
+    ArchiveRecord record;
+    while (pos < end && deserialize (pos, end, record))
+      records.push_back (record);
+    return records;
+  }
+
+  template <typename T> void putFixed (std::string& out, T value) {
+    for (size_t i = 0; i < sizeof (T); ++i)
+      out += static_cast<char> ((static_cast<uint64_t> (value) >> (8 * i)) & 0xFF);
+  }
+
+  template <typename T> T getFixed (const char* pos) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < sizeof (T); ++i)
+      value |= static_cast<uint64_t> (static_cast<unsigned char> (pos[i])) << (8 * i);
+    return static_cast<T> (value);
+  }
+
+  std::string readFile (const std::filesystem::path& path) {
+    std::ifstream in (path, std::ios::binary);
+    return std::string (std::istreambuf_iterator<char> (in), std::istreambuf_iterator<char> ());
+  }
+}
+
+// Read-only private mapping of a whole segment file
+struct DeliveryArchive::MappedSegment {
+  const char* data = nullptr;
+  size_t size = 0;
+
+  explicit MappedSegment (const std::filesystem::path& path) {
+    int fd = ::open (path.c_str (), O_RDONLY);
+    if (fd < 0)
+      return;
+    struct stat info{};
+    if (::fstat (fd, &info) == 0 && info.st_size > 0) {
+      void* mapping = ::mmap (nullptr, static_cast<size_t> (info.st_size), PROT_READ, MAP_PRIVATE,
+                              fd, 0);
+      if (mapping != MAP_FAILED) {
+        data = static_cast<const char*> (mapping);
+        size = static_cast<size_t> (info.st_size);
+      }
+    }
+    ::close (fd);
+  }
+
+  ~MappedSegment () {
+    if (data)
+      ::munmap (const_cast<char*> (data), size);
+  }
+
+  MappedSegment (const MappedSegment&) = delete;
+  MappedSegment& operator= (const MappedSegment&) = delete;
+};
+
+DeliveryArchive::~DeliveryArchive () {
+  close ();
+}
+
+std::string DeliveryArchive::dayOf (std::time_t time) {
+  std::tm utc{};
+  gmtime_r (&time, &utc);
+  char day[16];
+  std::strftime (day, sizeof (day), "%Y-%m-%d", &utc);
+  return day;
+}
+
+std::filesystem::path DeliveryArchive::segmentPath (const std::string& day) const {
+  return directory_ / (day + ".seg");
+}
+
+std::filesystem::path DeliveryArchive::pendingPath (const std::string& day) const {
+  return directory_ / (day + ".pending");
+}
+
+int DeliveryArchive::open (const std::filesystem::path& directory) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  directory_ = directory;
+  std::error_code ec;
+  std::filesystem::create_directories (directory_, ec);
+  if (!std::filesystem::is_directory (directory_)) {
+    LOG_E_STREAM << "Cannot open delivery archive in " << directory_ << std::endl;
+    return -1;
+  }
+
+  days_.clear ();
+  std::vector<std::string> pendingDays;
+  for (const auto& entry : std::filesystem::directory_iterator (directory_)) {
+    std::string day = entry.path ().stem ().string ();
+    if (entry.path ().extension () == ".seg") {
+      days_.insert (day);
+    } else if (entry.path ().extension () == ".pending") {
+      days_.insert (day);
+      pendingDays.push_back (day);
+    }
+  }
+
+  // Records of a finished day are packed right away, the current day keeps collecting
+  currentDay_ = dayOf (std::time (nullptr));
+  pending_.clear ();
+  for (const auto& day : pendingDays) {
+    std::vector<ArchiveRecord> records = deserializeAll (readFile (pendingPath (day)));
+    if (day == currentDay_) {
+      pending_ = std::move (records);
+    } else if (records.empty () || writeBlock (day, records) == 0) {
+      std::filesystem::remove (pendingPath (day), ec);
+    }
+  }
+
+  open_ = true;
+  LOG_I_STREAM << "Delivery archive: " << days_.size () << " daily segments in " << directory_
+               << std::endl;
+  return 0;
+}
+
+void DeliveryArchive::close () {
+  std::lock_guard<std::mutex> lock (mutex_);
+  if (!open_)
+    return;
+  flushLocked ();
+  mapped_.clear ();
+  open_ = false;
+}
+
+int DeliveryArchive::append (const ArchiveRecord& record) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  if (!open_)
+    return -1;
+
+  std::string day = dayOf (record.postedAt);
+  if (day != currentDay_) {
+    // The pending records still belong to currentDay_, switching days would file them wrongly
+    if (flushLocked () != 0)
+      return -1;
+    currentDay_ = day;
+  }
+
+  std::string serialized;
+  serialize (serialized, record);
+  std::ofstream pending (pendingPath (day), std::ios::binary | std::ios::app);
+  pending.write (serialized.data (), static_cast<std::streamsize> (serialized.size ()));
+  pending.flush ();
+  if (!pending.good ())
+    return -1;
+
+  days_.insert (day);
+  pending_.push_back (record);
+  return pending_.size () >= BLOCK_RECORDS ? flushLocked () : 0;
+}
+
+int DeliveryArchive::flush () {
+  std::lock_guard<std::mutex> lock (mutex_);
+  return flushLocked ();
+}
+
+int DeliveryArchive::flushLocked () {
+  if (pending_.empty ())
+    return 0;
+  if (writeBlock (currentDay_, pending_) != 0)
+    return -1;
+  pending_.clear ();
+  std::error_code ec;
+  std::filesystem::remove (pendingPath (currentDay_), ec);
+  return 0;
+}
+
+int DeliveryArchive::writeBlock (const std::string& day, const std::vector<ArchiveRecord>& records) {
+  std::string raw;
+  std::time_t first = records.front ().postedAt;
+  std::time_t last = records.front ().postedAt;
+  for (const auto& record : records) {
+    serialize (raw, record);
+    first = std::min (first, record.postedAt);
+    last = std::max (last, record.postedAt);
+  }
+
+  uLongf compressedSize = compressBound (static_cast<uLong> (raw.size ()));
+  std::string compressed (compressedSize, '\0');
+  if (compress2 (reinterpret_cast<Bytef*> (&compressed[0]), &compressedSize,
+                 reinterpret_cast<const Bytef*> (raw.data ()), static_cast<uLong> (raw.size ()),
+                 Z_BEST_COMPRESSION)
+      != Z_OK) {
+    LOG_E_STREAM << "Failed to compress archive block for " << day << std::endl;
+    return -1;
+  }
+  compressed.resize (compressedSize);
+
+  std::string block (BLOCK_MAGIC, sizeof (BLOCK_MAGIC));
+  putFixed<uint32_t> (block, static_cast<uint32_t> (records.size ()));
+  putFixed<uint32_t> (block, static_cast<uint32_t> (raw.size ()));
+  putFixed<uint32_t> (block, static_cast<uint32_t> (compressed.size ()));
+  putFixed<uint64_t> (block, static_cast<uint64_t> (first));
+  putFixed<uint64_t> (block, static_cast<uint64_t> (last));
+  block += compressed;
+
+  std::ofstream out (segmentPath (day), std::ios::binary | std::ios::app);
+  out.write (block.data (), static_cast<std::streamsize> (block.size ()));
+  out.flush ();
+  if (!out.good ()) {
+    LOG_E_STREAM << "Failed to write archive segment " << segmentPath (day) << std::endl;
+    return -1;
+  }
+  mapped_.erase (day); // a late block for a past day invalidates its mapping
+  days_.insert (day);
+  return 0;
+}
+
+std::shared_ptr<const DeliveryArchive::MappedSegment>
+DeliveryArchive::mapSegment (const std::string& day) const {
+  // The current day still grows, it is mapped per query at its present size
+  if (day != currentDay_) {
+    auto cached = mapped_.find (day);
+    if (cached != mapped_.end ())
+      return cached->second;
+  }
+  auto segment = std::make_shared<const MappedSegment> (segmentPath (day));
+  if (day != currentDay_ && segment->data)
+    mapped_[day] = segment;
+  return segment;
+}
+
+std::vector<DeliveryArchive::Block> DeliveryArchive::blocksOf (const std::string& day) const {
+  std::vector<Block> blocks;
+  if (!std::filesystem::exists (segmentPath (day)))
+    return blocks;
+
+  auto segment = mapSegment (day);
+  size_t offset = 0;
+  while (segment->data && offset + BLOCK_HEADER_SIZE <= segment->size) {
+    const char* header = segment->data + offset;
+    if (std::memcmp (header, BLOCK_MAGIC, sizeof (BLOCK_MAGIC)) != 0)
+      break;
+    Block block;
+    block.segment = segment;
+    block.recordCount = getFixed<uint32_t> (header + 4);
+    block.rawSize = getFixed<uint32_t> (header + 8);
+    block.compressedSize = getFixed<uint32_t> (header + 12);
+    block.first = static_cast<std::time_t> (getFixed<uint64_t> (header + 16));
+    block.last = static_cast<std::time_t> (getFixed<uint64_t> (header + 24));
+    block.offset = offset + BLOCK_HEADER_SIZE;
+    if (block.offset + block.compressedSize > segment->size)
+      break; // torn write at the end of the file
+    blocks.push_back (block);
+    offset = block.offset + block.compressedSize;
+  }
+  return blocks;
+}
+
+std::vector<ArchiveRecord> DeliveryArchive::decode (const Block& block) {
+  std::string raw (block.rawSize, '\0');
+  uLongf rawSize = block.rawSize;
+  if (uncompress (reinterpret_cast<Bytef*> (&raw[0]), &rawSize,
+                  reinterpret_cast<const Bytef*> (block.segment->data + block.offset),
+                  block.compressedSize)
+      != Z_OK)
+    return {};
+  raw.resize (rawSize);
+  return deserializeAll (raw);
+}
+
+std::vector<ArchiveRecord>
+DeliveryArchive::recent (size_t limit,
+                         const std::function<bool (const ArchiveRecord&)>& filter) const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  std::vector<ArchiveRecord> result;
+  if (limit == 0)
+    return result;
+  auto collect = [&] (const ArchiveRecord& record) {
+    if (!filter || filter (record))
+      result.push_back (record);
+    return result.size () < limit;
+  };
+
+  for (auto it = pending_.rbegin (); it != pending_.rend (); ++it)
+    if (!collect (*it))
+      return result;
+
+  for (auto day = days_.rbegin (); day != days_.rend (); ++day) {
+    std::vector<Block> blocks = blocksOf (*day);
+    for (auto block = blocks.rbegin (); block != blocks.rend (); ++block) {
+      std::vector<ArchiveRecord> records = decode (*block);
+      for (auto it = records.rbegin (); it != records.rend (); ++it)
+        if (!collect (*it))
+          return result;
+    }
+  }
+  return result;
+}
+
+void DeliveryArchive::forEach (std::time_t from, std::time_t to,
+                               const std::function<void (const ArchiveRecord&)>& fn) const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  std::string firstDay = dayOf (from);
+  std::string lastDay = dayOf (to);
+  for (auto day = days_.lower_bound (firstDay); day != days_.end () && *day <= lastDay; ++day) {
+    for (const Block& block : blocksOf (*day)) {
+      if (block.last < from || block.first >= to)
+        continue;
+      for (const auto& record : decode (block))
+        if (record.postedAt >= from && record.postedAt < to)
+          fn (record);
+    }
+  }
+  for (const auto& record : pending_)
+    if (record.postedAt >= from && record.postedAt < to)
+      fn (record);
+}
+
+size_t DeliveryArchive::getSegmentCount () const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  return days_.size ();
+}
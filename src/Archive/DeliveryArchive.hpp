@@ -0,0 +1,91 @@
+#ifndef __DELIVERYARCHIVE_H__
+#define __DELIVERYARCHIVE_H__
+
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+// Append-only archive of delivered items, one segment file per UTC day.
+//
+// YYYY-MM-DD.seg      zlib-compressed blocks of BLOCK_RECORDS records, each block header
+//                     carries the posting time range so range scans skip whole blocks
+// YYYY-MM-DD.pending  uncompressed records not yet packed into a block, replayed on open
+//
+// Segments of past days never change again and are memory-mapped read-only on first use.
+
+struct ArchiveRecord {
+  std::time_t postedAt = 0;
+  std::time_t queuedAt = 0;
+  uint64_t channelId = 0;
+  uint64_t messageId = 0; // 0 when the message id is unknown (slash command replies)
+  std::string sourceUrl;
+  std::string title;
+  std::string link;
+};
+
+class DeliveryArchive {
+public:
+  static constexpr size_t BLOCK_RECORDS = 64;
+
+  DeliveryArchive () = default;
+  ~DeliveryArchive ();
+  DeliveryArchive (const DeliveryArchive&) = delete;
+  DeliveryArchive& operator= (const DeliveryArchive&) = delete;
+
+  /**
+   * @brief Open or create the archive in a directory.
+   * @return 0 on success, -1 on failure.
+   */
+  int open (const std::filesystem::path& directory);
+  void close ();
+
+  int append (const ArchiveRecord& record);
+  int flush (); // pack pending records into a block
+
+  // Newest first, at most limit records accepted by the filter
+  std::vector<ArchiveRecord>
+  recent (size_t limit, const std::function<bool (const ArchiveRecord&)>& filter = nullptr) const;
+  // Records posted in [from, to), oldest first
+  void forEach (std::time_t from, std::time_t to,
+                const std::function<void (const ArchiveRecord&)>& fn) const;
+
+  size_t getSegmentCount () const;
+  static std::string dayOf (std::time_t time);
+
+private:
+  struct MappedSegment;
+  struct Block {
+    std::shared_ptr<const MappedSegment> segment;
+    size_t offset = 0; // of the compressed payload
+    uint32_t recordCount = 0;
+    uint32_t rawSize = 0;
+    uint32_t compressedSize = 0;
+    std::time_t first = 0;
+    std::time_t last = 0;
+  };
+
+  int flushLocked ();
+  int writeBlock (const std::string& day, const std::vector<ArchiveRecord>& records);
+  std::shared_ptr<const MappedSegment> mapSegment (const std::string& day) const;
+  std::vector<Block> blocksOf (const std::string& day) const;
+  static std::vector<ArchiveRecord> decode (const Block& block);
+  std::filesystem::path segmentPath (const std::string& day) const;
+  std::filesystem::path pendingPath (const std::string& day) const;
+
+  mutable std::mutex mutex_;
+  std::filesystem::path directory_;
+  bool open_ = false;
+  std::set<std::string> days_; // days with a segment or pending records
+  std::string currentDay_;
+  std::vector<ArchiveRecord> pending_;
+  mutable std::map<std::string, std::shared_ptr<const MappedSegment>> mapped_;
+};
+
+#endif // __DELIVERYARCHIVE_H__
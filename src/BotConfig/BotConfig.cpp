@@ -0,0 +1,76 @@
+#include "BotConfig.hpp"
+#include <Assets/AssetContext.hpp>
+#include <Logger/Logger.hpp>
+#include <fstream>
+
+namespace {
+  nlohmann::json g_config = nlohmann::json::object ();
+
+  nlohmann::json defaultConfig () {
+    return { { "webSub",
+               { { "enabled", false },
+                 { "bindAddress", "0.0.0.0" },
+                 { "port", 8765 },
+                 { "callbackUrl", "" },
+                 { "leaseSeconds", 864000 },
+                 { "safetyNetPollInterval", 60 * 60 * 24 },
+                 { "verifyTimeoutSeconds", 60 * 10 } } },
+             { "posting",
+               { { "minIntervalSeconds", 60 * 5 },
+                 { "maxIntervalSeconds", 60 * 19 },
+                 { "drainTargetSeconds", 60 * 60 * 8 },
+                 { "maxItemAgeSeconds", 60 * 60 * 12 },
+                 { "quietIntervalSeconds", 60 * 180 },
+                 { "maxBatchItems", 5 },
+                 { "quietStartHour", 23 },
+                 { "quietEndHour", 6 } } },
+             { "fetch", { { "freshnessSeconds", 60 } } },
+             { "outbox", { { "batchSize", 16 } } },
+             // Overridden per process by BOTPP_SHARD_COUNT, BOTPP_CLUSTER_ID, BOTPP_MAX_CLUSTERS
+             { "sharding", { { "shardCount", 0 }, { "clusterId", 0 }, { "maxClusters", 1 } } },
+             { "workers", { { "threads", 4 }, { "maxQueued", 32 } } },
+             { "pages", { { "maxEntries", 64 }, { "ttlSeconds", 60 * 15 } } },
+             { "delivery", { { "maxInFlight", 4 }, { "retryAttempts", 3 } } },
+             // Webhook created in "webhook" lanes, avatars are keyed by the feed host
+             { "webhooks",
+               { { "name", "Bot++ feeds" }, { "avatars", nlohmann::json::object () } } },
+             // Per-channel overrides of "posting", "embedded" and "webhook", keyed by channel id
+             { "lanes", nlohmann::json::object () } };
+  }
+}
+
+namespace BotConfig {
+
+  std::filesystem::path getConfigPath () {
+    return AssetContext::getAssetsPath () / "botConfig.json";
+  }
+
+  int load () {
+    g_config = defaultConfig ();
+
+    if (!std::filesystem::exists (getConfigPath ())) {
+      std::ofstream file (getConfigPath ());
+      if (!file.is_open ())
+        return -1;
+      file << g_config.dump (4);
+      LOG_I_STREAM << "Created default bot config file at: " << getConfigPath () << std::endl;
+      return 0;
+    }
+
+    try {
+      // Missing keys keep their defaults
+      g_config.merge_patch (DotNameUtils::JsonUtils::loadFromFile (getConfigPath ()));
+    } catch (const std::exception& e) {
+      LOG_E_STREAM << "Bot config corrupted: " << e.what () << ". Using defaults." << std::endl;
+      return -1;
+    }
+
+    LOG_I_STREAM << "Loaded bot config from: " << getConfigPath () << std::endl;
+    return 0;
+  }
+
+  const nlohmann::json& get () {
+    return g_config;
+  }
+
+} // namespace BotConfig
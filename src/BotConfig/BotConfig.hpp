@@ -0,0 +1,31 @@
+#ifndef __BOTCONFIG_H__
+#define __BOTCONFIG_H__
+
+#include <Utils/Utils.hpp>
+#include <nlohmann/json.hpp>
+#include <filesystem>
+#include <string>
+
+// Runtime settings of the bot stored in assets/botConfig.json.
+// Loaded once at startup; every module reads its own section with a default fallback.
+
+namespace BotConfig {
+
+  /**
+   * @brief Load botConfig.json from the assets directory, creating it with defaults if missing.
+   * @return 0 on success, -1 on failure (defaults stay in effect).
+   */
+  int load ();
+
+  const nlohmann::json& get ();
+
+  std::filesystem::path getConfigPath ();
+
+  // Value by path, e.g. BotConfig::value<int> ("webSub/port", 8765)
+  template <typename T> T value (const std::string& path, const T& defaultValue) {
+    return DotNameUtils::JsonUtils::getNestedValue<T> (get (), path, defaultValue);
+  }
+
+} // namespace BotConfig
+
+#endif // __BOTCONFIG_H__
@@ -0,0 +1,104 @@
+#ifndef __ASYNCSEMAPHORE_H__
+#define __ASYNCSEMAPHORE_H__
+
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+// Counting semaphore for coroutines: acquire () suspends the coroutine instead of blocking a
+// thread. release () hands the permit to the oldest waiter and resumes it on the releasing thread.
+
+class AsyncSemaphore {
+public:
+  explicit AsyncSemaphore (size_t permits) : permits_ (permits) {
+  }
+  AsyncSemaphore (const AsyncSemaphore&) = delete;
+  AsyncSemaphore& operator= (const AsyncSemaphore&) = delete;
+
+  struct Awaiter {
+    AsyncSemaphore& semaphore;
+    bool await_ready () {
+      return semaphore.tryAcquire ();
+    }
+    // false resumes at once, a permit was freed between await_ready and now
+    bool await_suspend (std::coroutine_handle<> waiter) {
+      return semaphore.enqueue (waiter);
+    }
+    void await_resume () {
+    }
+  };
+
+  // Releases the permit when it goes out of scope
+  class Permit {
+  public:
+    explicit Permit (AsyncSemaphore& semaphore) : semaphore_ (&semaphore) {
+    }
+    Permit (Permit&& other) noexcept : semaphore_ (other.semaphore_) {
+      other.semaphore_ = nullptr;
+    }
+    Permit (const Permit&) = delete;
+    Permit& operator= (const Permit&) = delete;
+    Permit& operator= (Permit&&) = delete;
+    ~Permit () {
+      if (semaphore_)
+        semaphore_->release ();
+    }
+
+  private:
+    AsyncSemaphore* semaphore_;
+  };
+
+  // co_await semaphore.acquire (); AsyncSemaphore::Permit permit (semaphore);
+  Awaiter acquire () {
+    return Awaiter{ *this };
+  }
+
+  bool tryAcquire () {
+    std::lock_guard<std::mutex> lock (mutex_);
+    if (permits_ == 0)
+      return false;
+    permits_--;
+    return true;
+  }
+
+  void release () {
+    std::coroutine_handle<> next;
+    {
+      std::lock_guard<std::mutex> lock (mutex_);
+      if (waiters_.empty ()) {
+        permits_++;
+        return;
+      }
+      next = waiters_.front ();
+      waiters_.pop_front ();
+    }
+    next.resume (); // the permit passes straight to the waiter
+  }
+
+  size_t getAvailable () const {
+    std::lock_guard<std::mutex> lock (mutex_);
+    return permits_;
+  }
+  size_t getWaiting () const {
+    std::lock_guard<std::mutex> lock (mutex_);
+    return waiters_.size ();
+  }
+
+private:
+  bool enqueue (std::coroutine_handle<> waiter) {
+    std::lock_guard<std::mutex> lock (mutex_);
+    if (permits_ > 0) {
+      permits_--;
+      return false;
+    }
+    waiters_.push_back (waiter);
+    return true;
+  }
+
+  mutable std::mutex mutex_;
+  size_t permits_;
+  std::deque<std::coroutine_handle<>> waiters_;
+};
+
+#endif // __ASYNCSEMAPHORE_H__
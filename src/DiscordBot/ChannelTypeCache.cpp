@@ -0,0 +1,37 @@
+#include "ChannelTypeCache.hpp"
+
+void ChannelTypeCache::set (uint64_t channelId, bool announcement) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  announcement_[channelId] = announcement;
+}
+
+void ChannelTypeCache::remove (uint64_t channelId) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  announcement_.erase (channelId);
+}
+
+std::optional<bool> ChannelTypeCache::isAnnouncement (uint64_t channelId) const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  auto it = announcement_.find (channelId);
+  if (it == announcement_.end ())
+    return std::nullopt;
+  return it->second;
+}
+
+bool ChannelTypeCache::shouldCrosspost (bool announcement) {
+  if (!announcement)
+    crosspostsSkipped_++;
+  return announcement;
+}
+
+ChannelTypeStats ChannelTypeCache::getStats () const {
+  ChannelTypeStats stats;
+  {
+    std::lock_guard<std::mutex> lock (mutex_);
+    stats.cachedChannels = announcement_.size ();
+  }
+  stats.crosspostsSent = crosspostsSent_;
+  stats.crosspostsSkipped = crosspostsSkipped_;
+  stats.restLookups = restLookups_;
+  return stats;
+}
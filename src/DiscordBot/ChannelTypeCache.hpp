@@ -0,0 +1,47 @@
+#ifndef __CHANNELTYPECACHE_H__
+#define __CHANNELTYPECACHE_H__
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+// Channel types known from gateway events, with a REST lookup for channels not seen yet.
+// Only announcement channels can be crossposted, so the type decides whether a crosspost
+// request is worth sending at all.
+
+struct ChannelTypeStats {
+  size_t cachedChannels = 0;
+  uint64_t crosspostsSent = 0;    // crossposts Discord accepted
+  uint64_t crosspostsSkipped = 0; // requests that would have failed in other channels
+  uint64_t restLookups = 0;       // channel_get calls for channels the gateway did not report
+};
+
+class ChannelTypeCache {
+public:
+  void set (uint64_t channelId, bool announcement);
+  void remove (uint64_t channelId);
+  // nullopt when the channel has not been seen yet
+  std::optional<bool> isAnnouncement (uint64_t channelId) const;
+
+  // A message was posted, true when it should be crossposted
+  bool shouldCrosspost (bool announcement);
+  // Counted once Discord accepted the crosspost, not when it was attempted
+  void countCrosspost () {
+    crosspostsSent_++;
+  }
+  void countRestLookup () {
+    restLookups_++;
+  }
+  ChannelTypeStats getStats () const;
+
+private:
+  mutable std::mutex mutex_;
+  std::unordered_map<uint64_t, bool> announcement_;
+  std::atomic<uint64_t> crosspostsSent_{ 0 };
+  std::atomic<uint64_t> crosspostsSkipped_{ 0 };
+  std::atomic<uint64_t> restLookups_{ 0 };
+};
+
+#endif // __CHANNELTYPECACHE_H__
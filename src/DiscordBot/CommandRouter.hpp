@@ -0,0 +1,165 @@
+#ifndef __COMMANDROUTER_H__
+#define __COMMANDROUTER_H__
+
+#include <Logger/Logger.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Latency histogram with power-of-two buckets in microseconds.
+// Bucket i counts samples below 2^i us, the last bucket collects everything slower (~16 s).
+class LatencyHistogram {
+public:
+  static constexpr size_t BUCKETS = 25;
+
+  void record (std::chrono::microseconds latency) {
+    uint64_t us = latency.count () > 0 ? static_cast<uint64_t> (latency.count ()) : 0;
+    size_t bucket = 0;
+    while (bucket + 1 < BUCKETS && us >= (uint64_t{ 1 } << bucket))
+      ++bucket;
+    counts_[bucket]++;
+    samples_++;
+    total_ += us;
+    if (us > max_)
+      max_ = us;
+  }
+
+  // Upper bound of the bucket holding the q-quantile, 0 without samples
+  std::chrono::microseconds percentile (double q) const {
+    if (samples_ == 0)
+      return std::chrono::microseconds (0);
+    uint64_t rank = static_cast<uint64_t> (q * static_cast<double> (samples_ - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BUCKETS; ++bucket) {
+      seen += counts_[bucket];
+      if (seen >= rank)
+        return std::chrono::microseconds (
+            bucket + 1 < BUCKETS ? (uint64_t{ 1 } << bucket) : max_);
+    }
+    return std::chrono::microseconds (max_);
+  }
+
+  uint64_t getSamples () const {
+    return samples_;
+  }
+  std::chrono::microseconds getMax () const {
+    return std::chrono::microseconds (max_);
+  }
+  std::chrono::microseconds getMean () const {
+    return std::chrono::microseconds (samples_ ? total_ / samples_ : 0);
+  }
+  const std::array<uint64_t, BUCKETS>& getBuckets () const {
+    return counts_;
+  }
+
+private:
+  std::array<uint64_t, BUCKETS> counts_{};
+  uint64_t samples_ = 0;
+  uint64_t total_ = 0;
+  uint64_t max_ = 0;
+};
+
+// Name -> handler dispatch through one hash lookup, with per-command call counts and latency.
+// Handlers run on the caller's thread; the stats are guarded so DPP's event threads may share
+// one router. A handler that only hands the work to another thread reports the run itself
+// through recordExecution.
+template <typename Event> class CommandRouter {
+public:
+  using Handler = std::function<void (const Event&)>;
+
+  struct Stats {
+    std::string name;
+    uint64_t calls = 0;
+    uint64_t failures = 0; // handlers that threw
+    LatencyHistogram latency;
+    LatencyHistogram execution; // deferred runs, empty for commands answered in the handler
+  };
+
+  // -1 if the name is already routed
+  int add (const std::string& name, Handler handler) {
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto [it, inserted] = routes_.try_emplace (name);
+    if (!inserted)
+      return -1;
+    it->second.handler = std::move (handler);
+    it->second.stats.name = name;
+    return 0;
+  }
+
+  bool contains (const std::string& name) const {
+    std::lock_guard<std::mutex> lock (mutex_);
+    return routes_.count (name) > 0;
+  }
+
+  // false if no handler is routed under the name
+  bool dispatch (const std::string& name, const Event& event) {
+    Handler handler;
+    {
+      std::lock_guard<std::mutex> lock (mutex_);
+      auto it = routes_.find (name);
+      if (it == routes_.end ())
+        return false;
+      handler = it->second.handler;
+    }
+
+    bool failed = false;
+    auto started = std::chrono::steady_clock::now ();
+    try {
+      handler (event);
+    } catch (const std::exception& e) {
+      failed = true;
+      LOG_E_STREAM << "Command /" << name << " failed: " << e.what () << std::endl;
+    }
+    auto latency = std::chrono::duration_cast<std::chrono::microseconds> (
+        std::chrono::steady_clock::now () - started);
+
+    std::lock_guard<std::mutex> lock (mutex_);
+    Stats& stats = routes_[name].stats;
+    stats.calls++;
+    if (failed)
+      stats.failures++;
+    stats.latency.record (latency);
+    return true;
+  }
+
+  // Run time of work the handler deferred, a failed run counts as a failure of the command
+  void recordExecution (const std::string& name, std::chrono::microseconds duration, bool failed) {
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto it = routes_.find (name);
+    if (it == routes_.end ())
+      return;
+    if (failed)
+      it->second.stats.failures++;
+    it->second.stats.execution.record (duration);
+  }
+
+  // Commands that were called at least once, most called first
+  std::vector<Stats> getStats () const {
+    std::lock_guard<std::mutex> lock (mutex_);
+    std::vector<Stats> result;
+    for (const auto& [name, route] : routes_)
+      if (route.stats.calls > 0)
+        result.push_back (route.stats);
+    std::sort (result.begin (), result.end (), [] (const Stats& a, const Stats& b) {
+      return a.calls != b.calls ? a.calls > b.calls : a.name < b.name;
+    });
+    return result;
+  }
+
+private:
+  struct Route {
+    Handler handler;
+    Stats stats;
+  };
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, Route> routes_;
+};
+
+#endif // __COMMANDROUTER_H__
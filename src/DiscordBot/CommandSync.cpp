@@ -0,0 +1,69 @@
+#include "CommandSync.hpp"
+#include <Logger/Logger.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+namespace {
+  // Filled in by Discord, not part of the definition
+  const char* const ASSIGNED_KEYS[] = { "id", "application_id", "version", "guild_id" };
+}
+
+namespace CommandSync {
+
+  nlohmann::json normalize (const nlohmann::json& commands) {
+    std::vector<nlohmann::json> sorted;
+    if (commands.is_array ()) {
+      for (const auto& command : commands) {
+        nlohmann::json definition = command;
+        if (definition.is_object ()) {
+          for (const char* key : ASSIGNED_KEYS)
+            definition.erase (key);
+        }
+        sorted.push_back (std::move (definition));
+      }
+    }
+    std::sort (sorted.begin (), sorted.end (),
+               [] (const nlohmann::json& a, const nlohmann::json& b) {
+                 return a.value ("name", "") < b.value ("name", "");
+               });
+    return nlohmann::json (sorted);
+  }
+
+  std::string signature (const nlohmann::json& commands) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : normalize (commands).dump ()) {
+      hash ^= c;
+      hash *= 1099511628211ULL;
+    }
+    std::ostringstream hex;
+    hex << std::hex << std::setw (16) << std::setfill ('0') << hash;
+    return hex.str ();
+  }
+
+  bool matches (const nlohmann::json& local, const nlohmann::json& remote) {
+    return normalize (local) == normalize (remote);
+  }
+
+  std::string loadSignature (const std::filesystem::path& path) {
+    std::ifstream file (path);
+    std::string stored;
+    if (file.is_open ())
+      std::getline (file, stored);
+    return stored;
+  }
+
+  int saveSignature (const std::filesystem::path& path, const std::string& signature) {
+    std::ofstream file (path, std::ios::trunc);
+    if (!file.is_open ()) {
+      LOG_E_STREAM << "Failed to write command signature to " << path << std::endl;
+      return -1;
+    }
+    file << signature << std::endl;
+    return 0;
+  }
+
+} // namespace CommandSync
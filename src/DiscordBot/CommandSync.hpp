@@ -0,0 +1,29 @@
+#ifndef __COMMANDSYNC_H__
+#define __COMMANDSYNC_H__
+
+#include <nlohmann/json.hpp>
+#include <filesystem>
+#include <string>
+
+// Global slash commands are registered with one bulk overwrite, and only when the command table
+// differs from what Discord already has. The signature of the last registered table is kept on
+// disk, so reconnects and restarts with an unchanged table send no request at all.
+
+namespace CommandSync {
+
+  // Commands without the keys Discord assigns (id, application_id, version, ...), sorted by name
+  nlohmann::json normalize (const nlohmann::json& commands);
+
+  // Stable across builds and platforms: FNV-1a of the normalized JSON, hex encoded
+  std::string signature (const nlohmann::json& commands);
+
+  // Both tables describe the same commands
+  bool matches (const nlohmann::json& local, const nlohmann::json& remote);
+
+  // Empty when the file is missing
+  std::string loadSignature (const std::filesystem::path& path);
+  int saveSignature (const std::filesystem::path& path, const std::string& signature);
+
+} // namespace CommandSync
+
+#endif // __COMMANDSYNC_H__
@@ -0,0 +1,105 @@
+#include "DeliveryEngine.hpp"
+#include <Logger/Logger.hpp>
+
+DeliveryEngine::DeliveryEngine (dpp::cluster& bot, size_t maxInFlight, RetryPolicy policy)
+    : bot_ (bot), maxInFlight_ (std::max<size_t> (1, maxInFlight)), policy_ (policy),
+      permits_ (std::max<size_t> (1, maxInFlight)), rng_ (std::random_device{}()) {
+}
+
+size_t DeliveryEngine::getInFlight () const {
+  return maxInFlight_ - permits_.getAvailable ();
+}
+
+DeliveryError DeliveryEngine::errorOf (const std::string& stage,
+                                       const dpp::confirmation_callback_t& callback) {
+  DeliveryError error;
+  error.stage = stage;
+  error.httpStatus = callback.http_info.status;
+  error.message = callback.get_error ().message;
+  return error;
+}
+
+dpp::task<dpp::confirmation_callback_t> DeliveryEngine::withRetry (std::string stage,
+                                                                   Request request) {
+  for (unsigned attempt = 0;; ++attempt) {
+    dpp::confirmation_callback_t callback = co_await request ();
+    if (!callback.is_error () || !policy_.shouldRetry (attempt, callback.http_info.status))
+      co_return callback;
+
+    std::chrono::milliseconds delay;
+    {
+      std::lock_guard<std::mutex> lock (rngMutex_);
+      delay = policy_.delay (attempt, rng_);
+    }
+    // co_sleep counts whole seconds
+    uint64_t seconds = static_cast<uint64_t> ((delay.count () + 999) / 1000);
+    LOG_W_STREAM << "Discord " << stage << " failed with HTTP " << callback.http_info.status
+                 << ", retry " << attempt + 1 << " in " << seconds << " s" << std::endl;
+    co_await bot_.co_sleep (std::max<uint64_t> (1, seconds));
+  }
+}
+
+dpp::task<DeliveryResult> DeliveryEngine::deliver (dpp::message message,
+                                                   DeliveryOptions options) {
+  co_await permits_.acquire ();
+  AsyncSemaphore::Permit permit (permits_);
+
+  DeliveryResult result;
+  result.channelId = message.channel_id;
+  // Not idempotent, a retry could post the item twice - SendPipeline decides on failures
+  dpp::confirmation_callback_t created = co_await bot_.co_message_create (message);
+  result.createResponse = created.http_info;
+  if (created.is_error ()) {
+    result.error = errorOf ("create", created);
+    co_return result;
+  }
+  const auto& createdMessage = created.get<dpp::message> ();
+  result.messageId = createdMessage.id;
+  result.channelId = createdMessage.channel_id;
+
+  if (options.crosspost) {
+    dpp::confirmation_callback_t crossposted = co_await withRetry ("crosspost", [&] () {
+      return bot_.co_message_crosspost (result.messageId, result.channelId);
+    });
+    result.crosspostResponse = crossposted.http_info;
+    if (crossposted.is_error ()) {
+      result.warnings.push_back (errorOf ("crosspost", crossposted));
+    } else {
+      result.crossposted = true;
+    }
+  }
+
+  if (!options.threadName.empty ()) {
+    dpp::confirmation_callback_t thread = co_await withRetry ("thread", [&] () {
+      return bot_.co_thread_create_with_message (options.threadName, result.channelId,
+                                                 result.messageId, options.threadArchiveMinutes,
+                                                 0); // rate_limit_per_user (0 = no rate limit)
+    });
+    if (thread.is_error ()) {
+      result.warnings.push_back (errorOf ("thread", thread));
+    } else {
+      result.threadId = thread.get<dpp::thread> ().id;
+    }
+  }
+  co_return result;
+}
+
+dpp::job DeliveryEngine::run (dpp::message message, DeliveryOptions options,
+                              std::function<void (const DeliveryResult&)> done) {
+  DeliveryResult result;
+  try {
+    result = co_await deliver (std::move (message), std::move (options));
+  } catch (const std::exception& e) {
+    DeliveryError error;
+    error.stage = "create";
+    error.message = e.what ();
+    result.error = error;
+  }
+  if (done)
+    done (result);
+}
+
+void DeliveryEngine::start (dpp::message message, DeliveryOptions options,
+                            std::function<void (const DeliveryResult&)> done) {
+  run (std::move (message), std::move (options), std::move (done));
+}
@@ -0,0 +1,77 @@
+#ifndef __DELIVERYENGINE_H__
+#define __DELIVERYENGINE_H__
+
+#include "AsyncSemaphore.hpp"
+#include "RetryPolicy.hpp"
+#include <dpp/dpp.h>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+// Coroutine delivery of one message: create, then optionally crosspost or open a thread on it.
+// A semaphore bounds the deliveries in flight, the idempotent follow-ups are retried on 5xx with
+// jittered backoff, and every outcome is reported as a DeliveryResult instead of nested callbacks.
+// A failed create is reported as is, SendPipeline requeues or drops it.
+
+struct DeliveryOptions {
+  bool crosspost = false;
+  std::string threadName; // non-empty: open a thread on the created message
+  uint16_t threadArchiveMinutes = 60;
+};
+
+struct DeliveryError {
+  std::string stage; // "create", "crosspost" or "thread"
+  uint16_t httpStatus = 0;
+  std::string message;
+};
+
+struct DeliveryResult {
+  dpp::snowflake messageId = 0;
+  dpp::snowflake channelId = 0;
+  dpp::snowflake threadId = 0;
+  bool crossposted = false;
+  dpp::http_request_completion_t createResponse;    // rate limit state of the create route
+  dpp::http_request_completion_t crosspostResponse; // status 0 when no crosspost was sent
+  std::optional<DeliveryError> error;               // the message was not created
+  std::vector<DeliveryError> warnings;              // follow-up steps that failed
+
+  bool ok () const {
+    return !error.has_value ();
+  }
+};
+
+class DeliveryEngine {
+public:
+  DeliveryEngine (dpp::cluster& bot, size_t maxInFlight, RetryPolicy policy = {});
+
+  dpp::task<DeliveryResult> deliver (dpp::message message, DeliveryOptions options);
+  // Fire and forget: deliver and hand the result to done on the completing thread
+  void start (dpp::message message, DeliveryOptions options,
+              std::function<void (const DeliveryResult&)> done);
+
+  size_t getInFlight () const;
+  size_t getWaiting () const {
+    return permits_.getWaiting ();
+  }
+
+private:
+  using Request = std::function<dpp::async<dpp::confirmation_callback_t> ()>;
+
+  dpp::task<dpp::confirmation_callback_t> withRetry (std::string stage, Request request);
+  dpp::job run (dpp::message message, DeliveryOptions options,
+                std::function<void (const DeliveryResult&)> done);
+  static DeliveryError errorOf (const std::string& stage,
+                                const dpp::confirmation_callback_t& callback);
+
+  dpp::cluster& bot_;
+  const size_t maxInFlight_;
+  const RetryPolicy policy_;
+  AsyncSemaphore permits_;
+  std::mutex rngMutex_;
+  std::mt19937 rng_;
+};
+
+#endif // __DELIVERYENGINE_H__
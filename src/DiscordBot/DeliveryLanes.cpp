@@ -0,0 +1,119 @@
+#include "DeliveryLanes.hpp"
+#include <BotConfig/BotConfig.hpp>
+#include <Logger/Logger.hpp>
+#include <algorithm>
+#include <ctime>
+
+LaneConfig LaneConfig::fromBotConfig (uint64_t channelId) {
+  LaneConfig config;
+  config.posting = PostingRate::configForChannel (channelId);
+  nlohmann::json lanes = BotConfig::get ().value ("lanes", nlohmann::json::object ());
+  auto lane = lanes.find (std::to_string (channelId));
+  if (lane != lanes.end () && lane->is_object () && lane->contains ("embedded")
+      && (*lane)["embedded"].is_boolean ())
+    config.embedded = (*lane)["embedded"].get<bool> ();
+  if (lane != lanes.end () && lane->is_object () && lane->contains ("webhook")
+      && (*lane)["webhook"].is_boolean ())
+    config.webhook = (*lane)["webhook"].get<bool> ();
+  return config;
+}
+
+DeliveryLanes::DeliveryLanes (Scheduler& scheduler, RssManager& rss, PostFn post)
+    : scheduler_ (scheduler), rss_ (rss), post_ (std::move (post)) {
+}
+
+void DeliveryLanes::start (Scheduler::Clock::duration firstDelay) {
+  rss_.setOnItemsAvailable ([this] (uint64_t channelId) { onItemsAvailable (channelId); });
+  for (uint64_t channelId : rss_.getLaneChannels ())
+    openLane (channelId, firstDelay);
+}
+
+void DeliveryLanes::setFixedInterval (std::optional<Scheduler::Clock::duration> interval) {
+  fixedInterval_ = interval;
+}
+
+size_t DeliveryLanes::getLaneCount () const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  return lanes_.size ();
+}
+
+void DeliveryLanes::openLane (uint64_t channelId, Scheduler::Clock::duration firstDelay) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  if (lanes_.count (channelId))
+    return;
+
+  LaneConfig config = LaneConfig::fromBotConfig (channelId);
+  auto lane = std::make_unique<Lane> ();
+  lane->channelId = channelId;
+  lane->rate = PostingRate (config.posting);
+  lane->embedded = config.embedded;
+  lane->webhook = config.webhook;
+  Lane* raw = lane.get (); // lanes are never removed, the task may keep the pointer
+  lane->task = scheduler_.scheduleDynamic (
+      firstDelay, [this, raw] () { return service (*raw); },
+      "lane-" + std::to_string (channelId));
+  lanes_.emplace (channelId, std::move (lane));
+  LOG_I_STREAM << "Opened delivery lane for channel " << channelId << std::endl;
+}
+
+void DeliveryLanes::onItemsAvailable (uint64_t channelId) {
+  Lane* lane = nullptr;
+  {
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto it = lanes_.find (channelId);
+    if (it != lanes_.end ())
+      lane = it->second.get ();
+  }
+  if (!lane) {
+    openLane (channelId, Scheduler::Clock::duration (0));
+    return;
+  }
+  if (!lane->parked.exchange (false))
+    return;
+
+  // Keep the minimum spacing to the lane's previous post
+  auto sinceLastPost = Scheduler::Clock::now () - lane->lastPost.load ();
+  auto delay = std::max (Scheduler::Clock::duration (0),
+                         Scheduler::Clock::duration (lane->rate.getConfig ().minInterval)
+                             - sinceLastPost);
+  scheduler_.reschedule (lane->task, delay);
+}
+
+std::optional<Scheduler::Clock::duration> DeliveryLanes::service (Lane& lane) {
+  std::time_t now = std::time (nullptr);
+  std::tm localTime{};
+  localtime_r (&now, &localTime); // std::localtime shares one buffer across threads
+  try {
+    // A backlog that cannot drain in time is posted several items at once, the send pipeline
+    // merges them into one digest message
+    size_t batch = fixedInterval_ ? 1
+                                  : lane.rate.batchSize (
+                                      rss_.getLaneStatus (lane.channelId).queuedItems, localTime);
+    for (size_t i = 0; i < batch; ++i) {
+      RSSItem item = rss_.getNextLaneItem (lane.channelId);
+      if (item.title.empty ())
+        break;
+      post_ (item, lane.channelId, lane.embedded.value_or (item.embedded), lane.webhook);
+      lane.lastPost.store (Scheduler::Clock::now ());
+    }
+  } catch (const std::runtime_error& e) {
+    LOG_E_STREAM << "Error: " << e.what () << std::endl;
+  }
+
+  if (fixedInterval_)
+    return *fixedInterval_;
+
+  // Park before looking at the queue, items arriving from now on wake the lane
+  lane.parked.store (true);
+  LaneStatus status = rss_.getLaneStatus (lane.channelId);
+  std::chrono::seconds interval
+      = lane.rate.nextInterval (status.queuedItems, status.oldestItemAge, localTime);
+  if (interval.count () == 0) {
+    LOG_D_STREAM << "Lane " << lane.channelId << " is empty, waiting for new items." << std::endl;
+    return lane.rate.getConfig ().quietInterval;
+  }
+  lane.parked.store (false);
+  LOG_I_STREAM << "Lane " << lane.channelId << ": next post in " << interval.count () << " s, "
+               << status.queuedItems << " items in queue." << std::endl;
+  return interval;
+}
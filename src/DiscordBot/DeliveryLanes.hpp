@@ -0,0 +1,65 @@
+#ifndef __DELIVERYLANES_H__
+#define __DELIVERYLANES_H__
+
+#include "PostingRate.hpp"
+#include <RssManager/RssManager.hpp>
+#include <Scheduler/Scheduler.hpp>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+// One delivery lane per channel: its own queue in RssManager, its own cadence, quiet hours and
+// embedded preference. Every lane is a task of the shared scheduler, so a busy channel cannot
+// delay a quiet one and adding channels never adds threads.
+
+struct LaneConfig {
+  PostingRateConfig posting;
+  std::optional<bool> embedded; // overrides the subscription's embedded flag when set
+  bool webhook = false;         // post through a webhook, off the bot's message budget
+
+  // "posting" section overridden by "lanes" -> "<channelId>" of botConfig.json
+  static LaneConfig fromBotConfig (uint64_t channelId);
+};
+
+class DeliveryLanes {
+public:
+  using PostFn = std::function<void (const RSSItem& item, uint64_t channelId, bool embedded,
+                                     bool webhook)>;
+
+  DeliveryLanes (Scheduler& scheduler, RssManager& rss, PostFn post);
+
+  // Open a lane for every known channel and follow new items of RssManager
+  void start (Scheduler::Clock::duration firstDelay);
+  // Fixed cadence for every lane instead of PostingRate, e.g. in development builds
+  void setFixedInterval (std::optional<Scheduler::Clock::duration> interval);
+
+  // New items in a channel - opens its lane or wakes it when parked on an empty queue
+  void onItemsAvailable (uint64_t channelId);
+  size_t getLaneCount () const;
+
+private:
+  struct Lane {
+    uint64_t channelId = 0;
+    PostingRate rate;
+    std::optional<bool> embedded;
+    bool webhook = false;
+    Scheduler::TaskId task = 0;
+    std::atomic<Scheduler::Clock::time_point> lastPost{ Scheduler::Clock::time_point () };
+    std::atomic<bool> parked{ false };
+  };
+
+  void openLane (uint64_t channelId, Scheduler::Clock::duration firstDelay);
+  std::optional<Scheduler::Clock::duration> service (Lane& lane);
+
+  Scheduler& scheduler_;
+  RssManager& rss_;
+  PostFn post_;
+  std::optional<Scheduler::Clock::duration> fixedInterval_;
+  mutable std::mutex mutex_; // guards lanes_
+  std::map<uint64_t, std::unique_ptr<Lane>> lanes_;
+};
+
+#endif // __DELIVERYLANES_H__
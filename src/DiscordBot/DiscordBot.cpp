@@ -1,23 +1,45 @@
 #include "DiscordBot.hpp"
 #include <Assets/AssetContext.hpp>
+#include <BotConfig/BotConfig.hpp>
 #include <Logger/Logger.hpp>
 #include <IBot/version.h>
+#include <Lifecycle/ServiceLifecycle.hpp>
 #include <RssManager/RssManager.hpp>
 #include <Llm/GoogleGemini.hpp>
 #include <SunrisetC/SunrisetWorker.hpp>
-#include <thread>
+#include <Scheduler/Scheduler.hpp>
+#include <SysInfo/SysInfo.hpp>
+#include <WorkerPool/WorkerPool.hpp>
+#include "ChannelTypeCache.hpp"
+#include "CommandSync.hpp"
+#include "DeliveryEngine.hpp"
+#include "DeliveryLanes.hpp"
+#include "PageCache.hpp"
+#include "ResponseCache.hpp"
+#include "ShardOwnership.hpp"
+#include "SendPipeline.hpp"
+#include "WebhookCache.hpp"
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <cstdio>
+#include <map>
 
 #define IS_TOMAS_MARK_BOT
 #define IS_RSS_MODULE_ACTIVE
 #define PUBLIC_RELEASED_DISCORD_BOT
 
-const int START_SLOW_MODE_AT_HOUR = 23;           // Start slow mode at 23:00
-const int STOP_SLOW_MODE_AT_HOUR = 6;             // Stop slow mode at 06:00
-const int SLOW_MODE_POLLING_INTERVAL = 60 * 180;  // 180 minutes (3 hours)
-const int NORMAL_MODE_POLLING_INTERVAL = 60 * 19; // 19 minutes
+// Normal and quiet-hours cadence live in the "posting" and "lanes" sections of botConfig.json
 const int ULTRA_FAST_POLLING_INTERVAL = 30;       // 30 seconds
 const int FEED_FETCH_INTERVAL = 60 * 60 * 2;      // 2 hours
+const int SCHEDULER_STATS_INTERVAL = 60 * 60;     // 1 hour
+const int OUTBOX_FLUSH_INTERVAL = 5;              // 5 seconds
+const int SYSINFO_REFRESH_INTERVAL = 10;          // 10 seconds
+const int STARTUP_DELAY = 5;                      // delay to user readable debug output
+const int SHUTDOWN_TIMEOUT = 10;                  // 10 seconds
+const int SHUTDOWN_FLUSH_RESERVE = 3;             // end of the timeout kept for the RSS flush
 
 const std::string NO_ITEMS_IN_QUEUE = "No items in the RSS feed queue.";
 const std::string ALL_FEEDS_REFETCHED = "All RSS feeds have been refetched successfully.";
@@ -31,6 +53,128 @@ constexpr size_t DISCORD_MAX_MSG_LEN = 2000; // (as per Discord API docs)
 uint64_t defaultChannelRss = 1398904149856223262;
 
 RssManager rss;
+// Started on the first ready, stopped in reverse order on SIGTERM / SIGINT
+ServiceLifecycle services;
+// Runs the polling loops and one-shot jobs on a single thread
+Scheduler scheduler;
+Scheduler::TaskId fetchTask = 0;
+// Owned channels became known after a fetch cycle filtered them out, fetch again soon
+std::atomic<bool> fetchRequested{ false };
+// Per-channel posting, every lane is a scheduler task
+std::unique_ptr<DeliveryLanes> lanes;
+// Outbound messages wait here for their rate limit bucket
+std::unique_ptr<SendPipeline> sendPipeline;
+// Create/crosspost/thread chains as coroutines with a bound on requests in flight
+std::unique_ptr<DeliveryEngine> delivery;
+// Announcement channels get crossposted, the type comes from the gateway or one REST lookup
+ChannelTypeCache channelTypes;
+// Webhooks of the channels with "webhook": true in their lane config
+WebhookCache webhooks;
+// Blocking slash command handlers run here, off DPP's event threads
+std::unique_ptr<WorkerPool> workers;
+// Recent long replies, their page buttons re-render from here
+std::unique_ptr<PageCache> pages;
+// Guilds and channels served by this process when several processes share the shards
+std::unique_ptr<ShardOwnership> ownership;
+// Replies of deterministic commands, re-rendered only when their validity token changes
+ResponseCache<dpp::message> responses;
+// /env and the native /runterminalcommand reports, kept fresh by a scheduler task
+SysInfo::Collector sysInfo (std::chrono::seconds (SYSINFO_REFRESH_INTERVAL + 5));
+
+namespace {
+  // Guilds of later shards arrive in a burst after the first ready, every one pushes the fetch
+  // a little further out so it runs once the burst settles, not at the next interval
+  void requestFetch () {
+    if (!services.isStarted ())
+      return; // the first fetch has not run yet and will see the channel
+    fetchRequested = true;
+    scheduler.reschedule (fetchTask, std::chrono::seconds (STARTUP_DELAY));
+  }
+
+  RateLimitInfo rateLimitOf (const dpp::http_request_completion_t& http) {
+    RateLimitInfo info;
+    if (http.ratelimit_limit > 0) {
+      info.remaining = static_cast<int64_t> (http.ratelimit_remaining);
+      info.resetAfter = std::chrono::seconds (http.ratelimit_reset_after);
+    }
+    info.limited = http.status == 429;
+    info.retryAfter = std::chrono::seconds (http.ratelimit_retry_after);
+    info.global = http.ratelimit_global;
+    return info;
+  }
+
+  // Page content with prev / position / next buttons when there is more than one page
+  dpp::message pageMessage (dpp::snowflake channelId, const Page& page, const std::string& key) {
+    dpp::message msg (channelId, page.content);
+    if (page.count < 2)
+      return msg;
+    auto button = [&key] (const std::string& label, size_t index, bool disabled) {
+      return dpp::component ()
+          .set_type (dpp::cot_button)
+          .set_style (dpp::cos_secondary)
+          .set_label (label)
+          .set_id (PageCache::buttonId (key, index))
+          .set_disabled (disabled);
+    };
+    // ids must differ within a message, the position button takes the out of range index
+    size_t last = page.count - 1;
+    msg.add_component (
+        dpp::component ()
+            .add_component (button ("◀", page.index > 0 ? page.index - 1 : 0, page.index == 0))
+            .add_component (button (std::to_string (page.index + 1) + "/"
+                                        + std::to_string (page.count),
+                                    page.count, true))
+            .add_component (button ("▶", std::min (page.index + 1, last), page.index == last)));
+    return msg;
+  }
+
+  // First page of a reply, the rest waits in the page cache under the interaction id
+  dpp::message pagedReply (const dpp::slashcommand_t& event, std::string text,
+                           const std::string& prefix = "", const std::string& suffix = "") {
+    std::string key = std::to_string (event.command.id);
+    pages->put (key, std::move (text), prefix, suffix, DISCORD_MAX_MSG_LEN);
+    auto page = pages->get (key, 0);
+    return page ? pageMessage (event.command.channel_id, *page, key)
+                : dpp::message (event.command.channel_id, "");
+  }
+
+  // Webhook avatar of a feed from "webhooks" -> "avatars" -> "<host>", empty keeps the default
+  std::string avatarFor (const std::string& source) {
+    nlohmann::json section = BotConfig::get ().value ("webhooks", nlohmann::json::object ());
+    nlohmann::json avatars = section.value ("avatars", nlohmann::json::object ());
+    auto avatar = avatars.find (source);
+    return avatar != avatars.end () && avatar->is_string () ? avatar->get<std::string> () : "";
+  }
+
+  // Webhook lanes fall back to the bot's messages where a webhook cannot serve them
+  bool webhookUsable (uint64_t channelId) {
+    // Only the bot can crosspost in an announcement channel, so the lane posts as the bot
+    if (channelTypes.isAnnouncement (channelId).value_or (false) && webhooks.disable (channelId)) {
+      LOG_W_STREAM << "Channel " << channelId << " is an announcement channel, its \"webhook\": "
+                   << "true lane config is ignored so posts are crossposted" << std::endl;
+    }
+    return !webhooks.isDisabled (channelId) && !webhooks.hasFailed (channelId);
+  }
+
+  // Waited for by initCluster, blocked in every thread so no other thread is interrupted
+  sigset_t shutdownSignals () {
+    sigset_t signals;
+    sigemptyset (&signals);
+    sigaddset (&signals, SIGTERM);
+    sigaddset (&signals, SIGINT);
+    return signals;
+  }
+
+  // Sun times change with the calendar day
+  std::string localDay () {
+    std::time_t now = std::time (nullptr);
+    std::tm localTime{};
+    localtime_r (&now, &localTime); // called from event and worker threads
+    char day[16] = "";
+    std::strftime (day, sizeof (day), "%Y-%m-%d", &localTime);
+    return day;
+  }
+}
 
 const std::string botCommandsHelp = R"(
 `/bot` - display this information
@@ -39,11 +183,14 @@ const std::string botCommandsHelp = R"(
 `/refetch` - fetch new feeds from web
 `/getfeednow` - print feed right now
 `/listsources` - list RSS sources
+`/search` query: `kernel 6` - search posted items
+`/recent` - recently posted items, optionally `source:` URL and `count:`
 `/addsource` - add RSS source [RSS 1.0, 2.0, Atom]
 `/addsource url:https://www.root.cz/rss/clanky/ embedded:true`
 `/runterminalcommand` `fortune` `df -h` `free -h` `cat /etc/os-release`
 `/heygoogle` prompt: `What's the weather like today?` - ask Google Gemini AI
 `/sunrise/sunset/sunriset` - get sunset and sunrise times for Mníšek pod Brdy, Praha, Brno, Bratislava, Košice
+`/stats` - slash command call counts and latency
 `/ping` - ping pong!
 
 )";
@@ -55,7 +202,50 @@ const std::string botDescription
 #define RIGHT_TXT_MARKDOWN "\n```"
 
 DiscordBot::DiscordBot () {
+  // Before the first thread, threads inherit the mask
+  sigset_t signals = shutdownSignals ();
+  pthread_sigmask (SIG_BLOCK, &signals, nullptr);
+
+  BotConfig::load ();
+  workers = std::make_unique<WorkerPool> (BotConfig::value<size_t> ("workers/threads", 4),
+                                          BotConfig::value<size_t> ("workers/maxQueued", 32));
+  workers->setLimit ("fortune", 2); // the only command still spawning a process
+  // Fetch cycles and feed probes block on curl, one of each keeps threads free for commands
+  workers->setLimit ("fetch", 1);
+  workers->setLimit ("probe", 1);
+  workers->setLimit ("sun", 1); // renders share the sunriset config file
+  pages = std::make_unique<PageCache> (
+      BotConfig::value<size_t> ("pages/maxEntries", 64),
+      std::chrono::seconds (BotConfig::value<int> ("pages/ttlSeconds", 60 * 15)));
+  ownership = std::make_unique<ShardOwnership> (ShardConfig::fromBotConfig ());
+  if (!ownership->isSingleCluster ()) {
+    const ShardConfig& sharding = ownership->getConfig ();
+    LOG_I_STREAM << "Cluster " << sharding.clusterId << " of " << sharding.maxClusters << ", "
+                 << sharding.shardCount << " shards" << std::endl;
+    rss.setInstanceName ("cluster" + std::to_string (sharding.clusterId));
+    // Lane 0 posts into the default channel
+    rss.setChannelFilter ([] (uint64_t channelId) {
+      return ownership->ownsChannel (channelId != 0 ? channelId : defaultChannelRss);
+    });
+  }
   rss.initialize ();
+  rss.setFetchFreshness (
+      std::chrono::seconds (BotConfig::value<int> ("fetch/freshnessSeconds", 60)));
+  rss.setDeliveryBatch (BotConfig::value<size_t> ("outbox/batchSize", 16));
+
+  // One callback server per host, the first cluster runs it
+  if (BotConfig::value<bool> ("webSub/enabled", false) && ownership->getConfig ().clusterId == 0) {
+    WebSubOptions options;
+    options.bindAddress = BotConfig::value<std::string> ("webSub/bindAddress", options.bindAddress);
+    options.port = BotConfig::value<uint16_t> ("webSub/port", options.port);
+    options.callbackUrl = BotConfig::value<std::string> ("webSub/callbackUrl", options.callbackUrl);
+    options.leaseSeconds = BotConfig::value<int> ("webSub/leaseSeconds", options.leaseSeconds);
+    options.safetyNetPollInterval
+        = BotConfig::value<int> ("webSub/safetyNetPollInterval", options.safetyNetPollInterval);
+    options.verifyTimeoutSeconds
+        = BotConfig::value<int> ("webSub/verifyTimeoutSeconds", options.verifyTimeoutSeconds);
+    rss.enableWebSub (options);
+  }
 }
 
 //              _ _
@@ -67,48 +257,19 @@ DiscordBot::DiscordBot () {
 // | |
 // |_|
 // Printing feed items
-std::atomic<bool> isPollingPrintFeedRunning (false);
-std::atomic<bool> stopPollingPrintFeed (false);
 bool DiscordBot::startPollingPrintFeed () {
-  std::thread pollingThreadPrintFeed ([&] () -> void {
-    while (!stopPollingPrintFeed.load ()) {
-      try {
-        RSSItem item = rss.getRandomItem ();
-        if (!item.title.empty ()) {
-          // Want answer in the channel received by rss, or default channel if not specified
-          printStringToChannel (item.toMarkdownLink (),
-                                item.discordChannelId > 0 ? item.discordChannelId
-                                                          : defaultChannelRss,
-                                {}, item.embedded);
-        } else {
-          LOG_W_STREAM << "No items found in the feed queue." << std::endl;
-        }
-        isPollingPrintFeedRunning.store (true);
-      } catch (const std::runtime_error& e) {
-        LOG_E_STREAM << "Error: " << e.what () << std::endl;
-        isPollingPrintFeedRunning.store (false);
-      }
-
-      int printFeedInterval = 0;
-      std::time_t now = std::time (nullptr);
-      std::tm* localTime = std::localtime (&now);
-
+  if (lanes)
+    return false; // lane tasks keep pointers to the existing lanes
+  lanes = std::make_unique<DeliveryLanes> (
+      scheduler, rss, [this] (const RSSItem& item, uint64_t laneId, bool embedded, bool webhook) {
+        // Want answer in the channel received by rss, or default channel if not specified
+        postItem (item, laneId > 0 ? laneId : defaultChannelRss, embedded, webhook);
+      });
 #ifndef PUBLIC_RELEASED_DISCORD_BOT
-      // In development mode, use ultra fast polling
-      printFeedInterval = ULTRA_FAST_POLLING_INTERVAL;
-#else
-      if ((localTime->tm_hour >= START_SLOW_MODE_AT_HOUR)
-          || (localTime->tm_hour < STOP_SLOW_MODE_AT_HOUR)) {
-        printFeedInterval = SLOW_MODE_POLLING_INTERVAL;
-      } else {
-        printFeedInterval = NORMAL_MODE_POLLING_INTERVAL;
-      }
+  // In development mode, use ultra fast polling
+  lanes->setFixedInterval (std::chrono::seconds (ULTRA_FAST_POLLING_INTERVAL));
 #endif
-
-      std::this_thread::sleep_for (std::chrono::seconds (printFeedInterval));
-    }
-  });
-  pollingThreadPrintFeed.detach ();
+  lanes->start (std::chrono::seconds (STARTUP_DELAY));
   return true;
 }
 
@@ -121,25 +282,55 @@ bool DiscordBot::startPollingPrintFeed () {
 // | |
 // |_|
 // Fetching feeds
-std::atomic<bool> isPollingFetchFeedRunning (false);
-std::atomic<bool> stopPollingFetchFeed (false);
 bool DiscordBot::startPollingFetchFeed () {
-  std::thread pollingThreadFetchFeed ([&] () -> void {
-    while (!stopPollingFetchFeed.load ()) {
-      try {
-#ifdef IS_RSS_MODULE_ACTIVEInvalid Form Body - data.content : Must be 2000 \
-    or fewer in length.(BASE_TYPE_MAX_LENGTH)
-        rss.fetchAllFeeds ();
+  // Only the timer lives on the scheduler, the cycle itself blocks and runs on a worker
+  fetchTask = scheduler.scheduleEvery (
+      std::chrono::seconds (FEED_FETCH_INTERVAL),
+      [] () {
+        bool submitted = workers->submit ("fetch", [] () {
+          if (fetchRequested.exchange (false)) {
+            rss.invalidateFetch ();
+          }
+          try {
+#ifdef IS_RSS_MODULE_ACTIVE
+            rss.fetchAllFeeds ();
 #endif
-        isPollingFetchFeedRunning.store (true);
-      } catch (const std::runtime_error& e) {
-        LOG_E_STREAM << "Error: " << e.what () << std::endl;
-        isPollingFetchFeedRunning.store (false);
-      }
-      std::this_thread::sleep_for (std::chrono::seconds (FEED_FETCH_INTERVAL));
-    }
-  });
-  pollingThreadFetchFeed.detach ();
+          } catch (const std::runtime_error& e) {
+            LOG_E_STREAM << "Error: " << e.what () << std::endl;
+          }
+          // The interval counts from the end of a cycle, channels learned meanwhile are
+          // fetched right after it
+          int delay = fetchRequested ? STARTUP_DELAY : FEED_FETCH_INTERVAL;
+          scheduler.reschedule (fetchTask, std::chrono::seconds (delay));
+        });
+        if (!submitted) {
+          LOG_W_STREAM << "Worker queue full, feed fetch skipped until the next interval"
+                       << std::endl;
+        }
+      },
+      "fetch", std::chrono::seconds (STARTUP_DELAY));
+
+  // Wake-up latency of every scheduled task, a growing lateness means a task hogs the thread
+  scheduler.scheduleEvery (
+      std::chrono::seconds (SCHEDULER_STATS_INTERVAL),
+      [] () {
+        for (const auto& stats : scheduler.getStats ()) {
+          LOG_I_STREAM << "Task " << stats.name << ": " << stats.runs << " runs, lateness last "
+                       << stats.lastLateness.count () << " us, mean " << stats.meanLateness.count ()
+                       << " us, max " << stats.maxLateness.count () << " us, took "
+                       << stats.lastDuration.count () << " us" << std::endl;
+        }
+      },
+      "stats");
+
+  // Group commit of confirmed deliveries that did not fill a batch
+  scheduler.scheduleEvery (
+      std::chrono::seconds (OUTBOX_FLUSH_INTERVAL), [] () { rss.flushDeliveries (); }, "outbox");
+
+  // System reports are rendered here, so /env answers from memory
+  scheduler.scheduleEvery (
+      std::chrono::seconds (SYSINFO_REFRESH_INTERVAL), [] () { sysInfo.refresh (); }, "sysinfo",
+      std::chrono::seconds (0));
   return true;
 }
 
@@ -161,7 +352,20 @@ int DiscordBot::initCluster () {
 
   try {
     DiscordBot::bot_
-        = std::make_unique<dpp::cluster> (token, dpp::i_default_intents | dpp::i_message_content);
+        = std::make_unique<dpp::cluster> (token, dpp::i_default_intents | dpp::i_message_content,
+                                          ownership->getConfig ().shardCount,
+                                          ownership->getConfig ().clusterId,
+                                          ownership->getConfig ().maxClusters);
+    sendPipeline = std::make_unique<SendPipeline> (
+        scheduler,
+        [this] (const OutboundMessage& outbound, SendPipeline::Done done) {
+          sendOutbound (outbound, std::move (done));
+        },
+        DISCORD_MAX_MSG_LEN);
+    RetryPolicy retry;
+    retry.attempts = BotConfig::value<unsigned> ("delivery/retryAttempts", retry.attempts);
+    delivery = std::make_unique<DeliveryEngine> (
+        *bot_, BotConfig::value<size_t> ("delivery/maxInFlight", 4), retry);
 
     // onlog callback
     bot_->log (dpp::ll_info, "Bot++");
@@ -170,12 +374,35 @@ int DiscordBot::initCluster () {
                    << dpp::utility::loglevel (log.severity) << ": " << log.message << std::endl;
     });
 
+    // Stopped in reverse: scheduler first, then the workers and the gateway, so no confirmation
+    // arrives after the RSS state is flushed last. The flush is essential, it still runs in the
+    // reserved end of the deadline when an earlier step hangs.
+    services.add ("rss", nullptr, [] () { rss.shutdown (); }, true);
+    services.add ("discord", nullptr, [this] () { bot_->shutdown (); });
+    services.add ("workers", nullptr, [] () { workers->stop (); });
+    services.add (
+        "fetch", [this] () { startPollingFetchFeed (); }, [] () { rss.stopFetching (); });
+    services.add ("lanes", [this] () { startPollingPrintFeed (); }, nullptr);
+    services.add ("scheduler", [] () { scheduler.start (); }, [] () { scheduler.stop (); });
+
     // slash commands and ready commands
     loadOnSlashCommands ();
     loadOnReadyCommands ();
 
     // Set the bot's presence
-    bot_->start (dpp::st_wait);
+    bot_->start (dpp::st_return);
+
+    sigset_t signals = shutdownSignals ();
+    int received = 0;
+    sigwait (&signals, &received);
+    LOG_I_STREAM << "Received signal " << received << ", shutting down" << std::endl;
+    std::vector<std::string> unfinished
+        = services.stopAll (std::chrono::seconds (SHUTDOWN_TIMEOUT),
+                            std::chrono::seconds (SHUTDOWN_FLUSH_RESERVE));
+    if (!unfinished.empty ()) {
+      // The hanging step still uses the globals, static destruction must not run under it
+      std::_Exit (EXIT_FAILURE);
+    }
   } catch (const std::exception& e) {
     LOG_E_STREAM << "Exception during bot initialization: " << e.what () << std::endl;
     return -1;
@@ -190,268 +417,530 @@ int DiscordBot::initCluster () {
 // \__ \ | (_| \__ \ | | |
 // |___/_|\__,_|___/_| |_|
 // onSlashCommands
-void DiscordBot::loadOnSlashCommands () {
-  GoogleGemini gemini;
-  bot_->on_slashcommand ([&, this] (const dpp::slashcommand_t& event) {
-    if (event.command.get_command_name () == "sunset"
-        || event.command.get_command_name () == "sunrise"
-        || event.command.get_command_name () == "sunriset") {
-      std::filesystem::path assetsPath = AssetContext::getAssetsPath ();
-      Params params; // new copy of memory
-      params.utcOffsetMinutes = { true, 120 };
-      params.riseOffsetMinutes = { true, 0 };
-      params.setOffsetMinutes = { true, 0 };
-
-      // Mníšek pod Brdy
-      params.lat = { true, 50.0833 };
-      params.lon = { true, 14.4167 };
-      SunrisetWorker sunrisetWorker1 (assetsPath, params);
-      std::string msg = LEFT_TXT_MARKDOWN
-                        + std::string (sunrisetWorker1.getSetTime () + " ➔ Mníšek pod Brdy\n");
-      // Praha
-      params.lat = { true, 50.0755 };
-      params.lon = { true, 14.4378 };
-      SunrisetWorker sunrisetWorker2 (assetsPath, params);
-      msg += std::string (sunrisetWorker2.getSetTime () + " ➔ Praha\n");
-      // Brno
-      params.lat = { true, 49.1951 };
-      params.lon = { true, 16.6068 };
-      SunrisetWorker sunrisetWorker3 (assetsPath, params);
-      msg += std::string (sunrisetWorker3.getSetTime () + " ➔ Brno\n");
-      // Bratislava
-      params.lat = { true, 48.1482 };
-      params.lon = { true, 17.1067 };
-      SunrisetWorker sunrisetWorker4 (assetsPath, params);
-      msg += std::string (sunrisetWorker4.getSetTime () + " ➔ Bratislava\n");
-      // Košice
-      params.lat = { true, 48.7156 };
-      params.lon = { true, 21.2611 };
-      SunrisetWorker sunrisetWorker5 (assetsPath, params);
-      msg += std::string (sunrisetWorker5.getSetTime () + " ➔ Košice\n");
-      msg += "Awesome calculator by (c) Paul Schlyter, 1989, 1992" + std::string (RIGHT_TXT_MARKDOWN);
-      event.reply (msg);
+std::vector<DiscordBot::SlashCommand> DiscordBot::buildCommandTable () {
+  auto handle = [this] (void (DiscordBot::*handler) (const dpp::slashcommand_t&)) {
+    return [this, handler] (const dpp::slashcommand_t& event) { (this->*handler) (event); };
+  };
+  // The application id is filled in at registration, it is known only once the bot is ready.
+  // A concurrency limit marks a blocking handler, it is deferred to the worker pool.
+  return {
+    { dpp::slashcommand ("sunset", "Get Sunset Now", 0), handle (&DiscordBot::onSunCommand) },
+    { dpp::slashcommand ("sunrise", "Get Sunrise Now", 0), handle (&DiscordBot::onSunCommand) },
+    { dpp::slashcommand ("sunriset", "Get Sunrise Time", 0), handle (&DiscordBot::onSunCommand) },
+    { dpp::slashcommand ("heygoogle", "Ask Google Gemini AI", 0)
+          .add_option (dpp::command_option (dpp::co_string, "prompt",
+                                            "The prompt to send to Google Gemini", true)),
+      handle (&DiscordBot::onHeyGoogle), 2 },
+    { dpp::slashcommand ("refetch", "Refetch all RSS feeds", 0), handle (&DiscordBot::onRefetch),
+      1 },
+    { dpp::slashcommand ("queue", "Get queue of RSS items", 0), handle (&DiscordBot::onQueue) },
+    { dpp::slashcommand ("getfeednow", "Get RSS feed now", 0),
+      handle (&DiscordBot::onGetFeedNow) },
+    { dpp::slashcommand ("recent", "Recently posted RSS items", 0)
+          .add_option (dpp::command_option (dpp::co_string, "source",
+                                            "Only items from this RSS source", false))
+          .add_option (dpp::command_option (dpp::co_integer, "count",
+                                            "Number of items (default 10)", false)
+                           .set_min_value (1)
+                           .set_max_value (50)),
+      handle (&DiscordBot::onRecent) },
+    { dpp::slashcommand ("search", "Search posted RSS items", 0)
+          .add_option (dpp::command_option (dpp::co_string, "query",
+                                            "Words to search for (diacritics optional)", true)),
+      handle (&DiscordBot::onSearch) },
+    { dpp::slashcommand ("listsources", "List all RSS sources", 0),
+      handle (&DiscordBot::onListSources) },
+    { dpp::slashcommand ("addsource",
+                         "Add a new RSS source + <channel_id> where command was invoked", 0)
+          .add_option (dpp::command_option (dpp::co_string, "url", "URL of the RSS feed", true))
+          .add_option (dpp::command_option (dpp::co_boolean, "embedded",
+                                            "Whether the feed should be embedded in the message",
+                                            false)),
+      handle (&DiscordBot::onAddSource) },
+    { dpp::slashcommand ("runterminalcommand", "Run a terminal command and return the output", 0)
+          .add_option (dpp::command_option (dpp::co_string, "command",
+                                            "The terminal command to run", true)),
+      handle (&DiscordBot::onRunTerminalCommand) },
+    { dpp::slashcommand ("ping", "Ping pong!", 0), handle (&DiscordBot::onPing) },
+    { dpp::slashcommand ("bot", "About Bot++", 0), handle (&DiscordBot::onBot) },
+    { dpp::slashcommand ("env", "Display environment information", 0),
+      handle (&DiscordBot::onEnv) },
+    { dpp::slashcommand ("stats", "Slash command call counts and latency", 0),
+      handle (&DiscordBot::onStats) },
+  };
+}
+
+void DiscordBot::deferToWorkers (const std::string& name, const dpp::slashcommand_t& event,
+                                 std::function<void (const dpp::slashcommand_t&)> run) {
+  // Acknowledge at once, the handler completes the reply with edit_original_response
+  event.thinking (false, [this, name, event, run] (const dpp::confirmation_callback_t& callback) {
+    if (callback.is_error ()) {
+      LOG_E_STREAM << "Failed to defer /" << name << ": " << callback.get_error ().message
+                   << std::endl;
+      return;
     }
+    // The router timed only the acknowledgement, the run itself is recorded here
+    auto task = [this, event, run] () {
+      auto started = std::chrono::steady_clock::now ();
+      auto record = [this, &event, started] (bool failed) {
+        commandRouter_.recordExecution (event.command.get_command_name (),
+                                        std::chrono::duration_cast<std::chrono::microseconds> (
+                                            std::chrono::steady_clock::now () - started),
+                                        failed);
+      };
+      try {
+        run (event);
+      } catch (const std::exception&) {
+        record (true);
+        throw; // logged by the worker pool
+      }
+      record (false);
+    };
+    if (!workers->submit (name, task)) {
+      LOG_W_STREAM << "Worker queue full, /" << name << " refused" << std::endl;
+      completeDeferred (event, "Busy, please try again in a moment.");
+    }
+  });
+}
 
-    if (event.command.get_command_name () == "heygoogle") {
+void DiscordBot::loadOnSlashCommands () {
+  commandTable_ = buildCommandTable ();
+  for (const auto& command : commandTable_) {
+    auto handler = command.handler;
+    if (command.concurrency > 0) {
+      workers->setLimit (command.definition.name, command.concurrency);
+      handler = [this, name = command.definition.name,
+                 run = command.handler] (const dpp::slashcommand_t& event) {
+        deferToWorkers (name, event, run);
+      };
+    }
+    if (commandRouter_.add (command.definition.name, handler) != 0) {
+      LOG_W_STREAM << "Duplicate slash command in the table: " << command.definition.name
+                   << std::endl;
+    }
+  }
+  bot_->on_slashcommand ([this] (const dpp::slashcommand_t& event) {
+    if (!commandRouter_.dispatch (event.command.get_command_name (), event)) {
+      LOG_W_STREAM << "Unknown slash command: " << event.command.get_command_name () << std::endl;
+      event.reply ("Error: Unknown command.");
+    }
+  });
+  bot_->on_button_click ([] (const dpp::button_click_t& event) {
+    std::string key;
+    size_t index = 0;
+    if (!PageCache::parseButtonId (event.custom_id, key, index))
+      return;
+    auto page = pages->get (key, index);
+    if (!page) {
+      event.reply (dpp::message ("This listing has expired, run the command again.")
+                       .set_flags (dpp::m_ephemeral));
+      return;
+    }
+    dpp::message msg = pageMessage (event.command.channel_id, *page, key);
+    msg.set_flags (event.command.msg.flags & dpp::m_suppress_embeds);
+    event.reply (dpp::ir_update_message, msg);
+  });
+}
 
-      auto prompt_param = event.get_parameter ("prompt");
-      if (prompt_param.index () == 0) {
-        event.reply ("Error: Prompt parameter is required.");
-        return;
-      }
+void DiscordBot::onSunCommand (const dpp::slashcommand_t& event) {
+  std::string day = localDay ();
+  if (auto cached = responses.lookup ("sun", day)) {
+    event.reply (*cached);
+    return;
+  }
+  // A miss reads and rewrites the sunriset config per city, that is blocking work
+  deferToWorkers ("sun", event, [this, day] (const dpp::slashcommand_t& deferred) {
+    std::string text = renderSunTimes ();
+    responses.put ("sun", day, dpp::message (text));
+    completeDeferred (deferred, text);
+  });
+}
 
-      std::string apiKey;
-      std::string prompt = std::get<std::string> (event.get_parameter ("prompt"));
-      LOG_I_STREAM << "/HeyGoogle " << prompt << std::endl;
-      event.reply ("/HeyGoogle " + prompt);
+std::string DiscordBot::renderSunTimes () {
+  std::filesystem::path assetsPath = AssetContext::getAssetsPath ();
+  Params params; // new copy of memory
+  params.utcOffsetMinutes = { true, 120 };
+  params.riseOffsetMinutes = { true, 0 };
+  params.setOffsetMinutes = { true, 0 };
 
-      if (prompt.empty ()) {
-        event.reply ("Error: Prompt parameter is required.");
-        return;
-      }
+  // Mníšek pod Brdy
+  params.lat = { true, 50.0833 };
+  params.lon = { true, 14.4167 };
+  SunrisetWorker sunrisetWorker1 (assetsPath, params);
+  std::string msg = LEFT_TXT_MARKDOWN
+                    + std::string (sunrisetWorker1.getSetTime () + " ➔ Mníšek pod Brdy\n");
+  // Praha
+  params.lat = { true, 50.0755 };
+  params.lon = { true, 14.4378 };
+  SunrisetWorker sunrisetWorker2 (assetsPath, params);
+  msg += std::string (sunrisetWorker2.getSetTime () + " ➔ Praha\n");
+  // Brno
+  params.lat = { true, 49.1951 };
+  params.lon = { true, 16.6068 };
+  SunrisetWorker sunrisetWorker3 (assetsPath, params);
+  msg += std::string (sunrisetWorker3.getSetTime () + " ➔ Brno\n");
+  // Bratislava
+  params.lat = { true, 48.1482 };
+  params.lon = { true, 17.1067 };
+  SunrisetWorker sunrisetWorker4 (assetsPath, params);
+  msg += std::string (sunrisetWorker4.getSetTime () + " ➔ Bratislava\n");
+  // Košice
+  params.lat = { true, 48.7156 };
+  params.lon = { true, 21.2611 };
+  SunrisetWorker sunrisetWorker5 (assetsPath, params);
+  msg += std::string (sunrisetWorker5.getSetTime () + " ➔ Košice\n");
+  msg += "Awesome calculator by (c) Paul Schlyter, 1989, 1992" + std::string (RIGHT_TXT_MARKDOWN);
+  return msg;
+}
 
-      try {
-        if (getGoogleGeminiTokenFromFile (apiKey) != 0) {
-          LOG_E_STREAM << "Failed to read Google Gemini API key from file: "
-                       << GEMINI_OAUTH_TOKEN_FILE << std::endl;
-          event.reply ("Error: Failed to read Google Gemini API key.");
-          return;
-        }
+void DiscordBot::onHeyGoogle (const dpp::slashcommand_t& event) {
+  GoogleGemini gemini;
+  auto prompt_param = event.get_parameter ("prompt");
+  if (prompt_param.index () == 0) {
+    completeDeferred (event, "Error: Prompt parameter is required.");
+    return;
+  }
 
-        std::string response
-            = gemini.generateContentGemini (apiKey, GEMINI_MODEL, prompt + "Maximum 1900 znaků");
-        if (response.empty ()) {
-          event.reply ("Error: No response from Google Gemini.");
-          return;
-        }
+  std::string apiKey;
+  std::string prompt = std::get<std::string> (event.get_parameter ("prompt"));
+  LOG_I_STREAM << "/HeyGoogle " << prompt << std::endl;
 
-        std::string truncatedResponse = response.substr (0, DISCORD_MAX_MSG_LEN - 100);
-        dpp::message msg (event.command.channel_id, truncatedResponse);
-        LOG_I_STREAM << "Response from Google Gemini: " << truncatedResponse << std::endl;
-        bot_->message_create (msg);
+  if (prompt.empty ()) {
+    completeDeferred (event, "Error: Prompt parameter is required.");
+    return;
+  }
 
-      } catch (const std::exception& e) {
-        LOG_E_STREAM << "Exception while processing /heygoogle command: " << e.what () << std::endl;
-        event.reply ("Error: " + std::string (e.what ()));
-      }
+  try {
+    if (getGoogleGeminiTokenFromFile (apiKey) != 0) {
+      LOG_E_STREAM << "Failed to read Google Gemini API key from file: "
+                   << GEMINI_OAUTH_TOKEN_FILE << std::endl;
+      completeDeferred (event, "Error: Failed to read Google Gemini API key.");
       return;
     }
 
-    if (event.command.get_command_name () == "refetch") {
-      try {
-        event.reply ("Refetching all RSS feeds...");
-        rss.fetchAllFeeds ();
-        size_t itemCount = rss.getItemCount ();
-        if (itemCount == 0) {
-          LOG_W_STREAM << NO_ITEMS_IN_QUEUE << std::endl;
-          event.reply (NO_ITEMS_IN_QUEUE);
-          return;
-        }
-        std::string response = "All RSS feeds have been refetched successfully. Queue contains "
-                               + std::to_string (itemCount) + " items.\n";
-        dpp::message msg (event.command.channel_id, response);
-        bot_->message_create (msg);
-      } catch (const std::runtime_error& e) {
-        LOG_E_STREAM << "Error: " << e.what () << std::endl;
-        event.reply ("Error refetching feeds: " + std::string (e.what ()));
-      }
+    std::string response
+        = gemini.generateContentGemini (apiKey, GEMINI_MODEL, prompt + "Maximum 1900 znaků");
+    if (response.empty ()) {
+      completeDeferred (event, "Error: No response from Google Gemini.");
       return;
     }
-    if (event.command.get_command_name () == "queue") {
-      try {
-        size_t itemCount = rss.getItemCount ();
-        if (itemCount == 0) {
-          event.reply (NO_ITEMS_IN_QUEUE);
-          return;
-        }
-        std::string response
-            = "RSS feed queue contains " + std::to_string (itemCount) + " items.\n";
-        LOG_I_STREAM << response;
-        event.reply (response);
-      } catch (const std::runtime_error& e) {
-        LOG_E_STREAM << "Error: " << e.what () << std::endl;
-      }
-    }
-    if (event.command.get_command_name () == "listsources") {
-      std::string sources = rss.getSourcesAsList ();
-      if (sources.empty ()) {
-        event.reply ("No RSS sources found.");
-      } else {
-        size_t maxLen = DISCORD_MAX_MSG_LEN - 100;
-        if (sources.length () > maxLen) {
-          event.reply (LEFT_TXT_MARKDOWN + sources.substr (0, maxLen) + RIGHT_TXT_MARKDOWN);
-          for (size_t i = maxLen; i < sources.length (); i += maxLen) {
-            dpp::message msg (event.command.channel_id,
-                              LEFT_TXT_MARKDOWN + sources.substr (i, maxLen) + RIGHT_TXT_MARKDOWN);
-            bot_->message_create (msg);
-          }
-        } else {
-          event.reply (LEFT_TXT_MARKDOWN + sources + RIGHT_TXT_MARKDOWN);
-        }
-      }
+
+    LOG_I_STREAM << "Response from Google Gemini: " << response << std::endl;
+    completeDeferred (event, "/HeyGoogle " + prompt + "\n" + response);
+
+  } catch (const std::exception& e) {
+    LOG_E_STREAM << "Exception while processing /heygoogle command: " << e.what () << std::endl;
+    completeDeferred (event, "Error: " + std::string (e.what ()));
+  }
+}
+
+void DiscordBot::onRefetch (const dpp::slashcommand_t& event) {
+  // This run replaces the next periodic one, a cycle already running elsewhere is joined
+  scheduler.reschedule (fetchTask, std::chrono::seconds (FEED_FETCH_INTERVAL));
+  std::string response;
+  try {
+    rss.fetchAllFeeds ();
+    size_t itemCount = rss.getItemCount ();
+    response = itemCount == 0 ? NO_ITEMS_IN_QUEUE
+                              : ALL_FEEDS_REFETCHED + " Queue contains "
+                                    + std::to_string (itemCount) + " items.\n";
+  } catch (const std::runtime_error& e) {
+    LOG_E_STREAM << "Error: " << e.what () << std::endl;
+    response = "Error refetching feeds: " + std::string (e.what ());
+  }
+  completeDeferred (event, response);
+}
+
+void DiscordBot::onQueue (const dpp::slashcommand_t& event) {
+  try {
+    size_t itemCount = rss.getItemCount ();
+    if (itemCount == 0) {
+      event.reply (NO_ITEMS_IN_QUEUE);
       return;
     }
-    if (event.command.get_command_name () == "getfeednow") {
-      try {
-        RSSItem item = rss.getRandomItem ();
-        if (!item.title.empty ()) {
-          // Want answer in the same channel
-          printStringToChannel (item.toMarkdownLink (), event.command.channel_id, event,
-                                item.embedded);
-        } else {
-          LOG_W_STREAM << NO_ITEMS_IN_QUEUE << std::endl;
-          event.reply (NO_ITEMS_IN_QUEUE);
-        }
-      } catch (const std::runtime_error& e) {
-        LOG_E_STREAM << "Error: " << e.what () << std::endl;
-      }
-    }
-    if (event.command.get_command_name () == "addsource") {
-      auto url_param = event.get_parameter ("url");
-      if (url_param.index () == 0) { // std::monostate means parameter doesn't exist
-        event.reply ("Error: URL parameter is required.");
-        return;
-      }
-      std::string url = std::get<std::string> (event.get_parameter ("url"));
+    std::string response = "RSS feed queue contains " + std::to_string (itemCount) + " items.\n";
+    LOG_I_STREAM << response;
+    event.reply (response);
+  } catch (const std::runtime_error& e) {
+    LOG_E_STREAM << "Error: " << e.what () << std::endl;
+  }
+}
 
-      bool embedded = false;
-      auto embedded_param = event.get_parameter ("embedded");
-      if (embedded_param.index () != 0) { // Check if parameter exists (not std::monostate)
-        embedded = std::get<bool> (embedded_param);
-      }
-      if (url.empty ()) {
-        event.reply ("Error: URL parameter is required.");
-        return;
-      }
-      try {
-        // Add the URL to the RSS manager - use the channel ID from the command
-        int result = rss.addUrl (url, embedded, event.command.channel_id);
-        if (result == -1) {
-          LOG_W_STREAM << "URL already exists: " << url << std::endl;
-          event.reply ("Warning: URL already exists.");
-          return;
-        }
-        event.reply ("Source added successfully: " + url);
-      } catch (const std::runtime_error& e) {
-        LOG_E_STREAM << "Error adding source: " << e.what () << std::endl;
-        event.reply ("Error adding source: " + std::string (e.what ()));
-        return;
+void DiscordBot::onListSources (const dpp::slashcommand_t& event) {
+  std::string sources = responses
+                            .getOrRender ("listsources", rss.getSourcesRevision (),
+                                          [] () { return dpp::message (rss.getSourcesAsList ()); })
+                            .content;
+  if (sources.empty ()) {
+    event.reply ("No RSS sources found.");
+  } else {
+    event.reply (pagedReply (event, std::move (sources), LEFT_TXT_MARKDOWN, RIGHT_TXT_MARKDOWN));
+  }
+}
+
+void DiscordBot::onRecent (const dpp::slashcommand_t& event) {
+  std::string source;
+  auto source_param = event.get_parameter ("source");
+  if (source_param.index () != 0) {
+    source = std::get<std::string> (source_param);
+  }
+  size_t count = 10;
+  auto count_param = event.get_parameter ("count");
+  if (count_param.index () != 0) {
+    count = static_cast<size_t> (std::clamp<int64_t> (std::get<int64_t> (count_param), 1, 50));
+  }
+
+  std::vector<ArchiveRecord> records = rss.getRecentDeliveries (count, source);
+  if (records.empty ()) {
+    event.reply ("No posted items recorded yet.");
+    return;
+  }
+  std::string response = "Recently posted items:\n";
+  for (const auto& record : records) {
+    char when[24] = "";
+    std::tm postedAt{};
+    localtime_r (&record.postedAt, &postedAt);
+    std::strftime (when, sizeof (when), "%Y-%m-%d %H:%M", &postedAt);
+    std::string line = std::string ("- ") + when + " <#" + std::to_string (record.channelId)
+                       + "> [" + record.title + "](<" + record.link + ">)\n";
+    if (response.size () + line.size () > DISCORD_MAX_MSG_LEN)
+      break;
+    response += line;
+  }
+  event.reply (response);
+}
+
+void DiscordBot::onSearch (const dpp::slashcommand_t& event) {
+  auto query_param = event.get_parameter ("query");
+  if (query_param.index () == 0) {
+    event.reply ("Error: Query parameter is required.");
+    return;
+  }
+  std::string query = std::get<std::string> (query_param);
+  std::vector<SearchHit> hits = rss.search (query, 10);
+  if (hits.empty ()) {
+    event.reply ("Nothing posted matches: " + query);
+    return;
+  }
+  std::string response = "Posted items matching **" + query + "**:\n";
+  for (const auto& hit : hits) {
+    char date[16] = "";
+    std::tm postedAt{};
+    localtime_r (&hit.document.postedAt, &postedAt);
+    std::strftime (date, sizeof (date), "%Y-%m-%d", &postedAt);
+    std::string line = std::string ("- ") + date + " [" + hit.document.title + "](<"
+                       + hit.document.link + ">)\n";
+    if (response.size () + line.size () > DISCORD_MAX_MSG_LEN)
+      break;
+    response += line;
+  }
+  event.reply (response);
+}
+
+void DiscordBot::onGetFeedNow (const dpp::slashcommand_t& event) {
+  try {
+    RSSItem item = rss.getNextItem ();
+    if (!item.title.empty ()) {
+      // Want answer in the same channel
+      dpp::snowflake channelId = event.command.channel_id;
+      // confirmed only once Discord accepted the reply
+      int result = printStringToChannel (
+          item.toMarkdownLink (), channelId, event, item.embedded,
+          [item, channelId] (dpp::snowflake messageId) {
+            rss.confirmDelivery (item, channelId, messageId);
+          },
+          [item] (uint16_t httpStatus) { rss.failDelivery (item, httpStatus); });
+      if (result != 0) {
+        rss.failDelivery (item);
       }
-      rss.fetchAllFeeds ();
-      return;
+    } else {
+      LOG_W_STREAM << NO_ITEMS_IN_QUEUE << std::endl;
+      event.reply (NO_ITEMS_IN_QUEUE);
     }
-    if (event.command.get_command_name () == "runterminalcommand") {
+  } catch (const std::runtime_error& e) {
+    LOG_E_STREAM << "Error: " << e.what () << std::endl;
+  }
+}
 
-      auto command_param = event.get_parameter ("command");
-      if (command_param.index () == 0) {
-        event.reply ("Error: Command parameter is required.");
-        return;
-      }
-      std::string command = std::get<std::string> (event.get_parameter ("command"));
+void DiscordBot::onAddSource (const dpp::slashcommand_t& event) {
+  auto url_param = event.get_parameter ("url");
+  if (url_param.index () == 0) { // std::monostate means parameter doesn't exist
+    event.reply ("Error: URL parameter is required.");
+    return;
+  }
+  std::string url = std::get<std::string> (event.get_parameter ("url"));
 
-      // allowed commands
-      if (command != "fortune" && command != "df -h" && command != "free -h"
-          && command != "cat /etc/os-release" && command != "fastfetch --logo none") {
-        event.reply ("Error: Command not allowed.");
-        return;
-      }
-      if (command.empty ()) {
-        event.reply ("Error: Command parameter is required.");
-        return;
-      }
-      try {
-        std::string output = runTerminalCommand (command);
-        if (output.empty ()) {
-          output = "Command executed successfully, but no output was returned.";
-        } else {
-          output = LEFT_TXT_MARKDOWN + output + RIGHT_TXT_MARKDOWN;
-        }
-        LOG_I_STREAM << "Command output: " << output << std::endl;
-        printStringToChannel (output, event.command.channel_id, event, false);
-      } catch (const std::runtime_error& e) {
-        LOG_E_STREAM << "Error executing command: " << e.what () << std::endl;
-        event.reply ("Error executing command: " + std::string (e.what ()));
-      }
+  bool embedded = false;
+  auto embedded_param = event.get_parameter ("embedded");
+  if (embedded_param.index () != 0) { // Check if parameter exists (not std::monostate)
+    embedded = std::get<bool> (embedded_param);
+  }
+  if (url.empty ()) {
+    event.reply ("Error: URL parameter is required.");
+    return;
+  }
+  try {
+    // Add the URL to the RSS manager - use the channel ID from the command
+    int result = rss.addUrl (url, embedded, event.command.channel_id);
+    if (result == -1) {
+      LOG_W_STREAM << "URL already subscribed in this channel: " << url << std::endl;
+      event.reply ("Warning: this channel already subscribes to the URL.");
       return;
     }
-    if (event.command.get_command_name () == "ping") {
-      event.reply ("Pong! 🏓");
-    }
-    if (event.command.get_command_name () == "bot") {
-      dpp::embed embed
-          = dpp::embed ()
-                .set_author ("With 🩵 by D🌀tName (c) 2025", "https://digitalspace.name",
-                             "https://digitalspace.name/avatar/avatarpix.png")
-                .set_color (dpp::colors::sti_blue)
-                .set_title ("BotppFree")
-                .set_url ("https://github.com/tomasmark79/BotppFree")
-                .set_description (botDescription + "\n")
-                .set_thumbnail ("https://digitalspace.name/avatar/Linux-Logo-1996-present.png")
-                .add_field ("commands:", botCommandsHelp, true)
-                .add_field ("build info:",
-                            "version " + std::string (IBOT_VERSION) + "\nDPP version "
-                                + DPP_VERSION_TEXT + "\nC++ version "
-                                + std::to_string (__cplusplus),
-                            false)
-                .add_field ("credits:", CREDITS, false)
-                .set_image ("https://digitalspace.name/avatar/tuxik.png");
-
-      dpp::message msg (event.command.channel_id, embed);
-      event.reply (msg);
+    event.reply ("Source added: " + url + "\nChecking the feed...");
+  } catch (const std::runtime_error& e) {
+    LOG_E_STREAM << "Error adding source: " << e.what () << std::endl;
+    event.reply ("Error adding source: " + std::string (e.what ()));
+    return;
+  }
+
+  // Probe and fetch only the new source on a worker, report in a follow-up
+  std::string token = event.command.token;
+  dpp::snowflake channelId = event.command.channel_id;
+  bool submitted = workers->submit ("probe", [this, url, token, channelId] () {
+    FeedProbe probe = rss.probeFeed (url);
+    std::string report;
+    if (probe.isValid ()) {
+      report = "Feed " + url + " looks good: " + probe.format + ", "
+               + std::to_string (probe.itemCount) + " items, "
+               + std::to_string (probe.queuedItems) + " queued for posting.";
+    } else {
+      rss.removeUrl (url, channelId);
+      report = probe.reachable ? "Source removed, " + url + " is not an RSS or Atom feed."
+                               : "Source removed, " + url + " is not reachable.";
     }
-    if (event.command.get_command_name () == "env") {
-      std::string envInfo = getLinuxFastfetchCpp ();
-      if (envInfo.empty ()) {
-        envInfo = "No environment information available.";
+    LOG_I_STREAM << report << std::endl;
+    bot_->interaction_followup_create (token, dpp::message (channelId, report));
+  });
+  if (!submitted) {
+    bot_->interaction_followup_create (
+        token, dpp::message (channelId, "Busy, " + url + " is checked with the next fetch."));
+  }
+}
+
+void DiscordBot::onRunTerminalCommand (const dpp::slashcommand_t& event) {
+  auto command_param = event.get_parameter ("command");
+  if (command_param.index () == 0) {
+    event.reply ("Error: Command parameter is required.");
+    return;
+  }
+  std::string command = std::get<std::string> (event.get_parameter ("command"));
+  if (command.empty ()) {
+    event.reply ("Error: Command parameter is required.");
+    return;
+  }
+
+  // allowed commands, all but fortune are answered from the system information collector
+  static const std::map<std::string, SysInfo::Report> nativeCommands
+      = { { "df -h", SysInfo::Report::Disks },
+          { "free -h", SysInfo::Report::Memory },
+          { "cat /etc/os-release", SysInfo::Report::OsRelease },
+          { "fastfetch --logo none", SysInfo::Report::Summary } };
+  auto native = nativeCommands.find (command);
+  if (native != nativeCommands.end ()) {
+    dpp::message msg
+        = pagedReply (event, sysInfo.get (native->second), LEFT_TXT_MARKDOWN, RIGHT_TXT_MARKDOWN);
+    event.reply (msg.set_flags (dpp::m_suppress_embeds));
+    return;
+  }
+  if (command != "fortune") {
+    event.reply ("Error: Command not allowed.");
+    return;
+  }
+
+  deferToWorkers ("fortune", event, [this, command] (const dpp::slashcommand_t& deferred) {
+    try {
+      std::string output = runTerminalCommand (command);
+      if (output.empty ()) {
+        output = "Command executed successfully, but no output was returned.";
       } else {
-        envInfo = LEFT_TXT_MARKDOWN + envInfo + RIGHT_TXT_MARKDOWN;
+        output = LEFT_TXT_MARKDOWN + output + RIGHT_TXT_MARKDOWN;
       }
-      LOG_I_STREAM << "Environment information: " << envInfo << std::endl;
-      printStringToChannel (envInfo, event.command.channel_id, event, false);
+      LOG_I_STREAM << "Command output: " << output << std::endl;
+      completeDeferred (deferred, output, false);
+    } catch (const std::runtime_error& e) {
+      LOG_E_STREAM << "Error executing command: " << e.what () << std::endl;
+      completeDeferred (deferred, "Error executing command: " + std::string (e.what ()));
     }
   });
 }
 
+void DiscordBot::onPing (const dpp::slashcommand_t& event) {
+  event.reply ("Pong! 🏓");
+}
+
+void DiscordBot::onBot (const dpp::slashcommand_t& event) {
+  // Only build constants go into the embed
+  event.reply (responses.getOrRender ("bot", IBOT_VERSION, [] () {
+    dpp::embed embed
+        = dpp::embed ()
+              .set_author ("With 🩵 by D🌀tName (c) 2025", "https://digitalspace.name",
+                           "https://digitalspace.name/avatar/avatarpix.png")
+              .set_color (dpp::colors::sti_blue)
+              .set_title ("BotppFree")
+              .set_url ("https://github.com/tomasmark79/BotppFree")
+              .set_description (botDescription + "\n")
+              .set_thumbnail ("https://digitalspace.name/avatar/Linux-Logo-1996-present.png")
+              .add_field ("commands:", botCommandsHelp, true)
+              .add_field ("build info:",
+                          "version " + std::string (IBOT_VERSION) + "\nDPP version "
+                              + DPP_VERSION_TEXT + "\nC++ version "
+                              + std::to_string (__cplusplus),
+                          false)
+              .add_field ("credits:", CREDITS, false)
+              .set_image ("https://digitalspace.name/avatar/tuxik.png");
+    return dpp::message (0, embed);
+  }));
+}
+
+void DiscordBot::onEnv (const dpp::slashcommand_t& event) {
+  std::string envInfo = sysInfo.get (SysInfo::Report::Summary);
+  if (envInfo.empty ()) {
+    event.reply ("No environment information available.");
+    return;
+  }
+  dpp::message msg = pagedReply (event, envInfo, LEFT_TXT_MARKDOWN, RIGHT_TXT_MARKDOWN);
+  event.reply (msg.set_flags (dpp::m_suppress_embeds));
+}
+
+void DiscordBot::onStats (const dpp::slashcommand_t& event) {
+  auto stats = commandRouter_.getStats ();
+  if (stats.empty ()) {
+    event.reply ("No commands handled yet.");
+    return;
+  }
+  std::string response = "command      calls  fail    p50 ms    p95 ms    max ms    run ms\n";
+  auto ms = [] (std::chrono::microseconds us) {
+    char text[16];
+    std::snprintf (text, sizeof (text), "%9.1f", us.count () / 1000.0);
+    return std::string (text);
+  };
+  for (const auto& command : stats) {
+    char head[32];
+    std::snprintf (head, sizeof (head), "%-12s %5llu %5llu", command.name.substr (0, 12).c_str (),
+                   static_cast<unsigned long long> (command.calls),
+                   static_cast<unsigned long long> (command.failures));
+    // Deferred commands answer at once, the last column is the p95 of their run on a worker
+    std::string run = command.execution.getSamples () > 0
+                          ? " " + ms (command.execution.percentile (0.95))
+                          : "         -";
+    std::string line = head + std::string (" ") + ms (command.latency.percentile (0.5)) + " "
+                       + ms (command.latency.percentile (0.95)) + " "
+                       + ms (command.latency.getMax ()) + run + "\n";
+    if (response.size () + line.size () + 20 > DISCORD_MAX_MSG_LEN)
+      break;
+    response += line;
+  }
+  ChannelTypeStats channels = channelTypes.getStats ();
+  response += "\ncrossposts: " + std::to_string (channels.crosspostsSent) + " sent, "
+              + std::to_string (channels.crosspostsSkipped) + " skipped outside announcement "
+              + "channels, " + std::to_string (channels.restLookups) + " channel lookups, "
+              + std::to_string (channels.cachedChannels) + " channel types cached";
+  response += "\nresponse cache: " + std::to_string (responses.getHits ()) + " hits, "
+              + std::to_string (responses.getMisses ()) + " misses\n";
+  event.reply (LEFT_TXT_MARKDOWN + response + RIGHT_TXT_MARKDOWN);
+}
+
 //                     _
 //                    | |
 //  _ __ ___  __ _  __| |_   _
@@ -462,43 +951,97 @@ void DiscordBot::loadOnSlashCommands () {
 //                       |___/
 // onReadyHandlers
 void DiscordBot::loadOnReadyCommands () {
+  if (!ownership->isSingleCluster ()) {
+    // Only guilds of this process's shards arrive here, their channels are the owned ones
+    bot_->on_guild_create ([] (const dpp::guild_create_t& event) {
+      std::vector<uint64_t> channels (event.created.channels.begin (),
+                                      event.created.channels.end ());
+      ownership->addGuild (event.created.id, channels);
+      requestFetch (); // the earlier cycles skipped these channels
+    });
+    bot_->on_guild_delete ([] (const dpp::guild_delete_t& event) {
+      ownership->removeGuild (event.deleted.id);
+    });
+    bot_->on_channel_create ([] (const dpp::channel_create_t& event) {
+      ownership->addChannel (event.created.guild_id, event.created.id);
+      requestFetch ();
+    });
+  }
+
+  // Channel types for crossposting, DPP caches the channels listed by guild_create
+  bot_->on_guild_create ([] (const dpp::guild_create_t& event) {
+    for (dpp::snowflake channelId : event.created.channels) {
+      if (const dpp::channel* channel = dpp::find_channel (channelId)) {
+        channelTypes.set (channelId, channel->get_type () == dpp::CHANNEL_ANNOUNCEMENT);
+      }
+    }
+  });
+  bot_->on_channel_create ([] (const dpp::channel_create_t& event) {
+    channelTypes.set (event.created.id, event.created.get_type () == dpp::CHANNEL_ANNOUNCEMENT);
+  });
+  bot_->on_channel_update ([] (const dpp::channel_update_t& event) {
+    channelTypes.set (event.updated.id, event.updated.get_type () == dpp::CHANNEL_ANNOUNCEMENT);
+  });
+  bot_->on_channel_delete ([] (const dpp::channel_delete_t& event) {
+    channelTypes.remove (event.deleted.id);
+  });
+
   bot_->on_ready ([&] (const dpp::ready_t& event) {
-    bot_->global_command_create (dpp::slashcommand ("sunset", "Get Sunset Now", bot_->me.id));
-    bot_->global_command_create (dpp::slashcommand ("sunrise", "Get Sunrise Now", bot_->me.id));
-    bot_->global_command_create (dpp::slashcommand ("sunriset", "Get Sunrise Time", bot_->me.id));
-    bot_->global_command_create (
-        dpp::slashcommand ("heygoogle", "Ask Google Gemini AI", bot_->me.id)
-            .add_option (dpp::command_option (dpp::co_string, "prompt",
-                                              "The prompt to send to Google Gemini", true)));
-    bot_->global_command_create (
-        dpp::slashcommand ("refetch", "Refetch all RSS feeds", bot_->me.id));
-    bot_->global_command_create (
-        dpp::slashcommand ("queue", "Get queue of RSS items", bot_->me.id));
-    bot_->global_command_create (dpp::slashcommand ("getfeednow", "Get RSS feed now", bot_->me.id));
-    bot_->global_command_create (
-        dpp::slashcommand ("listsources", "List all RSS sources", bot_->me.id));
-
-    bot_->global_command_create (
-        dpp::slashcommand ("addsource",
-                           "Add a new RSS source + <channel_id> where command was invoked",
-                           bot_->me.id)
-            .add_option (dpp::command_option (dpp::co_string, "url", "URL of the RSS feed", true))
-            .add_option (dpp::command_option (dpp::co_boolean, "embedded",
-                                              "Whether the feed should be embedded in the message",
-                                              false)));
-    bot_->global_command_create (
-        dpp::slashcommand ("runterminalcommand", "Run a terminal command and return the output",
-                           bot_->me.id)
-            .add_option (dpp::command_option (dpp::co_string, "command",
-                                              "The terminal command to run", true)));
-
-    bot_->global_command_create (dpp::slashcommand ("ping", "Ping pong!", bot_->me.id));
-    bot_->global_command_create (dpp::slashcommand ("bot", "About Bot++", bot_->me.id));
-    bot_->global_command_create (
-        dpp::slashcommand ("env", "Display environment information", bot_->me.id));
-    std::this_thread::sleep_for (std::chrono::seconds (5)); // delay to user readable debug output
-    startPollingFetchFeed ();
-    startPollingPrintFeed ();
+    // Fires once per shard and again after every reconnect
+    if (!services.startAll ())
+      return;
+    // Global commands are shared by all clusters, the first one registers them
+    if (ownership->getConfig ().clusterId == 0) {
+      syncCommands ();
+    }
+  });
+}
+
+void DiscordBot::syncCommands () {
+  std::vector<dpp::slashcommand> definitions;
+  nlohmann::json local = nlohmann::json::array ();
+  for (const auto& command : commandTable_) {
+    dpp::slashcommand definition = command.definition;
+    definition.set_application_id (bot_->me.id);
+    local.push_back (nlohmann::json::parse (definition.build_json ()));
+    definitions.push_back (std::move (definition));
+  }
+
+  std::filesystem::path signaturePath = AssetContext::getAssetsPath () / "commandSignature.txt";
+  std::string localSignature = CommandSync::signature (local);
+  if (CommandSync::loadSignature (signaturePath) == localSignature) {
+    LOG_I_STREAM << "Slash commands unchanged, registration skipped" << std::endl;
+    return;
+  }
+
+  // The table changed since the last registration or was never registered from here
+  bot_->global_commands_get ([this, definitions, local, localSignature, signaturePath] (
+                                 const dpp::confirmation_callback_t& callback) {
+    if (callback.is_error ()) {
+      LOG_W_STREAM << "Failed to read registered slash commands: "
+                   << callback.get_error ().message << std::endl;
+    } else {
+      nlohmann::json remote = nlohmann::json::array ();
+      for (const auto& [id, command] : callback.get<dpp::slashcommand_map> ())
+        remote.push_back (nlohmann::json::parse (command.build_json ()));
+      if (CommandSync::matches (local, remote)) {
+        LOG_I_STREAM << "Slash commands already registered" << std::endl;
+        CommandSync::saveSignature (signaturePath, localSignature);
+        return;
+      }
+    }
+
+    bot_->global_bulk_command_create (
+        definitions, [count = definitions.size (), localSignature,
+                      signaturePath] (const dpp::confirmation_callback_t& callback) {
+          if (callback.is_error ()) {
+            LOG_E_STREAM << "Failed to register slash commands: " << callback.get_error ().message
+                         << std::endl;
+            return;
+          }
+          LOG_I_STREAM << "Registered " << count << " slash commands" << std::endl;
+          CommandSync::saveSignature (signaturePath, localSignature);
+        });
   });
 }
 
@@ -515,8 +1058,25 @@ int DiscordBot::isValidMessageRequest (const std::string& message, dpp::snowflak
   return 0;
 }
 
+void DiscordBot::completeDeferred (const dpp::slashcommand_t& event, const std::string& text,
+                                   bool allowEmbedded) {
+  // output over Discord's maximum length gets page buttons
+  dpp::message msg = pagedReply (event, text);
+  if (!allowEmbedded) {
+    msg.set_flags (dpp::m_suppress_embeds);
+  }
+  event.edit_original_response (msg, [] (const dpp::confirmation_callback_t& callback) {
+    if (callback.is_error ()) {
+      LOG_E_STREAM << "Failed to complete deferred reply: " << callback.get_error ().message
+                   << std::endl;
+    }
+  });
+}
+
 int DiscordBot::printStringToChannel (const std::string& message, dpp::snowflake channelId,
-                                      const dpp::slashcommand_t& event, bool allowEmbedded) {
+                                      const dpp::slashcommand_t& event, bool allowEmbedded,
+                                      std::function<void (dpp::snowflake)> onCreated,
+                                      std::function<void (uint16_t httpStatus)> onFailed) {
   int validationResult = isValidMessageRequest (message, channelId);
   if (validationResult != 0) {
     return validationResult;
@@ -533,49 +1093,270 @@ int DiscordBot::printStringToChannel (const std::string& message, dpp::snowflake
     msg.set_flags (dpp::m_suppress_embeds); // Suppress embeds if allowEmbedded is false
   }
   if (event.command.id != 0) {
-    event.reply (msg);
-    LOG_I_STREAM << "Message replied to slash command in channel " << event.command.channel_id
-                 << ": " << truncatedMessage << std::endl;
-  } else {
-    bot_->message_create (msg, [this, truncatedMessage,
-                                channelId] (const dpp::confirmation_callback_t& callback) {
+    dpp::snowflake replyChannelId = event.command.channel_id;
+    auto replied = [replyChannelId, onCreated = std::move (onCreated),
+                    onFailed = std::move (onFailed)] (
+                       const dpp::confirmation_callback_t& callback) {
       if (callback.is_error ()) {
-        LOG_E_STREAM << "Failed to create message: " << callback.get_error ().message << std::endl;
+        LOG_E_STREAM << "Failed to reply to slash command in channel " << replyChannelId << ": "
+                     << callback.get_error ().message << std::endl;
+        if (onFailed) {
+          onFailed (callback.http_info.status);
+        }
         return;
       }
-
-      const auto& createdMessage = callback.get<dpp::message> ();
-      LOG_I_STREAM << "Message created successfully with ID: " << createdMessage.id << std::endl;
-      LOG_I_STREAM << "Message sent to channel " << channelId << ": " << truncatedMessage
+      LOG_I_STREAM << "Message replied to slash command in channel " << replyChannelId
                    << std::endl;
+      if (onCreated) {
+        onCreated (0);
+      }
+    };
+    event.reply (msg, replied);
+  } else {
+    OutboundMessage outbound;
+    outbound.channelId = channelId;
+    outbound.content = truncatedMessage;
+    outbound.embedded = allowEmbedded;
+    outbound.onCreated = std::move (onCreated);
+    outbound.onFailed = std::move (onFailed);
+    sendPipeline->enqueue (std::move (outbound));
+  }
+  return 0;
+}
 
-      // Crosspost the message if it's in a news channel
-      bot_->message_crosspost (createdMessage.id, createdMessage.channel_id,
-                               [this] (const dpp::confirmation_callback_t& callback) {
-                                 if (callback.is_error ()) {
-                                   LOG_E_STREAM << "Failed to crosspost message: "
-                                                << callback.get_error ().message << std::endl;
-                                 } else {
-                                   LOG_I_STREAM << "Message crossposted successfully" << std::endl;
-                                 }
-                               });
-    });
+int DiscordBot::postItem (const RSSItem& item, dpp::snowflake channelId, bool allowEmbedded,
+                          bool viaWebhook) {
+  std::string link = item.toMarkdownLink ();
+  int validationResult = isValidMessageRequest (link, channelId);
+  if (validationResult != 0) {
+    return validationResult;
   }
+  OutboundMessage outbound;
+  outbound.channelId = channelId;
+  outbound.content = link.size () > DISCORD_MAX_MSG_LEN
+                         ? link.substr (0, DISCORD_MAX_MSG_LEN - 3) + "..."
+                         : link;
+  outbound.embedded = allowEmbedded;
+  outbound.digestible = true; // queued items of a backlog share one message
+  if (viaWebhook && webhookUsable (channelId)) {
+    outbound.webhook = true;
+    outbound.username = WebhookCache::sourceName (item.sourceUrl);
+    outbound.avatarUrl = avatarFor (outbound.username);
+  }
+  outbound.onCreated = [item, channelId] (uint64_t messageId) {
+    rss.confirmDelivery (item, channelId, messageId);
+  };
+  outbound.onFailed = [item] (uint16_t httpStatus) { rss.failDelivery (item, httpStatus); };
+  sendPipeline->enqueue (std::move (outbound));
   return 0;
 }
 
-std::string DiscordBot::checkThreadName (const std::string& threadName) {
-  if (threadName.empty ()) {
-    LOG_W_STREAM << "Thread name is empty, generating a default name." << std::endl;
-    return "";
+void DiscordBot::sendOutbound (const OutboundMessage& outbound, SendPipeline::Done done) {
+  if (outbound.webhook) {
+    sendViaWebhook (outbound, std::move (done));
+    return;
+  }
+  std::optional<bool> announcement = channelTypes.isAnnouncement (outbound.channelId);
+  if (announcement) {
+    deliverOutbound (outbound, std::move (done), *announcement);
+    return;
+  }
+
+  // Not reported by the gateway, e.g. a channel of a guild the bot left - ask once
+  channelTypes.countRestLookup ();
+  bot_->channel_get (outbound.channelId,
+                     [this, outbound, done] (const dpp::confirmation_callback_t& callback) {
+                       bool isAnnouncement = false;
+                       if (callback.is_error ()) {
+                         LOG_W_STREAM << "Failed to look up channel " << outbound.channelId << ": "
+                                      << callback.get_error ().message << std::endl;
+                       } else {
+                         const auto& channel = callback.get<dpp::channel> ();
+                         isAnnouncement = channel.get_type () == dpp::CHANNEL_ANNOUNCEMENT;
+                         channelTypes.set (channel.id, isAnnouncement);
+                       }
+                       deliverOutbound (outbound, done, isAnnouncement);
+                     });
+}
+
+void DiscordBot::deliverOutbound (const OutboundMessage& outbound, SendPipeline::Done done,
+                                  bool announcement) {
+  dpp::message msg (outbound.channelId, outbound.content);
+  if (!outbound.embedded) {
+    msg.set_flags (dpp::m_suppress_embeds); // Suppress embeds if allowEmbedded is false
+  }
+
+  // Crosspost the message if it's in an announcement channel. A spent bucket does not hold the
+  // lane, the crosspost follows on the scheduler once the bucket resets.
+  std::string route
+      = "POST /channels/" + std::to_string (outbound.channelId) + "/messages/crosspost";
+  DeliveryOptions options;
+  auto now = SendPipeline::Clock::now ();
+  bool crosspost = channelTypes.shouldCrosspost (announcement);
+  options.crosspost = crosspost && sendPipeline->getBuckets ().readyAt (route, now) <= now;
+  if (options.crosspost) {
+    sendPipeline->getBuckets ().consume (route);
+  }
+  bool crosspostLater = crosspost && !options.crosspost;
+
+  auto finished = [this, route, crosspostLater, done] (const DeliveryResult& delivered) {
+    SendResult result;
+    result.limit = rateLimitOf (delivered.createResponse);
+    if (!delivered.ok ()) {
+      result.httpStatus = delivered.error->httpStatus;
+      LOG_E_STREAM << "Failed to create message: " << delivered.error->message << std::endl;
+      done (result);
+      return;
+    }
+    LOG_I_STREAM << "Message sent to channel " << delivered.channelId
+                 << " with ID: " << delivered.messageId << std::endl;
+    result.ok = true;
+    result.messageId = delivered.messageId;
+
+    if (delivered.crosspostResponse.status != 0) {
+      sendPipeline->getBuckets ().update (route, rateLimitOf (delivered.crosspostResponse),
+                                          SendPipeline::Clock::now ());
+    }
+    if (delivered.crossposted) {
+      channelTypes.countCrosspost ();
+      LOG_I_STREAM << "Message crossposted successfully" << std::endl;
+    } else if (crosspostLater) {
+      LOG_W_STREAM << "Crosspost rate limit reached, message " << delivered.messageId
+                   << " is crossposted when the bucket resets" << std::endl;
+      crosspostWhenReady (delivered.messageId, delivered.channelId, route);
+    }
+    for (const auto& warning : delivered.warnings) {
+      LOG_E_STREAM << "Failed to " << warning.stage << " message: " << warning.message
+                   << std::endl;
+    }
+    done (result);
+  };
+  delivery->start (msg, options, finished);
+}
+
+void DiscordBot::crosspostWhenReady (dpp::snowflake messageId, dpp::snowflake channelId,
+                                     const std::string& route) {
+  auto now = SendPipeline::Clock::now ();
+  auto readyAt = sendPipeline->getBuckets ().readyAt (route, now);
+  if (readyAt > now) {
+    // Checked again when due, other crossposts of the channel may have taken the reset
+    auto retry = [this, messageId, channelId, route] () {
+      crosspostWhenReady (messageId, channelId, route);
+    };
+    scheduler.scheduleOnce (readyAt - now, retry, "crosspost");
+    return;
+  }
+  sendPipeline->getBuckets ().consume (route);
+  bot_->message_crosspost (
+      messageId, channelId,
+      [this, messageId, channelId, route] (const dpp::confirmation_callback_t& callback) {
+        sendPipeline->getBuckets ().update (route, rateLimitOf (callback.http_info),
+                                            SendPipeline::Clock::now ());
+        if (callback.http_info.status == 429) {
+          crosspostWhenReady (messageId, channelId, route);
+          return;
+        }
+        if (callback.is_error ()) {
+          LOG_E_STREAM << "Failed to crosspost message " << messageId << ": "
+                       << callback.get_error ().message << std::endl;
+          return;
+        }
+        channelTypes.countCrosspost ();
+        LOG_I_STREAM << "Message " << messageId << " crossposted after the rate limit reset"
+                     << std::endl;
+      });
+}
+
+void DiscordBot::sendViaWebhook (const OutboundMessage& outbound, SendPipeline::Done done) {
+  if (auto credentials = webhooks.get (outbound.channelId)) {
+    executeWebhook (outbound, *credentials, std::move (done));
+    return;
   }
-  if (threadName.size () > 100) {
-    LOG_E_STREAM << "Thread name exceeds maximum length of 100 characters. "
-                    "Truncating to fit the limit."
-                 << std::endl;
-    return threadName.substr (0, 100);
+  if (!webhookUsable (outbound.channelId)) {
+    // Queued before the webhook setup failed
+    OutboundMessage direct = outbound;
+    direct.webhook = false;
+    sendOutbound (direct, std::move (done));
+    return;
   }
-  return threadName;
+
+  // Reuse the webhook of an earlier run, a channel holds only a few webhooks
+  std::string name = BotConfig::value<std::string> ("webhooks/name", "Bot++ feeds");
+  bot_->get_channel_webhooks (outbound.channelId, [this, outbound, done, name] (
+                                                      const dpp::confirmation_callback_t& listed) {
+    if (!listed.is_error ()) {
+      std::vector<WebhookCandidate> candidates;
+      for (const auto& [id, webhook] : listed.get<dpp::webhook_map> ())
+        candidates.push_back ({ webhook.id, webhook.name, webhook.token });
+      if (auto credentials = WebhookCache::pick (candidates, name)) {
+        webhooks.set (outbound.channelId, *credentials);
+        executeWebhook (outbound, *credentials, done);
+        return;
+      }
+    }
+
+    dpp::webhook webhook;
+    webhook.channel_id = outbound.channelId;
+    webhook.name = name;
+    bot_->create_webhook (webhook, [this, outbound,
+                                    done] (const dpp::confirmation_callback_t& created) {
+      if (created.is_error ()) {
+        // Usually the Manage Webhooks permission is missing - the item is not lost, and the
+        // channel posts as the bot without asking again until the failure expires
+        if (webhooks.markFailed (outbound.channelId)) {
+          LOG_W_STREAM << "Failed to create a webhook in channel " << outbound.channelId << ": "
+                       << created.get_error ().message << ", posting as the bot" << std::endl;
+        }
+        OutboundMessage direct = outbound;
+        direct.webhook = false;
+        sendOutbound (direct, done);
+        return;
+      }
+      const auto& webhook = created.get<dpp::webhook> ();
+      WebhookCredentials credentials{ webhook.id, webhook.token };
+      webhooks.set (outbound.channelId, credentials);
+      LOG_I_STREAM << "Created webhook " << webhook.id << " in channel " << outbound.channelId
+                   << std::endl;
+      executeWebhook (outbound, credentials, done);
+    });
+  });
+}
+
+void DiscordBot::executeWebhook (const OutboundMessage& outbound,
+                                 const WebhookCredentials& credentials, SendPipeline::Done done) {
+  dpp::webhook webhook;
+  webhook.id = credentials.id;
+  webhook.token = credentials.token;
+  webhook.name = outbound.username; // empty keeps the webhook's own name and avatar
+  webhook.avatar_url = outbound.avatarUrl;
+  dpp::message msg (outbound.content);
+  if (!outbound.embedded) {
+    msg.set_flags (dpp::m_suppress_embeds); // Suppress embeds if allowEmbedded is false
+  }
+
+  // wait = true, Discord returns the created message and with it the id for the outbox
+  bot_->execute_webhook (
+      webhook, msg, true, 0, "",
+      [channelId = outbound.channelId, done] (const dpp::confirmation_callback_t& callback) {
+        SendResult result;
+        result.limit = rateLimitOf (callback.http_info);
+        if (callback.is_error ()) {
+          result.httpStatus = callback.http_info.status;
+          if (callback.http_info.status == 404) {
+            webhooks.remove (channelId); // deleted in Discord, recreated with the retry
+            result.httpStatus = 0;       // so the item is not dropped with the stale webhook
+          }
+          LOG_E_STREAM << "Failed to execute webhook in channel " << channelId << ": "
+                       << callback.get_error ().message << std::endl;
+          done (result);
+          return;
+        }
+        result.ok = true;
+        result.messageId = callback.get<dpp::message> ().id;
+        LOG_I_STREAM << "Message sent to channel " << channelId << " through its webhook with ID: "
+                     << result.messageId << std::endl;
+        done (result);
+      });
 }
 
 int DiscordBot::printStringToChannelAsThread (const std::string& message, dpp::snowflake channelId,
@@ -597,28 +1378,25 @@ int DiscordBot::printStringToChannelAsThread (const std::string& message, dpp::s
   if (!allowEmbedded) {
     msg.set_flags (dpp::m_suppress_embeds);
   }
-  bot_->message_create (msg, [this, finalThreadName, channelId,
-                              truncatedMessage] (const dpp::confirmation_callback_t& callback) {
-    if (callback.is_error ()) {
-      LOG_E_STREAM << "Failed to create message: " << callback.get_error ().message << std::endl;
+  DeliveryOptions options;
+  options.threadName = finalThreadName;
+  options.threadArchiveMinutes = 60; // auto_archive_duration in minutes
+  delivery->start (msg, options, [channelId, truncatedMessage] (const DeliveryResult& delivered) {
+    if (!delivered.ok ()) {
+      result.httpStatus = delivered.error->httpStatus;
+      LOG_E_STREAM << "Failed to create message: " << delivered.error->message << std::endl;
       return;
     }
-    const auto& createdMessage = callback.get<dpp::message> ();
-    LOG_I_STREAM << "Message created successfully with ID: " << createdMessage.id << std::endl;
-    bot_->thread_create_with_message (
-        finalThreadName, channelId, createdMessage.id, 60, // auto_archive_duration in minutes
-        0, // rate_limit_per_user (0 = no rate limit)
-        [this, channelId, truncatedMessage] (const dpp::confirmation_callback_t& thread_callback) {
-          if (thread_callback.is_error ()) {
-            LOG_E_STREAM << "Failed to create thread: " << thread_callback.get_error ().message
-                         << std::endl;
-            return;
-          }
-          const auto& createdThread = thread_callback.get<dpp::thread> ();
-          LOG_I_STREAM << "Thread created successfully with ID: " << createdThread.id << std::endl;
-          LOG_I_STREAM << "Message sent to channel " << channelId
-                       << " as thread: " << truncatedMessage << std::endl;
-        });
+    LOG_I_STREAM << "Message created successfully with ID: " << delivered.messageId << std::endl;
+    if (delivered.threadId == 0) {
+      for (const auto& warning : delivered.warnings) {
+        LOG_E_STREAM << "Failed to create thread: " << warning.message << std::endl;
+      }
+      return;
+    }
+    LOG_I_STREAM << "Thread created successfully with ID: " << delivered.threadId << std::endl;
+    LOG_I_STREAM << "Message sent to channel " << channelId
+                 << " as thread: " << truncatedMessage << std::endl;
   });
 #else // TESTING_DISCORD_BOT
   LOG_D_STREAM << "Fake thread message sent: " << message.substr (1, 40) << "..." << std::endl;
@@ -656,22 +1434,6 @@ int DiscordBot::getTokenFromFile (std::string& token) {
   return 0;
 }
 
-std::string DiscordBot::getLinuxFastfetchCpp () {
-  constexpr size_t bufferSize = DISCORD_MAX_MSG_LEN;
-  std::stringstream result;
-  std::unique_ptr<FILE, decltype (&pclose)> pipe (
-      popen ("fastfetch -c archey.jsonc --pipe --logo none", "r"), pclose);
-  if (!pipe)
-    throw std::runtime_error ("Failed to run fastfetch command");
-  std::array<char, bufferSize> buffer;
-  while (fgets (buffer.data (), buffer.size (), pipe.get ()) != nullptr) {
-    result << buffer.data ();
-    if (result.str ().size () > bufferSize - 2)
-      break;
-  }
-  return result.str ();
-}
-
 /// @brief  Run a terminal command and return the output.
 /// @param command
 /// @return
@@ -5,6 +5,13 @@
 #include <filesystem>
 #include <dpp/dpp.h>
 #include <memory>
+#include <functional>
+#include <vector>
+#include "CommandRouter.hpp"
+#include "SendPipeline.hpp"
+#include "WebhookCache.hpp"
+
+struct RSSItem;
 
 // curl https temporary fix
 // RedHats childs needs for failed ssl contexts in
@@ -21,8 +28,9 @@ public:
   ~DiscordBot () = default;
 
   /**
-   * @brief Initialize the Discord bot cluster.
-   * @return 0 on success, -1 on failure.
+   * @brief Initialize the Discord bot cluster and run it until SIGTERM or SIGINT.
+   * @return 0 after a clean shutdown, -1 on failure. A shutdown that misses its deadline ends
+   * the process with _Exit.
    */
   int initCluster ();
 
@@ -43,7 +51,6 @@ public:
   }
 
 private:
-  std::string getLinuxFastfetchCpp ();
   std::string runTerminalCommand (const std::string& command);
   std::unique_ptr<dpp::cluster> bot_;
   int getGoogleGeminiTokenFromFile (std::string& token);
@@ -57,14 +64,70 @@ private:
   int printStringToChannelAsThread (const std::string& message, dpp::snowflake channelId,
                                     const std::string& threadName = "", bool allowEmbedded = true);
   std::string checkThreadName (const std::string& threadName);
+  // onCreated receives the id of the posted message, 0 for slash command replies. Both run
+  // once Discord answered, onFailed with the response status.
   int printStringToChannel (const std::string& str, dpp::snowflake channelId,
-                            const dpp::slashcommand_t& event, bool allowEmbedded);
+                            const dpp::slashcommand_t& event, bool allowEmbedded,
+                            std::function<void (dpp::snowflake)> onCreated = nullptr,
+                            std::function<void (uint16_t httpStatus)> onFailed = nullptr);
+
+  // Queue a feed item in the send pipeline, a backlog is merged into digest messages
+  int postItem (const RSSItem& item, dpp::snowflake channelId, bool allowEmbedded,
+                bool viaWebhook = false);
+  // Transport of the send pipeline
+  void sendOutbound (const OutboundMessage& outbound, SendPipeline::Done done);
+  // Crossposted only into announcement channels
+  void deliverOutbound (const OutboundMessage& outbound, SendPipeline::Done done,
+                        bool announcement);
+  // Crosspost a posted message once its route bucket has room, on the scheduler
+  void crosspostWhenReady (dpp::snowflake messageId, dpp::snowflake channelId,
+                           const std::string& route);
+  // Webhook delivery mode, the channel's webhook is looked up or created on first use
+  void sendViaWebhook (const OutboundMessage& outbound, SendPipeline::Done done);
+  void executeWebhook (const OutboundMessage& outbound, const WebhookCredentials& credentials,
+                       SendPipeline::Done done);
 
   void addSource (const std::string& url, bool embedded);
 
+  // One row per slash command, drives registration and dispatch
+  struct SlashCommand {
+    dpp::slashcommand definition;
+    std::function<void (const dpp::slashcommand_t&)> handler;
+    size_t concurrency = 0; // > 0: deferred to the worker pool, at most this many at once
+  };
+  std::vector<SlashCommand> buildCommandTable ();
+  std::vector<SlashCommand> commandTable_;
+  CommandRouter<dpp::slashcommand_t> commandRouter_;
+
+  // Slash command handlers
+  void onSunCommand (const dpp::slashcommand_t& event);
+  static std::string renderSunTimes (); // reads and rewrites the sunriset config per city
+  void onHeyGoogle (const dpp::slashcommand_t& event);
+  void onRefetch (const dpp::slashcommand_t& event);
+  void onQueue (const dpp::slashcommand_t& event);
+  void onListSources (const dpp::slashcommand_t& event);
+  void onRecent (const dpp::slashcommand_t& event);
+  void onSearch (const dpp::slashcommand_t& event);
+  void onGetFeedNow (const dpp::slashcommand_t& event);
+  void onAddSource (const dpp::slashcommand_t& event);
+  void onRunTerminalCommand (const dpp::slashcommand_t& event);
+  void onPing (const dpp::slashcommand_t& event);
+  void onBot (const dpp::slashcommand_t& event);
+  void onEnv (const dpp::slashcommand_t& event);
+  void onStats (const dpp::slashcommand_t& event);
+
+  // Reply "thinking" now and run the handler on the worker pool
+  void deferToWorkers (const std::string& name, const dpp::slashcommand_t& event,
+                       std::function<void (const dpp::slashcommand_t&)> run);
+  // Final reply of a deferred handler
+  void completeDeferred (const dpp::slashcommand_t& event, const std::string& text,
+                         bool allowEmbedded = true);
+
   void loadOnSlashCommands ();
   int getQueueSize ();
   void loadOnReadyCommands ();
+  // One bulk overwrite of the global commands, only when the table changed
+  void syncCommands ();
 };
 
 #endif
\ No newline at end of file
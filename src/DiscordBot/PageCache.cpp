@@ -0,0 +1,132 @@
+#include "PageCache.hpp"
+#include <algorithm>
+
+namespace {
+  bool isContinuationByte (char c) {
+    return (static_cast<unsigned char> (c) & 0xC0) == 0x80;
+  }
+}
+
+std::vector<std::string_view> Paginator::splitPages (std::string_view text, size_t maxBytes) {
+  std::vector<std::string_view> pages;
+  if (maxBytes == 0)
+    return pages;
+  while (!text.empty ()) {
+    if (text.size () <= maxBytes) {
+      pages.push_back (text);
+      break;
+    }
+    size_t lineBreak = text.substr (0, maxBytes + 1).rfind ('\n');
+    if (lineBreak == 0) { // blank line at the top of a page
+      text.remove_prefix (1);
+      continue;
+    }
+    if (lineBreak != std::string_view::npos) {
+      pages.push_back (text.substr (0, lineBreak));
+      text.remove_prefix (lineBreak + 1);
+      continue;
+    }
+    // a single line longer than a page, never cut inside a UTF-8 sequence
+    size_t cut = maxBytes;
+    while (cut > 0 && isContinuationByte (text[cut]))
+      --cut;
+    if (cut == 0)
+      cut = maxBytes; // not UTF-8, any cut will do
+    pages.push_back (text.substr (0, cut));
+    text.remove_prefix (cut);
+  }
+  return pages;
+}
+
+PageCache::PageCache (size_t maxEntries, std::chrono::seconds ttl)
+    : maxEntries_ (maxEntries == 0 ? 1 : maxEntries), ttl_ (ttl) {
+}
+
+void PageCache::put (const std::string& key, std::string text, std::string prefix,
+                     std::string suffix, size_t maxLength, Clock::time_point now) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  prune (now);
+  Entry& entry = entries_[key];
+  entry = Entry{};
+  entry.text = std::make_shared<const std::string> (std::move (text));
+  entry.prefix = std::move (prefix);
+  entry.suffix = std::move (suffix);
+  entry.maxLength = maxLength;
+  entry.created = now;
+  entry.lastUsed = now;
+
+  while (entries_.size () > maxEntries_) {
+    auto oldest = entries_.end ();
+    for (auto it = entries_.begin (); it != entries_.end (); ++it) {
+      if (it->first == key)
+        continue;
+      if (oldest == entries_.end () || it->second.lastUsed < oldest->second.lastUsed)
+        oldest = it;
+    }
+    entries_.erase (oldest);
+  }
+}
+
+std::optional<Page> PageCache::get (const std::string& key, size_t index, Clock::time_point now) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  prune (now);
+  auto it = entries_.find (key);
+  if (it == entries_.end ())
+    return std::nullopt;
+
+  Entry& entry = it->second;
+  entry.lastUsed = now;
+  if (!entry.split) {
+    size_t frame = entry.prefix.size () + entry.suffix.size ();
+    size_t room = entry.maxLength > frame ? entry.maxLength - frame : 1;
+    entry.slices = Paginator::splitPages (*entry.text, room);
+    if (entry.slices.empty ())
+      entry.slices.push_back (std::string_view ());
+    entry.split = true;
+  }
+
+  Page page;
+  page.count = entry.slices.size ();
+  page.index = std::min (index, page.count - 1);
+  std::string_view slice = entry.slices[page.index];
+  page.content.reserve (entry.prefix.size () + slice.size () + entry.suffix.size ());
+  page.content.append (entry.prefix).append (slice).append (entry.suffix);
+  return page;
+}
+
+size_t PageCache::size () const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  return entries_.size ();
+}
+
+void PageCache::prune (Clock::time_point now) {
+  for (auto it = entries_.begin (); it != entries_.end ();) {
+    if (now - it->second.created >= ttl_)
+      it = entries_.erase (it);
+    else
+      ++it;
+  }
+}
+
+std::string PageCache::buttonId (const std::string& key, size_t index) {
+  return "page:" + key + ":" + std::to_string (index);
+}
+
+bool PageCache::parseButtonId (const std::string& id, std::string& key, size_t& index) {
+  const std::string tag = "page:";
+  if (id.compare (0, tag.size (), tag) != 0)
+    return false;
+  size_t colon = id.rfind (':');
+  if (colon <= tag.size () || colon + 1 >= id.size ())
+    return false;
+  try {
+    size_t parsed = 0;
+    index = std::stoul (id.substr (colon + 1), &parsed);
+    if (parsed != id.size () - colon - 1)
+      return false;
+  } catch (const std::exception&) {
+    return false;
+  }
+  key = id.substr (tag.size (), colon - tag.size ());
+  return true;
+}
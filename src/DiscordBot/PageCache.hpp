@@ -0,0 +1,67 @@
+#ifndef __PAGECACHE_H__
+#define __PAGECACHE_H__
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Long command output split into Discord sized pages.
+// splitPages cuts at the last line break that fits, or at a UTF-8 character boundary when a
+// single line is too long, and returns views into the text. PageCache keeps the text of recent
+// interactions so the page buttons can re-render any page without running the command again.
+
+namespace Paginator {
+  std::vector<std::string_view> splitPages (std::string_view text, size_t maxBytes);
+}
+
+struct Page {
+  std::string content; // prefix + slice + suffix
+  size_t index = 0;
+  size_t count = 0;
+};
+
+class PageCache {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  PageCache (size_t maxEntries = 64, std::chrono::seconds ttl = std::chrono::minutes (15));
+
+  // prefix and suffix wrap every page, e.g. a code fence; maxLength covers the whole page
+  void put (const std::string& key, std::string text, std::string prefix = "",
+            std::string suffix = "", size_t maxLength = 2000, Clock::time_point now = Clock::now ());
+  // Splits the text on first use, nullopt for an unknown or expired key
+  std::optional<Page> get (const std::string& key, size_t index,
+                           Clock::time_point now = Clock::now ());
+  size_t size () const;
+
+  // Button id "page:<key>:<index>"
+  static std::string buttonId (const std::string& key, size_t index);
+  static bool parseButtonId (const std::string& id, std::string& key, size_t& index);
+
+private:
+  struct Entry {
+    std::shared_ptr<const std::string> text; // the slices point into it
+    std::string prefix;
+    std::string suffix;
+    size_t maxLength = 0;
+    std::vector<std::string_view> slices;
+    bool split = false;
+    Clock::time_point created;
+    Clock::time_point lastUsed;
+  };
+
+  void prune (Clock::time_point now);
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, Entry> entries_;
+  const size_t maxEntries_;
+  const std::chrono::seconds ttl_;
+};
+
+#endif // __PAGECACHE_H__
@@ -0,0 +1,84 @@
+#include "PostingRate.hpp"
+#include <BotConfig/BotConfig.hpp>
+#include <algorithm>
+
+PostingRateConfig PostingRate::configFromJson (const nlohmann::json& section,
+                                               PostingRateConfig config) {
+  auto seconds = [&section] (const std::string& key, std::chrono::seconds fallback) {
+    return std::chrono::seconds (
+        DotNameUtils::JsonUtils::getNestedValue<long long> (section, key, fallback.count ()));
+  };
+  config.minInterval = seconds ("minIntervalSeconds", config.minInterval);
+  config.maxInterval = seconds ("maxIntervalSeconds", config.maxInterval);
+  config.drainTarget = seconds ("drainTargetSeconds", config.drainTarget);
+  config.maxItemAge = seconds ("maxItemAgeSeconds", config.maxItemAge);
+  config.quietInterval = seconds ("quietIntervalSeconds", config.quietInterval);
+  auto hour = [&section] (const std::string& key, int fallback) {
+    return DotNameUtils::JsonUtils::getNestedValue<int> (section, key, fallback);
+  };
+  config.maxBatch = DotNameUtils::JsonUtils::getNestedValue<size_t> (section, "maxBatchItems",
+                                                                     config.maxBatch);
+  if (config.maxBatch == 0)
+    config.maxBatch = 1;
+  config.quietStartHour = hour ("quietStartHour", config.quietStartHour);
+  config.quietEndHour = hour ("quietEndHour", config.quietEndHour);
+  if (config.maxInterval < config.minInterval)
+    config.maxInterval = config.minInterval;
+  return config;
+}
+
+PostingRateConfig PostingRate::configFromBotConfig () {
+  return configFromJson (BotConfig::get ().value ("posting", nlohmann::json::object ()));
+}
+
+PostingRateConfig PostingRate::configForChannel (uint64_t channelId) {
+  PostingRateConfig config = configFromBotConfig ();
+  // Keys are channel ids, a path lookup would read them as array indices
+  nlohmann::json lanes = BotConfig::get ().value ("lanes", nlohmann::json::object ());
+  auto lane = lanes.find (std::to_string (channelId));
+  if (lane != lanes.end () && lane->is_object ())
+    config = configFromJson (*lane, config);
+  return config;
+}
+
+bool PostingRate::isQuietHours (const std::tm& localTime) const {
+  if (config_.quietStartHour == config_.quietEndHour)
+    return false;
+  if (config_.quietStartHour > config_.quietEndHour) // wraps over midnight
+    return localTime.tm_hour >= config_.quietStartHour || localTime.tm_hour < config_.quietEndHour;
+  return localTime.tm_hour >= config_.quietStartHour && localTime.tm_hour < config_.quietEndHour;
+}
+
+std::chrono::seconds PostingRate::nextInterval (size_t queueDepth,
+                                                std::chrono::seconds oldestItemAge,
+                                                const std::tm& localTime) const {
+  if (isQuietHours (localTime))
+    return config_.quietInterval;
+  if (queueDepth == 0)
+    return std::chrono::seconds (0);
+
+  // spread the backlog evenly over the drain target
+  double interval = static_cast<double> (config_.drainTarget.count ()) / queueDepth;
+
+  // age pressure: from half of maxItemAge the interval shrinks linearly towards minInterval
+  double maxAge = static_cast<double> (config_.maxItemAge.count ());
+  double age = static_cast<double> (oldestItemAge.count ());
+  if (maxAge > 0 && age > maxAge / 2) {
+    double pressure = std::min (1.0, (age - maxAge / 2) / (maxAge / 2));
+    interval -= (interval - config_.minInterval.count ()) * pressure;
+  }
+
+  auto result = std::chrono::seconds (static_cast<long long> (interval));
+  return std::clamp (result, config_.minInterval, config_.maxInterval);
+}
+
+size_t PostingRate::batchSize (size_t queueDepth, const std::tm& localTime) const {
+  if (isQuietHours (localTime) || queueDepth == 0 || config_.drainTarget.count () <= 0)
+    return 1;
+  // posts left until the drain target at the fastest cadence
+  long long minInterval = std::max<long long> (1, config_.minInterval.count ());
+  size_t slots
+      = static_cast<size_t> (std::max<long long> (1, config_.drainTarget.count () / minInterval));
+  size_t needed = (queueDepth + slots - 1) / slots;
+  return std::clamp<size_t> (needed, 1, config_.maxBatch);
+}
@@ -0,0 +1,63 @@
+#ifndef __POSTINGRATE_H__
+#define __POSTINGRATE_H__
+
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+
+// Posting cadence derived from the backlog instead of a fixed interval.
+// The interval is chosen so the current queue drains within drainTarget, is shortened further
+// as the oldest item approaches maxItemAge and is clamped to [minInterval, maxInterval].
+// Quiet hours keep the slow cadence regardless of the backlog.
+
+struct PostingRateConfig {
+  std::chrono::seconds minInterval{ 60 * 5 };       // fastest posting rate
+  std::chrono::seconds maxInterval{ 60 * 19 };      // slowest posting rate with a backlog
+  std::chrono::seconds drainTarget{ 60 * 60 * 8 };  // drain the backlog within
+  std::chrono::seconds maxItemAge{ 60 * 60 * 12 };  // items older than this post at minInterval
+  std::chrono::seconds quietInterval{ 60 * 180 };   // cadence during quiet hours
+  size_t maxBatch = 5; // items merged into one digest post when the backlog cannot drain in time
+  int quietStartHour = 23;
+  int quietEndHour = 6;
+};
+
+class PostingRate {
+public:
+  PostingRate () = default;
+  explicit PostingRate (const PostingRateConfig& config) : config_ (config) {
+  }
+
+  // Load the "posting" section of botConfig.json
+  static PostingRateConfig configFromBotConfig ();
+  // "posting" overridden by the channel's entry in the "lanes" section
+  static PostingRateConfig configForChannel (uint64_t channelId);
+  // Keys present in the section override the base config
+  static PostingRateConfig configFromJson (const nlohmann::json& section,
+                                           PostingRateConfig base = {});
+
+  bool isQuietHours (const std::tm& localTime) const;
+
+  /**
+   * @brief Delay before the next post.
+   * @return 0 when the queue is empty - the caller should wait for new items instead.
+   */
+  std::chrono::seconds nextInterval (size_t queueDepth, std::chrono::seconds oldestItemAge,
+                                     const std::tm& localTime) const;
+
+  /**
+   * @brief Items to post at once so the backlog still drains within drainTarget at minInterval.
+   * @return 1 without a backlog and during quiet hours, at most maxBatch.
+   */
+  size_t batchSize (size_t queueDepth, const std::tm& localTime) const;
+
+  const PostingRateConfig& getConfig () const {
+    return config_;
+  }
+
+private:
+  PostingRateConfig config_;
+};
+
+#endif // __POSTINGRATE_H__
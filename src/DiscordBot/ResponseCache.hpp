@@ -0,0 +1,75 @@
+#ifndef __RESPONSECACHE_H__
+#define __RESPONSECACHE_H__
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+// Rendered replies of deterministic commands.
+// Every entry carries the validity token it was rendered for, e.g. the calendar day or the
+// revision of the source list. A lookup with a different token is a miss and re-renders, so
+// an entry needs no timer to expire.
+
+template <typename Response> class ResponseCache {
+public:
+  std::optional<Response> get (const std::string& key, const std::string& token) const {
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto it = entries_.find (key);
+    if (it == entries_.end () || it->second.token != token)
+      return std::nullopt;
+    return it->second.response;
+  }
+
+  void put (const std::string& key, const std::string& token, Response response) {
+    std::lock_guard<std::mutex> lock (mutex_);
+    entries_[key] = Entry{ token, std::move (response) };
+  }
+
+  // get counted as a hit or a miss, for callers that render a miss elsewhere and put it later
+  std::optional<Response> lookup (const std::string& key, const std::string& token) {
+    std::optional<Response> cached = get (key, token);
+    if (cached)
+      hits_++;
+    else
+      misses_++;
+    return cached;
+  }
+
+  // Concurrent misses may render twice, the renders are deterministic so either result is kept
+  Response getOrRender (const std::string& key, const std::string& token,
+                        const std::function<Response ()>& render) {
+    if (auto cached = lookup (key, token))
+      return *cached;
+    Response response = render ();
+    put (key, token, response);
+    return response;
+  }
+
+  void invalidate (const std::string& key) {
+    std::lock_guard<std::mutex> lock (mutex_);
+    entries_.erase (key);
+  }
+
+  uint64_t getHits () const {
+    return hits_;
+  }
+  uint64_t getMisses () const {
+    return misses_;
+  }
+
+private:
+  struct Entry {
+    std::string token;
+    Response response;
+  };
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, Entry> entries_;
+  std::atomic<uint64_t> hits_{ 0 };
+  std::atomic<uint64_t> misses_{ 0 };
+};
+
+#endif // __RESPONSECACHE_H__
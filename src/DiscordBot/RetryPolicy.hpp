@@ -0,0 +1,39 @@
+#ifndef __RETRYPOLICY_H__
+#define __RETRYPOLICY_H__
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+// Exponential backoff with jitter for idempotent Discord requests (crosspost, thread).
+// Only 5xx is retried here: a request without a response may still have been executed, and a 429
+// belongs to SendPipeline's buckets, which know the retry-after and the global cooldown.
+// The delay is half the backoff plus a random share of the other half, so requests failing
+// together do not retry together.
+
+struct RetryPolicy {
+  unsigned attempts = 3; // including the first try
+  std::chrono::milliseconds base{ 1000 };
+  std::chrono::milliseconds cap{ 30000 };
+
+  static bool isTransient (uint16_t httpStatus) {
+    return httpStatus >= 500;
+  }
+
+  bool shouldRetry (unsigned attempt, uint16_t httpStatus) const {
+    return attempt + 1 < attempts && isTransient (httpStatus);
+  }
+
+  // Delay after the given failed attempt (0 based)
+  template <typename Rng> std::chrono::milliseconds delay (unsigned attempt, Rng& rng) const {
+    int64_t backoff = base.count ();
+    for (unsigned i = 0; i < attempt && backoff < cap.count (); ++i)
+      backoff *= 2;
+    backoff = std::min<int64_t> (backoff, cap.count ());
+    std::uniform_int_distribution<int64_t> jitter (0, backoff - backoff / 2);
+    return std::chrono::milliseconds (backoff / 2 + jitter (rng));
+  }
+};
+
+#endif // __RETRYPOLICY_H__
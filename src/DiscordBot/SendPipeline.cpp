@@ -0,0 +1,179 @@
+#include "SendPipeline.hpp"
+#include <Logger/Logger.hpp>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+RateBuckets::Clock::time_point RateBuckets::readyAt (const std::string& route,
+                                                     Clock::time_point now) const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  Clock::time_point ready = std::max (now, globalResetAt_);
+  auto it = buckets_.find (route);
+  if (it != buckets_.end () && it->second.remaining == 0)
+    ready = std::max (ready, it->second.resetAt);
+  return ready;
+}
+
+void RateBuckets::consume (const std::string& route) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  auto it = buckets_.find (route);
+  if (it != buckets_.end () && it->second.remaining > 0)
+    it->second.remaining--;
+}
+
+void RateBuckets::update (const std::string& route, const RateLimitInfo& info,
+                          Clock::time_point now) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  if (info.limited && info.global) {
+    globalResetAt_ = std::max (globalResetAt_, now + info.retryAfter);
+    return;
+  }
+  Bucket& bucket = buckets_[route];
+  if (info.limited) {
+    bucket.remaining = 0;
+    bucket.resetAt = now + std::max (info.retryAfter, info.resetAfter);
+    return;
+  }
+  if (info.remaining < 0)
+    return; // no headers, keep the previous estimate
+  bucket.remaining = info.remaining;
+  bucket.resetAt = now + info.resetAfter;
+}
+
+SendPipeline::SendPipeline (Scheduler& scheduler, Transport transport, size_t maxLength)
+    : scheduler_ (scheduler), transport_ (std::move (transport)), maxLength_ (maxLength) {
+}
+
+std::string SendPipeline::messagesRoute (uint64_t channelId) {
+  return "POST /channels/" + std::to_string (channelId) + "/messages";
+}
+
+std::string SendPipeline::webhookRoute (uint64_t channelId) {
+  return "POST /webhooks/channel/" + std::to_string (channelId);
+}
+
+std::string SendPipeline::routeOf (const OutboundMessage& message) {
+  return message.webhook ? webhookRoute (message.channelId) : messagesRoute (message.channelId);
+}
+
+OutboundMessage SendPipeline::takeBatch (std::deque<OutboundMessage>& queue, size_t maxLength,
+                                         size_t* merged) {
+  OutboundMessage batch = std::move (queue.front ());
+  queue.pop_front ();
+  size_t count = 1;
+  if (batch.digestible) {
+    std::vector<std::function<void (uint64_t)>> callbacks;
+    std::vector<std::function<void (uint16_t)>> failures;
+    if (batch.onCreated)
+      callbacks.push_back (std::move (batch.onCreated));
+    if (batch.onFailed)
+      failures.push_back (std::move (batch.onFailed));
+    while (!queue.empty () && queue.front ().digestible
+           && queue.front ().embedded == batch.embedded
+           && queue.front ().webhook == batch.webhook
+           && batch.content.size () + 1 + queue.front ().content.size () <= maxLength) {
+      batch.content += "\n" + queue.front ().content;
+      if (queue.front ().username != batch.username) {
+        batch.username.clear ();
+        batch.avatarUrl.clear ();
+      }
+      if (queue.front ().onCreated)
+        callbacks.push_back (std::move (queue.front ().onCreated));
+      if (queue.front ().onFailed)
+        failures.push_back (std::move (queue.front ().onFailed));
+      queue.pop_front ();
+      count++;
+    }
+    if (!callbacks.empty ()) {
+      batch.onCreated = [callbacks = std::move (callbacks)] (uint64_t messageId) {
+        for (const auto& callback : callbacks)
+          callback (messageId);
+      };
+    }
+    if (!failures.empty ()) {
+      batch.onFailed = [failures = std::move (failures)] (uint16_t httpStatus) {
+        for (const auto& failure : failures)
+          failure (httpStatus);
+      };
+    }
+  }
+  if (merged)
+    *merged = count;
+  return batch;
+}
+
+void SendPipeline::enqueue (OutboundMessage message) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  uint64_t channelId = message.channelId;
+  Lane& lane = lanes_[channelId];
+  lane.queue.push_back (std::move (message));
+  arm (channelId, lane);
+}
+
+size_t SendPipeline::getQueuedCount () const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  size_t count = 0;
+  for (const auto& [channelId, lane] : lanes_)
+    count += lane.queue.size ();
+  return count;
+}
+
+void SendPipeline::arm (uint64_t channelId, Lane& lane) {
+  if (lane.armed || lane.inFlight || lane.queue.empty ())
+    return;
+  lane.armed = true;
+  Clock::time_point now = Clock::now ();
+  Clock::duration delay = buckets_.readyAt (routeOf (lane.queue.front ()), now) - now;
+  // Zero delay still goes through the scheduler, so messages enqueued by the same task merge
+  scheduler_.scheduleOnce (delay, [this, channelId] () { drain (channelId); }, "send");
+}
+
+void SendPipeline::drain (uint64_t channelId) {
+  OutboundMessage batch;
+  size_t merged = 0;
+  {
+    std::lock_guard<std::mutex> lock (mutex_);
+    Lane& lane = lanes_[channelId];
+    lane.armed = false;
+    if (lane.inFlight || lane.queue.empty ())
+      return;
+    // The bucket may have been drained by a response that arrived after arming
+    Clock::time_point now = Clock::now ();
+    if (buckets_.readyAt (routeOf (lane.queue.front ()), now) > now) {
+      arm (channelId, lane);
+      return;
+    }
+    batch = takeBatch (lane.queue, maxLength_, &merged);
+    lane.inFlight = true;
+  }
+  if (merged > 1) {
+    digests_++;
+    LOG_I_STREAM << "Merged " << merged << " items into one message for channel " << channelId
+                 << std::endl;
+  }
+
+  buckets_.consume (routeOf (batch));
+  auto shared = std::make_shared<OutboundMessage> (std::move (batch));
+  transport_ (*shared, [this, channelId, shared] (const SendResult& result) {
+    finish (channelId, std::move (*shared), result);
+  });
+}
+
+void SendPipeline::finish (uint64_t channelId, OutboundMessage batch, const SendResult& result) {
+  buckets_.update (routeOf (batch), result.limit, Clock::now ());
+  if (result.ok && batch.onCreated)
+    batch.onCreated (result.messageId);
+  if (!result.ok && !result.limit.limited && batch.onFailed)
+    batch.onFailed (result.httpStatus);
+
+  std::lock_guard<std::mutex> lock (mutex_);
+  Lane& lane = lanes_[channelId];
+  lane.inFlight = false;
+  if (!result.ok && result.limit.limited) {
+    // Rejected with 429 - retry once the bucket resets, ahead of everything queued later
+    LOG_W_STREAM << "Rate limited in channel " << channelId << ", retrying in "
+                 << result.limit.retryAfter.count () << " ms" << std::endl;
+    lane.queue.push_front (std::move (batch));
+  }
+  arm (channelId, lane);
+}
@@ -0,0 +1,116 @@
+#ifndef __SENDPIPELINE_H__
+#define __SENDPIPELINE_H__
+
+#include <Scheduler/Scheduler.hpp>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Outbound queue in front of Discord's rate limits.
+// Messages wait per channel until the channel's route bucket has room, one request per channel
+// is in flight so order is kept, and queued item links are merged into digest messages.
+
+struct OutboundMessage {
+  uint64_t channelId = 0;
+  std::string content;
+  bool embedded = true;
+  bool digestible = false; // may be merged with neighbouring digestible messages
+  bool webhook = false;     // posted through the channel's webhook, it has its own bucket
+  std::string username;     // webhook name override, e.g. the feed's source
+  std::string avatarUrl;    // webhook avatar override
+  std::function<void (uint64_t messageId)> onCreated;
+  // the send failed for good with the response status (0 without one), not called for a 429
+  std::function<void (uint16_t httpStatus)> onFailed;
+};
+
+// Rate limit state reported with a response
+struct RateLimitInfo {
+  int64_t remaining = -1;                  // requests left in the bucket, -1 if not reported
+  std::chrono::milliseconds resetAfter{ 0 };
+  std::chrono::milliseconds retryAfter{ 0 }; // set with 429 Too Many Requests
+  bool global = false;
+  bool limited = false; // the request was rejected with 429
+};
+
+struct SendResult {
+  bool ok = false;
+  uint64_t messageId = 0;
+  uint16_t httpStatus = 0; // response status, 0 when no response arrived
+  RateLimitInfo limit;
+};
+
+// Per-route buckets, a route is the request path with its major parameter
+class RateBuckets {
+public:
+  using Clock = Scheduler::Clock;
+
+  // Earliest time a request on the route may be sent
+  Clock::time_point readyAt (const std::string& route, Clock::time_point now) const;
+  // A request is about to be sent, the known remaining count is spent optimistically
+  void consume (const std::string& route);
+  void update (const std::string& route, const RateLimitInfo& info, Clock::time_point now);
+
+private:
+  struct Bucket {
+    int64_t remaining = -1;
+    Clock::time_point resetAt;
+  };
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, Bucket> buckets_;
+  Clock::time_point globalResetAt_;
+};
+
+class SendPipeline {
+public:
+  using Clock = Scheduler::Clock;
+  using Done = std::function<void (const SendResult& result)>;
+  // Performs the request, done may be called from any thread
+  using Transport = std::function<void (const OutboundMessage& message, Done done)>;
+
+  SendPipeline (Scheduler& scheduler, Transport transport, size_t maxLength);
+
+  void enqueue (OutboundMessage message);
+  size_t getQueuedCount () const;
+  uint64_t getDigestCount () const {
+    return digests_;
+  }
+
+  RateBuckets& getBuckets () {
+    return buckets_;
+  }
+  static std::string messagesRoute (uint64_t channelId);
+  // The channel's webhook, one per channel so the channel id stands in for the webhook id
+  static std::string webhookRoute (uint64_t channelId);
+  static std::string routeOf (const OutboundMessage& message);
+
+  // Merge the leading digestible messages with the same embed flag and transport while they fit
+  // maxLength. A digest of several sources loses the per-source webhook name.
+  static OutboundMessage takeBatch (std::deque<OutboundMessage>& queue, size_t maxLength,
+                                    size_t* merged = nullptr);
+
+private:
+  struct Lane {
+    std::deque<OutboundMessage> queue;
+    bool inFlight = false;
+    bool armed = false; // a drain task is scheduled
+  };
+
+  void arm (uint64_t channelId, Lane& lane); // callers hold mutex_
+  void drain (uint64_t channelId);
+  void finish (uint64_t channelId, OutboundMessage batch, const SendResult& result);
+
+  Scheduler& scheduler_;
+  Transport transport_;
+  const size_t maxLength_;
+  RateBuckets buckets_;
+  mutable std::mutex mutex_; // guards lanes_
+  std::map<uint64_t, Lane> lanes_;
+  std::atomic<uint64_t> digests_{ 0 };
+};
+
+#endif // __SENDPIPELINE_H__
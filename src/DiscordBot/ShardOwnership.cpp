@@ -0,0 +1,108 @@
+#include "ShardOwnership.hpp"
+#include <BotConfig/BotConfig.hpp>
+#include <Logger/Logger.hpp>
+#include <cstdlib>
+#include <string>
+
+namespace {
+  uint32_t fromEnvironment (const char* name, uint32_t fallback) {
+    const char* value = std::getenv (name);
+    if (!value || !*value)
+      return fallback;
+    try {
+      return static_cast<uint32_t> (std::stoul (value));
+    } catch (const std::exception&) {
+      LOG_W_STREAM << "Ignoring invalid " << name << "=" << value << std::endl;
+      return fallback;
+    }
+  }
+}
+
+ShardConfig ShardConfig::fromBotConfig () {
+  ShardConfig config;
+  config.shardCount = BotConfig::value<uint32_t> ("sharding/shardCount", config.shardCount);
+  config.clusterId = BotConfig::value<uint32_t> ("sharding/clusterId", config.clusterId);
+  config.maxClusters = BotConfig::value<uint32_t> ("sharding/maxClusters", config.maxClusters);
+  config.shardCount = fromEnvironment ("BOTPP_SHARD_COUNT", config.shardCount);
+  config.clusterId = fromEnvironment ("BOTPP_CLUSTER_ID", config.clusterId);
+  config.maxClusters = fromEnvironment ("BOTPP_MAX_CLUSTERS", config.maxClusters);
+  config.normalize ();
+  return config;
+}
+
+int ShardConfig::normalize () {
+  int result = 0;
+  if (maxClusters == 0) {
+    maxClusters = 1;
+    result = -1;
+  }
+  if (clusterId >= maxClusters) {
+    LOG_W_STREAM << "Cluster id " << clusterId << " out of range, using 0" << std::endl;
+    clusterId = 0;
+    result = -1;
+  }
+  // Every process has to agree on the shard count, the recommended one may change between starts
+  if (maxClusters > 1 && shardCount < maxClusters) {
+    LOG_W_STREAM << "Shard count " << shardCount << " is below the cluster count, using "
+                 << maxClusters << std::endl;
+    shardCount = maxClusters;
+    result = -1;
+  }
+  return result;
+}
+
+ShardOwnership::ShardOwnership (const ShardConfig& config) : config_ (config) {
+  config_.normalize ();
+}
+
+uint32_t ShardOwnership::shardOf (uint64_t guildId, uint32_t shardCount) {
+  return shardCount == 0 ? 0 : static_cast<uint32_t> ((guildId >> 22) % shardCount);
+}
+
+bool ShardOwnership::ownsShard (uint32_t shardId) const {
+  return shardId % config_.maxClusters == config_.clusterId;
+}
+
+bool ShardOwnership::ownsGuild (uint64_t guildId) const {
+  if (isSingleCluster ())
+    return true;
+  return ownsShard (shardOf (guildId, config_.shardCount));
+}
+
+bool ShardOwnership::ownsChannel (uint64_t channelId) const {
+  if (isSingleCluster ())
+    return true;
+  std::lock_guard<std::mutex> lock (mutex_);
+  auto it = channelGuild_.find (channelId);
+  return it != channelGuild_.end () && ownsGuild (it->second);
+}
+
+void ShardOwnership::addGuild (uint64_t guildId, const std::vector<uint64_t>& channels) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  auto& known = guildChannels_[guildId];
+  for (uint64_t channelId : channels) {
+    channelGuild_[channelId] = guildId;
+    known.insert (channelId);
+  }
+}
+
+void ShardOwnership::addChannel (uint64_t guildId, uint64_t channelId) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  channelGuild_[channelId] = guildId;
+  guildChannels_[guildId].insert (channelId);
+}
+
+void ShardOwnership::removeGuild (uint64_t guildId) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  auto it = guildChannels_.find (guildId);
+  if (it == guildChannels_.end ())
+    return;
+  for (uint64_t channelId : it->second)
+    channelGuild_.erase (channelId);
+  guildChannels_.erase (it);
+}
+
+size_t ShardOwnership::getKnownChannelCount () const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  return channelGuild_.size ();
+}
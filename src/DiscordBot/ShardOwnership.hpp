@@ -0,0 +1,57 @@
+#ifndef __SHARDOWNERSHIP_H__
+#define __SHARDOWNERSHIP_H__
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Which guilds, and through them which channels, this process is responsible for.
+// Discord puts a guild on shard (guild_id >> 22) % shardCount and DPP starts the shards with
+// shard % maxClusters == clusterId, so every process posts only to channels of its own guilds.
+// Channels are learned from the guild_create events of the process's own shards.
+
+struct ShardConfig {
+  uint32_t shardCount = 0; // 0: Discord's recommendation, only with a single cluster
+  uint32_t clusterId = 0;
+  uint32_t maxClusters = 1;
+
+  // "sharding" section of botConfig.json, overridden by BOTPP_SHARD_COUNT, BOTPP_CLUSTER_ID and
+  // BOTPP_MAX_CLUSTERS so one config serves every process
+  static ShardConfig fromBotConfig ();
+  // Fix up an inconsistent config, -1 if it had to be changed
+  int normalize ();
+};
+
+class ShardOwnership {
+public:
+  explicit ShardOwnership (const ShardConfig& config = {});
+
+  static uint32_t shardOf (uint64_t guildId, uint32_t shardCount);
+
+  bool isSingleCluster () const {
+    return config_.maxClusters <= 1;
+  }
+  const ShardConfig& getConfig () const {
+    return config_;
+  }
+
+  bool ownsShard (uint32_t shardId) const;
+  bool ownsGuild (uint64_t guildId) const;
+  // Always true for a single cluster, otherwise only for channels of known owned guilds
+  bool ownsChannel (uint64_t channelId) const;
+
+  void addGuild (uint64_t guildId, const std::vector<uint64_t>& channels);
+  void addChannel (uint64_t guildId, uint64_t channelId);
+  void removeGuild (uint64_t guildId);
+  size_t getKnownChannelCount () const;
+
+private:
+  ShardConfig config_;
+  mutable std::mutex mutex_;
+  std::unordered_map<uint64_t, uint64_t> channelGuild_; // channel -> guild
+  std::unordered_map<uint64_t, std::unordered_set<uint64_t>> guildChannels_;
+};
+
+#endif // __SHARDOWNERSHIP_H__
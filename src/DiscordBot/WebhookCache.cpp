@@ -0,0 +1,73 @@
+#include "WebhookCache.hpp"
+#include <algorithm>
+#include <cctype>
+
+void WebhookCache::set (uint64_t channelId, const WebhookCredentials& credentials) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  webhooks_[channelId] = credentials;
+  failedUntil_.erase (channelId);
+}
+
+void WebhookCache::remove (uint64_t channelId) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  webhooks_.erase (channelId);
+}
+
+std::optional<WebhookCredentials> WebhookCache::get (uint64_t channelId) const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  auto it = webhooks_.find (channelId);
+  if (it == webhooks_.end ())
+    return std::nullopt;
+  return it->second;
+}
+
+size_t WebhookCache::size () const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  return webhooks_.size ();
+}
+
+bool WebhookCache::markFailed (uint64_t channelId, Clock::time_point now) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  auto it = failedUntil_.find (channelId);
+  bool failing = it != failedUntil_.end () && it->second > now;
+  failedUntil_[channelId] = now + failureTtl_;
+  return !failing;
+}
+
+bool WebhookCache::hasFailed (uint64_t channelId, Clock::time_point now) const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  auto it = failedUntil_.find (channelId);
+  return it != failedUntil_.end () && it->second > now;
+}
+
+bool WebhookCache::disable (uint64_t channelId) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  return disabled_.insert (channelId).second;
+}
+
+bool WebhookCache::isDisabled (uint64_t channelId) const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  return disabled_.count (channelId) > 0;
+}
+
+std::optional<WebhookCredentials>
+WebhookCache::pick (const std::vector<WebhookCandidate>& candidates, const std::string& name) {
+  for (const auto& candidate : candidates) {
+    if (candidate.name == name && !candidate.token.empty ())
+      return WebhookCredentials{ candidate.id, candidate.token };
+  }
+  return std::nullopt;
+}
+
+std::string WebhookCache::sourceName (const std::string& sourceUrl) {
+  std::string host = sourceUrl;
+  size_t scheme = host.find ("://");
+  if (scheme != std::string::npos)
+    host.erase (0, scheme + 3);
+  host = host.substr (0, host.find_first_of ("/?#:"));
+  std::transform (host.begin (), host.end (), host.begin (),
+                  [] (unsigned char c) { return static_cast<char> (std::tolower (c)); });
+  if (host.rfind ("www.", 0) == 0)
+    host.erase (0, 4);
+  return host;
+}
@@ -0,0 +1,67 @@
+#ifndef __WEBHOOKCACHE_H__
+#define __WEBHOOKCACHE_H__
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Webhooks of the channels in webhook delivery mode. Feed posts go through them so they have
+// their own rate limit bucket instead of sharing the bot's message budget with command replies.
+// A webhook the bot created earlier is found by its name and reused, a new one is created only
+// when the channel has none. A channel where no webhook could be created posts as the bot until
+// failureTtl passes, so a missing permission does not cost two failing requests per post.
+
+struct WebhookCredentials {
+  uint64_t id = 0;
+  std::string token;
+};
+
+// A webhook as listed for a channel
+struct WebhookCandidate {
+  uint64_t id = 0;
+  std::string name;
+  std::string token; // empty for webhooks the bot cannot execute
+};
+
+class WebhookCache {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit WebhookCache (Clock::duration failureTtl = std::chrono::hours (1))
+      : failureTtl_ (failureTtl) {
+  }
+
+  void set (uint64_t channelId, const WebhookCredentials& credentials);
+  // The webhook was deleted, the next post looks it up again
+  void remove (uint64_t channelId);
+  std::optional<WebhookCredentials> get (uint64_t channelId) const;
+  size_t size () const;
+
+  // No webhook could be set up, true when the channel was not failing yet - log it once
+  bool markFailed (uint64_t channelId, Clock::time_point now = Clock::now ());
+  bool hasFailed (uint64_t channelId, Clock::time_point now = Clock::now ()) const;
+  // Webhook mode off for the channel for good, e.g. an announcement channel whose posts must be
+  // crossposted by the bot. True when it was on so far.
+  bool disable (uint64_t channelId);
+  bool isDisabled (uint64_t channelId) const;
+
+  // An executable webhook of the channel with the bot's name
+  static std::optional<WebhookCredentials> pick (const std::vector<WebhookCandidate>& candidates,
+                                                 const std::string& name);
+  // Webhook username for a feed: its host without "www."
+  static std::string sourceName (const std::string& sourceUrl);
+
+private:
+  mutable std::mutex mutex_;
+  std::unordered_map<uint64_t, WebhookCredentials> webhooks_;
+  const Clock::duration failureTtl_;
+  std::unordered_map<uint64_t, Clock::time_point> failedUntil_;
+  std::unordered_set<uint64_t> disabled_;
+};
+
+#endif // __WEBHOOKCACHE_H__
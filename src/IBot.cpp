@@ -26,8 +26,8 @@ namespace dotname {
       auto logo = std::ifstream (AssetContext::getAssetsPath () / "logo.png");
 
       DiscordBot dbot;
-      if (dbot.initCluster ()) {
-        LOG_I_STREAM << "Discord bot initialized successfully." << std::endl;
+      if (dbot.initCluster () == 0) {
+        LOG_I_STREAM << "Discord bot shut down cleanly." << std::endl;
       } else {
         LOG_E_STREAM << "Failed to initialize Discord bot." << std::endl;
       }
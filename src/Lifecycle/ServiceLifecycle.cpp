@@ -0,0 +1,143 @@
+#include "ServiceLifecycle.hpp"
+#include <Logger/Logger.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <thread>
+
+void ServiceLifecycle::add (const std::string& name, Action start, Action stop, bool essential) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  bool running = !start;
+  services_.push_back (Service{ name, std::move (start), std::move (stop), running, essential });
+}
+
+bool ServiceLifecycle::startAll () {
+  std::lock_guard<std::mutex> lock (mutex_);
+  if (started_ || stopped_)
+    return false;
+  started_ = true;
+  for (auto& service : services_) {
+    if (service.running)
+      continue;
+    service.start ();
+    service.running = true;
+    LOG_I_STREAM << "Service " << service.name << " started" << std::endl;
+  }
+  return true;
+}
+
+bool ServiceLifecycle::isStarted () const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  return started_ && !stopped_;
+}
+
+ServiceLifecycle::~ServiceLifecycle () {
+  if (stopping_.joinable ())
+    stopping_.join ();
+  if (finishing_.joinable ())
+    finishing_.join ();
+}
+
+std::vector<std::string> ServiceLifecycle::stopAll (Clock::duration timeout,
+                                                    Clock::duration reserve) {
+  // Shared with the stopping threads, which outlive this call when a step hangs
+  struct Progress {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<Service> pending; // in stop order
+    std::vector<bool> claimed;    // taken by one of the stopping threads
+    std::vector<bool> finished;
+    bool abandoned = false; // the sequence overran, its remaining steps are not started
+    bool done (const std::vector<size_t>& steps) const {
+      for (size_t step : steps)
+        if (!finished[step])
+          return false;
+      return true;
+    }
+  };
+  auto progress = std::make_shared<Progress> ();
+  {
+    std::lock_guard<std::mutex> lock (mutex_);
+    if (stopped_)
+      return {};
+    stopped_ = true;
+    for (auto service = services_.rbegin (); service != services_.rend (); ++service) {
+      if (service->running)
+        progress->pending.push_back (*service);
+      service->running = false;
+    }
+  }
+  progress->claimed.assign (progress->pending.size (), false);
+  progress->finished.assign (progress->pending.size (), false);
+  std::vector<size_t> all;
+  for (size_t i = 0; i < progress->pending.size (); ++i)
+    all.push_back (i);
+
+  auto run = [progress] (size_t step) {
+    const Service& service = progress->pending[step];
+    try {
+      if (service.stop)
+        service.stop ();
+    } catch (const std::exception& e) {
+      LOG_E_STREAM << "Service " << service.name << " failed to stop: " << e.what () << std::endl;
+    }
+    std::lock_guard<std::mutex> lock (progress->mutex);
+    progress->finished[step] = true;
+    progress->changed.notify_all ();
+  };
+
+  stopping_ = std::thread ([progress, run, all] () {
+    for (size_t step : all) {
+      {
+        std::lock_guard<std::mutex> lock (progress->mutex);
+        if (progress->abandoned)
+          return;
+        progress->claimed[step] = true;
+      }
+      run (step);
+    }
+  });
+
+  Clock::time_point deadline = Clock::now () + timeout;
+  reserve = std::min (reserve, timeout);
+  std::unique_lock<std::mutex> lock (progress->mutex);
+  bool finished = progress->changed.wait_until (lock, deadline - reserve,
+                                                [&] () { return progress->done (all); });
+  if (!finished && reserve > Clock::duration::zero ()) {
+    // Leave the hanging step behind and run the essential steps it still blocks
+    progress->abandoned = true;
+    std::vector<size_t> essential;
+    for (size_t step : all) {
+      if (!progress->claimed[step] && progress->pending[step].essential) {
+        progress->claimed[step] = true;
+        essential.push_back (step);
+      }
+    }
+    if (!essential.empty ()) {
+      LOG_W_STREAM << "Shutdown is running late, stopping " << essential.size ()
+                   << " essential services out of order" << std::endl;
+      finishing_ = std::thread ([run, essential] () {
+        for (size_t step : essential)
+          run (step);
+      });
+      progress->changed.wait_until (lock, deadline,
+                                    [&] () { return progress->done (essential); });
+    }
+  }
+  std::vector<std::string> unfinished;
+  for (size_t step : all)
+    if (!progress->finished[step])
+      unfinished.push_back (progress->pending[step].name);
+  lock.unlock ();
+
+  if (unfinished.empty ()) {
+    stopping_.join ();
+    if (finishing_.joinable ())
+      finishing_.join ();
+  } else {
+    LOG_E_STREAM << "Shutdown deadline passed, " << unfinished.size ()
+                 << " services did not stop, first: " << unfinished.front () << std::endl;
+  }
+  return unfinished;
+}
@@ -0,0 +1,63 @@
+#ifndef __SERVICELIFECYCLE_H__
+#define __SERVICELIFECYCLE_H__
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Background services started once per process, however often the gateway reconnects, and
+// stopped in reverse start order, so a service is stopped before the ones it depends on.
+// Shutdown has a deadline: when a stop step hangs, stopAll returns the steps left and the caller
+// should leave with _exit - the stopping thread is joined only by the destructor, and letting
+// static destruction run under it would tear down what the hanging step still uses.
+// Essential services (state flushes) still get stopped when an earlier step hangs: the last part
+// of the timeout is reserved for them, the sequence is abandoned and they run on their own.
+
+class ServiceLifecycle {
+public:
+  using Action = std::function<void ()>;
+  using Clock = std::chrono::steady_clock;
+
+  ServiceLifecycle () = default;
+  ~ServiceLifecycle (); // waits for a stop sequence that missed its deadline
+  ServiceLifecycle (const ServiceLifecycle&) = delete;
+  ServiceLifecycle& operator= (const ServiceLifecycle&) = delete;
+
+  // Register before startAll. An empty start marks a service that already runs, it is stopped
+  // even when startAll never came; an empty stop marks one that needs no teardown.
+  void add (const std::string& name, Action start, Action stop, bool essential = false);
+
+  // false when the services are already running or were stopped
+  bool startAll ();
+  bool isStarted () const;
+
+  /**
+   * @brief Stop the started services in reverse order.
+   * @param reserve End part of the timeout kept for essential services when a stop step hangs,
+   * 0 waits the whole timeout for the sequence.
+   * @return Names of the services whose stop did not finish within the timeout, empty when
+   * everything stopped cleanly.
+   */
+  std::vector<std::string> stopAll (Clock::duration timeout,
+                                    Clock::duration reserve = Clock::duration::zero ());
+
+private:
+  struct Service {
+    std::string name;
+    Action start;
+    Action stop;
+    bool running = false;
+    bool essential = false;
+  };
+  mutable std::mutex mutex_;
+  std::vector<Service> services_;
+  bool started_ = false;
+  bool stopped_ = false;
+  std::thread stopping_;
+  std::thread finishing_; // essential steps of an abandoned sequence
+};
+
+#endif // __SERVICELIFECYCLE_H__
@@ -0,0 +1,182 @@
+#include "DeliveryOutbox.hpp"
+#include <Logger/Logger.hpp>
+#include <algorithm>
+
+int DeliveryOutbox::open (const std::filesystem::path& path) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  path_ = path;
+  inFlight_.clear ();
+  pending_.clear ();
+  nextId_ = 1;
+
+  std::ifstream in (path_);
+  std::string line;
+  size_t skipped = 0;
+  while (std::getline (in, line)) {
+    if (line.empty ())
+      continue;
+    // A torn last line from a crash is skipped, its item was not sent yet
+    nlohmann::json record = nlohmann::json::parse (line, nullptr, false);
+    if (record.is_discarded () || !record.is_object ()) {
+      skipped++;
+      continue;
+    }
+    if (record.contains ("take")) {
+      OutboxEntry entry;
+      entry.id = record["take"].get<uint64_t> ();
+      entry.key = record.value ("key", "");
+      entry.payload = record.value ("item", nlohmann::json::object ());
+      nextId_ = std::max (nextId_, entry.id + 1);
+      inFlight_[entry.id] = std::move (entry);
+    } else if (record.contains ("ack") && record["ack"].is_array ()) {
+      for (const auto& id : record["ack"])
+        inFlight_.erase (id.get<uint64_t> ());
+    }
+  }
+  in.close ();
+  if (skipped > 0) {
+    LOG_W_STREAM << "Delivery outbox: skipped " << skipped << " damaged journal records"
+                 << std::endl;
+  }
+
+  // Start from a journal holding only the live entries
+  if (compact () != 0) {
+    LOG_E_STREAM << "Cannot open delivery outbox " << path_ << std::endl;
+    return -1;
+  }
+  LOG_I_STREAM << "Delivery outbox: " << inFlight_.size () << " unconfirmed deliveries in "
+               << path_ << std::endl;
+  return 0;
+}
+
+bool DeliveryOutbox::isOpen () const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  return journal_.is_open ();
+}
+
+void DeliveryOutbox::setBatchSize (size_t batchSize) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  batchSize_ = std::max<size_t> (1, batchSize);
+}
+
+uint64_t DeliveryOutbox::begin (const std::string& key, const nlohmann::json& payload) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  if (!journal_.is_open ())
+    return 0;
+  OutboxEntry entry;
+  entry.id = nextId_++;
+  entry.key = key;
+  entry.payload = payload;
+  nlohmann::json record = { { "take", entry.id }, { "key", key }, { "item", payload } };
+  if (append (record.dump () + "\n") != 0)
+    return 0;
+  uint64_t id = entry.id;
+  inFlight_[id] = std::move (entry);
+  return id;
+}
+
+bool DeliveryOutbox::confirm (uint64_t id) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  if (inFlight_.count (id) == 0)
+    return false;
+  if (std::find (pending_.begin (), pending_.end (), id) != pending_.end ())
+    return false;
+  pending_.push_back (id);
+  return pending_.size () >= batchSize_;
+}
+
+uint64_t DeliveryOutbox::retry (uint64_t id, const nlohmann::json& payload) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  auto it = inFlight_.find (id);
+  if (!journal_.is_open () || it == inFlight_.end ())
+    return 0;
+  if (std::find (pending_.begin (), pending_.end (), id) != pending_.end ())
+    return 0;
+  OutboxEntry entry;
+  entry.id = nextId_++;
+  entry.key = it->second.key;
+  entry.payload = payload;
+  nlohmann::json take = { { "take", entry.id }, { "key", entry.key }, { "item", payload } };
+  nlohmann::json ack = { { "ack", { id } } };
+  if (append (take.dump () + "\n" + ack.dump () + "\n") != 0)
+    return 0;
+  inFlight_.erase (it);
+  uint64_t newId = entry.id;
+  inFlight_[newId] = std::move (entry);
+  return newId;
+}
+
+std::vector<std::string> DeliveryOutbox::getPendingKeys () const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  std::vector<std::string> keys;
+  for (uint64_t id : pending_) {
+    auto it = inFlight_.find (id);
+    if (it != inFlight_.end ())
+      keys.push_back (it->second.key);
+  }
+  return keys;
+}
+
+int DeliveryOutbox::commit () {
+  std::lock_guard<std::mutex> lock (mutex_);
+  if (pending_.empty ())
+    return 0;
+  if (append (nlohmann::json{ { "ack", pending_ } }.dump () + "\n") != 0)
+    return -1; // stays pending, the next commit tries again
+  for (uint64_t id : pending_)
+    inFlight_.erase (id);
+  pending_.clear ();
+  return inFlight_.empty () || records_ >= COMPACT_RECORDS ? compact () : 0;
+}
+
+std::vector<OutboxEntry> DeliveryOutbox::getInFlight () const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  std::vector<OutboxEntry> entries;
+  for (const auto& [id, entry] : inFlight_)
+    entries.push_back (entry);
+  return entries;
+}
+
+size_t DeliveryOutbox::getInFlightCount () const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  return inFlight_.size ();
+}
+
+size_t DeliveryOutbox::getPendingCount () const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  return pending_.size ();
+}
+
+int DeliveryOutbox::append (const std::string& lines) {
+  journal_ << lines;
+  journal_.flush ();
+  if (!journal_.good ())
+    return -1;
+  records_ += static_cast<size_t> (std::count (lines.begin (), lines.end (), '\n'));
+  return 0;
+}
+
+int DeliveryOutbox::compact () {
+  // Write the live entries aside and swap, a crash leaves either the old or the new journal
+  std::filesystem::path next = path_;
+  next += ".next";
+  {
+    std::ofstream out (next, std::ios::trunc);
+    for (const auto& [id, entry] : inFlight_) {
+      out << nlohmann::json{ { "take", id }, { "key", entry.key }, { "item", entry.payload } }
+                 .dump ()
+          << "\n";
+    }
+    out.flush ();
+    if (!out.good ())
+      return -1;
+  }
+  journal_.close ();
+  std::error_code ec;
+  std::filesystem::rename (next, path_, ec);
+  if (ec)
+    return -1;
+  journal_.open (path_, std::ios::app);
+  records_ = inFlight_.size ();
+  return journal_.is_open () ? 0 : -1;
+}
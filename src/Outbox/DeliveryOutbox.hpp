@@ -0,0 +1,78 @@
+#ifndef __DELIVERYOUTBOX_H__
+#define __DELIVERYOUTBOX_H__
+
+#include <nlohmann/json.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Write-ahead journal of items handed to Discord but not yet confirmed.
+//
+// outbox.journal  one JSON record per line
+//   {"take":<id>,"key":<seen key>,"item":{...}}   written and flushed before the send
+//   {"ack":[<id>,...]}                            confirmations, group-committed per batch
+//
+// Entries without an ack are still in flight after a restart and get delivered again, so a
+// failed send or a crash never loses an item - at worst it is posted twice.
+
+struct OutboxEntry {
+  uint64_t id = 0;
+  std::string key; // seen key, marked seen once the delivery is committed
+  nlohmann::json payload;
+};
+
+class DeliveryOutbox {
+public:
+  static constexpr size_t COMPACT_RECORDS = 1024; // journal lines before a rewrite
+
+  DeliveryOutbox () = default;
+  DeliveryOutbox (const DeliveryOutbox&) = delete;
+  DeliveryOutbox& operator= (const DeliveryOutbox&) = delete;
+
+  /**
+   * @brief Open or create the journal and replay it.
+   * @return 0 on success, -1 when the journal cannot be written.
+   */
+  int open (const std::filesystem::path& path);
+  bool isOpen () const;
+
+  // Confirmations that fill a batch make confirm return true, the caller should commit
+  void setBatchSize (size_t batchSize);
+
+  // Journal the item before it is sent, 0 when the outbox is not available
+  uint64_t begin (const std::string& key, const nlohmann::json& payload);
+  // The send succeeded, durable with the next commit
+  bool confirm (uint64_t id);
+  // The send failed and is tried again: the entry is journaled anew with the updated payload
+  // and the old one acked, both in one write. Returns the new id, 0 on failure.
+  uint64_t retry (uint64_t id, const nlohmann::json& payload);
+  // Seen keys of the confirmations the next commit will write
+  std::vector<std::string> getPendingKeys () const;
+  // Write all pending confirmations at once
+  int commit ();
+
+  // Unconfirmed entries, after open these are the deliveries a crash interrupted
+  std::vector<OutboxEntry> getInFlight () const;
+  size_t getInFlightCount () const;
+  size_t getPendingCount () const;
+
+private:
+  int append (const std::string& lines); // callers hold mutex_
+  int compact ();                        // callers hold mutex_
+
+  mutable std::mutex mutex_;
+  std::filesystem::path path_;
+  std::ofstream journal_;
+  std::map<uint64_t, OutboxEntry> inFlight_;
+  std::vector<uint64_t> pending_; // confirmed, not yet committed
+  uint64_t nextId_ = 1;
+  size_t records_ = 0; // lines in the journal
+  size_t batchSize_ = 16;
+};
+
+#endif // __DELIVERYOUTBOX_H__
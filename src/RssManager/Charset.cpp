@@ -0,0 +1,346 @@
+#include "Charset.hpp"
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+  // Upper halves (0x80 - 0xFF) of the supported single-byte codepages as Unicode code points.
+  // 0xFFFD marks bytes that are undefined in the codepage.
+  constexpr std::array<uint16_t, 128> kWindows1250 = {
+    0x20AC, 0xFFFD, 0x201A, 0xFFFD, 0x201E, 0x2026, 0x2020, 0x2021, //
+    0xFFFD, 0x2030, 0x0160, 0x2039, 0x015A, 0x0164, 0x017D, 0x0179, //
+    0xFFFD, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014, //
+    0xFFFD, 0x2122, 0x0161, 0x203A, 0x015B, 0x0165, 0x017E, 0x017A, //
+    0x00A0, 0x02C7, 0x02D8, 0x0141, 0x00A4, 0x0104, 0x00A6, 0x00A7, //
+    0x00A8, 0x00A9, 0x015E, 0x00AB, 0x00AC, 0x00AD, 0x00AE, 0x017B, //
+    0x00B0, 0x00B1, 0x02DB, 0x0142, 0x00B4, 0x00B5, 0x00B6, 0x00B7, //
+    0x00B8, 0x0105, 0x015F, 0x00BB, 0x013D, 0x02DD, 0x013E, 0x017C, //
+    0x0154, 0x00C1, 0x00C2, 0x0102, 0x00C4, 0x0139, 0x0106, 0x00C7, //
+    0x010C, 0x00C9, 0x0118, 0x00CB, 0x011A, 0x00CD, 0x00CE, 0x010E, //
+    0x0110, 0x0143, 0x0147, 0x00D3, 0x00D4, 0x0150, 0x00D6, 0x00D7, //
+    0x0158, 0x016E, 0x00DA, 0x0170, 0x00DC, 0x00DD, 0x0162, 0x00DF, //
+    0x0155, 0x00E1, 0x00E2, 0x0103, 0x00E4, 0x013A, 0x0107, 0x00E7, //
+    0x010D, 0x00E9, 0x0119, 0x00EB, 0x011B, 0x00ED, 0x00EE, 0x010F, //
+    0x0111, 0x0144, 0x0148, 0x00F3, 0x00F4, 0x0151, 0x00F6, 0x00F7, //
+    0x0159, 0x016F, 0x00FA, 0x0171, 0x00FC, 0x00FD, 0x0163, 0x02D9,
+  };
+
+  constexpr std::array<uint16_t, 128> kIso8859_2 = {
+    0x0080, 0x0081, 0x0082, 0x0083, 0x0084, 0x0085, 0x0086, 0x0087, //
+    0x0088, 0x0089, 0x008A, 0x008B, 0x008C, 0x008D, 0x008E, 0x008F, //
+    0x0090, 0x0091, 0x0092, 0x0093, 0x0094, 0x0095, 0x0096, 0x0097, //
+    0x0098, 0x0099, 0x009A, 0x009B, 0x009C, 0x009D, 0x009E, 0x009F, //
+    0x00A0, 0x0104, 0x02D8, 0x0141, 0x00A4, 0x013D, 0x015A, 0x00A7, //
+    0x00A8, 0x0160, 0x015E, 0x0164, 0x0179, 0x00AD, 0x017D, 0x017B, //
+    0x00B0, 0x0105, 0x02DB, 0x0142, 0x00B4, 0x013E, 0x015B, 0x02C7, //
+    0x00B8, 0x0161, 0x015F, 0x0165, 0x017A, 0x02DD, 0x017E, 0x017C, //
+    0x0154, 0x00C1, 0x00C2, 0x0102, 0x00C4, 0x0139, 0x0106, 0x00C7, //
+    0x010C, 0x00C9, 0x0118, 0x00CB, 0x011A, 0x00CD, 0x00CE, 0x010E, //
+    0x0110, 0x0143, 0x0147, 0x00D3, 0x00D4, 0x0150, 0x00D6, 0x00D7, //
+    0x0158, 0x016E, 0x00DA, 0x0170, 0x00DC, 0x00DD, 0x0162, 0x00DF, //
+    0x0155, 0x00E1, 0x00E2, 0x0103, 0x00E4, 0x013A, 0x0107, 0x00E7, //
+    0x010D, 0x00E9, 0x0119, 0x00EB, 0x011B, 0x00ED, 0x00EE, 0x010F, //
+    0x0111, 0x0144, 0x0148, 0x00F3, 0x00F4, 0x0151, 0x00F6, 0x00F7, //
+    0x0159, 0x016F, 0x00FA, 0x0171, 0x00FC, 0x00FD, 0x0163, 0x02D9,
+  };
+
+  constexpr std::array<uint16_t, 128> kWindows1252 = {
+    0x20AC, 0xFFFD, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021, //
+    0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0xFFFD, 0x017D, 0xFFFD, //
+    0xFFFD, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014, //
+    0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0xFFFD, 0x017E, 0x0178, //
+    0x00A0, 0x00A1, 0x00A2, 0x00A3, 0x00A4, 0x00A5, 0x00A6, 0x00A7, //
+    0x00A8, 0x00A9, 0x00AA, 0x00AB, 0x00AC, 0x00AD, 0x00AE, 0x00AF, //
+    0x00B0, 0x00B1, 0x00B2, 0x00B3, 0x00B4, 0x00B5, 0x00B6, 0x00B7, //
+    0x00B8, 0x00B9, 0x00BA, 0x00BB, 0x00BC, 0x00BD, 0x00BE, 0x00BF, //
+    0x00C0, 0x00C1, 0x00C2, 0x00C3, 0x00C4, 0x00C5, 0x00C6, 0x00C7, //
+    0x00C8, 0x00C9, 0x00CA, 0x00CB, 0x00CC, 0x00CD, 0x00CE, 0x00CF, //
+    0x00D0, 0x00D1, 0x00D2, 0x00D3, 0x00D4, 0x00D5, 0x00D6, 0x00D7, //
+    0x00D8, 0x00D9, 0x00DA, 0x00DB, 0x00DC, 0x00DD, 0x00DE, 0x00DF, //
+    0x00E0, 0x00E1, 0x00E2, 0x00E3, 0x00E4, 0x00E5, 0x00E6, 0x00E7, //
+    0x00E8, 0x00E9, 0x00EA, 0x00EB, 0x00EC, 0x00ED, 0x00EE, 0x00EF, //
+    0x00F0, 0x00F1, 0x00F2, 0x00F3, 0x00F4, 0x00F5, 0x00F6, 0x00F7, //
+    0x00F8, 0x00F9, 0x00FA, 0x00FB, 0x00FC, 0x00FD, 0x00FE, 0x00FF,
+  };
+
+  // Pre-encoded UTF-8 sequence for every byte value of a codepage
+  struct Utf8Seq {
+    uint8_t len;
+    char bytes[3];
+  };
+  using ExpansionTable = std::array<Utf8Seq, 256>;
+
+  constexpr Utf8Seq encode (uint32_t cp) {
+    if (cp < 0x80)
+      return { 1, { static_cast<char> (cp), 0, 0 } };
+    if (cp < 0x800)
+      return { 2,
+               { static_cast<char> (0xC0 | (cp >> 6)), static_cast<char> (0x80 | (cp & 0x3F)),
+                 0 } };
+    return { 3,
+             { static_cast<char> (0xE0 | (cp >> 12)), static_cast<char> (0x80 | ((cp >> 6) & 0x3F)),
+               static_cast<char> (0x80 | (cp & 0x3F)) } };
+  }
+
+  constexpr ExpansionTable buildTable (const std::array<uint16_t, 128>& upper) {
+    ExpansionTable table{};
+    for (uint32_t b = 0; b < 128; ++b)
+      table[b] = encode (b);
+    for (uint32_t b = 0; b < 128; ++b)
+      table[128 + b] = encode (upper[b]);
+    return table;
+  }
+
+  constexpr std::array<uint16_t, 128> latin1Upper () {
+    std::array<uint16_t, 128> upper{};
+    for (uint16_t b = 0; b < 128; ++b)
+      upper[b] = static_cast<uint16_t> (0x80 + b);
+    return upper;
+  }
+
+  constexpr ExpansionTable kTable1250 = buildTable (kWindows1250);
+  constexpr ExpansionTable kTable8859_2 = buildTable (kIso8859_2);
+  constexpr ExpansionTable kTable1252 = buildTable (kWindows1252);
+  constexpr ExpansionTable kTable8859_1 = buildTable (latin1Upper ());
+
+  const ExpansionTable* tableFor (Charset::Encoding encoding) {
+    switch (encoding) {
+    case Charset::Encoding::Windows1250:
+      return &kTable1250;
+    case Charset::Encoding::Iso8859_2:
+      return &kTable8859_2;
+    case Charset::Encoding::Windows1252:
+      return &kTable1252;
+    case Charset::Encoding::Iso8859_1:
+      return &kTable8859_1;
+    default:
+      return nullptr;
+    }
+  }
+
+  constexpr uint64_t kHighBits = 0x8080808080808080ULL;
+
+  inline uint64_t load64 (const char* p) {
+    uint64_t word;
+    std::memcpy (&word, p, sizeof (word));
+    return word;
+  }
+
+  // Length of the leading pure-ASCII run, checked one 64-bit word at a time
+  size_t asciiPrefix (const char* data, size_t size) {
+    size_t i = 0;
+    while (i + 8 <= size && (load64 (data + i) & kHighBits) == 0)
+      i += 8;
+    while (i < size && static_cast<unsigned char> (data[i]) < 0x80)
+      ++i;
+    return i;
+  }
+
+  char lower (char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char> (c - 'A' + 'a') : c;
+  }
+
+  // Case-insensitive search, the needle must be lower case
+  size_t findNoCase (std::string_view haystack, std::string_view needle, size_t from = 0) {
+    if (needle.size () > haystack.size ())
+      return std::string_view::npos;
+    for (size_t i = from; i + needle.size () <= haystack.size (); ++i) {
+      size_t j = 0;
+      while (j < needle.size () && lower (haystack[i + j]) == needle[j])
+        ++j;
+      if (j == needle.size ())
+        return i;
+    }
+    return std::string_view::npos;
+  }
+
+  std::string_view trimValue (std::string_view value) {
+    while (!value.empty () && (value.front () == ' ' || value.front () == '"'
+                               || value.front () == '\'' || value.front () == '\t'))
+      value.remove_prefix (1);
+    size_t end = 0;
+    while (end < value.size () && value[end] != '"' && value[end] != '\'' && value[end] != ';'
+           && value[end] != ' ' && value[end] != '\t' && value[end] != '?')
+      ++end;
+    return value.substr (0, end);
+  }
+
+} // namespace
+
+namespace Charset {
+
+  Encoding fromName (std::string_view name) {
+    std::string label;
+    label.reserve (name.size ());
+    for (char c : name) {
+      if (c != '-' && c != '_' && c != ' ')
+        label.push_back (lower (c));
+    }
+    if (label.empty ())
+      return Encoding::Unknown;
+    if (label == "utf8" || label == "usascii" || label == "ascii" || label == "unicode11utf8")
+      return Encoding::Utf8;
+    if (label == "windows1250" || label == "cp1250" || label == "xcp1250")
+      return Encoding::Windows1250;
+    if (label == "iso88592" || label == "latin2" || label == "l2" || label == "isoir101"
+        || label == "csisolatin2")
+      return Encoding::Iso8859_2;
+    if (label == "windows1252" || label == "cp1252" || label == "xcp1252")
+      return Encoding::Windows1252;
+    if (label == "iso88591" || label == "latin1" || label == "l1" || label == "csisolatin1")
+      return Encoding::Iso8859_1;
+    return Encoding::Unknown;
+  }
+
+  const char* toName (Encoding encoding) {
+    switch (encoding) {
+    case Encoding::Utf8:
+      return "UTF-8";
+    case Encoding::Windows1250:
+      return "windows-1250";
+    case Encoding::Iso8859_2:
+      return "ISO-8859-2";
+    case Encoding::Windows1252:
+      return "windows-1252";
+    case Encoding::Iso8859_1:
+      return "ISO-8859-1";
+    default:
+      return "unknown";
+    }
+  }
+
+  std::string_view charsetFromContentType (std::string_view contentType) {
+    size_t pos = findNoCase (contentType, "charset=");
+    if (pos == std::string_view::npos)
+      return {};
+    return trimValue (contentType.substr (pos + 8));
+  }
+
+  std::string_view charsetFromXmlDeclaration (std::string_view data) {
+    // skip BOM and leading whitespace
+    if (data.size () >= 3 && data.substr (0, 3) == "\xEF\xBB\xBF")
+      data.remove_prefix (3);
+    size_t start = data.find_first_not_of (" \t\r\n");
+    if (start == std::string_view::npos || data.substr (start, 5) != "<?xml")
+      return {};
+    size_t end = data.find ("?>", start);
+    if (end == std::string_view::npos)
+      return {};
+    std::string_view decl = data.substr (start, end - start);
+    size_t pos = findNoCase (decl, "encoding");
+    if (pos == std::string_view::npos)
+      return {};
+    size_t eq = decl.find ('=', pos);
+    if (eq == std::string_view::npos)
+      return {};
+    return trimValue (decl.substr (eq + 1));
+  }
+
+  bool isAscii (std::string_view data) {
+    return asciiPrefix (data.data (), data.size ()) == data.size ();
+  }
+
+  bool isValidUtf8 (std::string_view data) {
+    const char* p = data.data ();
+    size_t size = data.size ();
+    size_t i = 0;
+    while (i < size) {
+      i += asciiPrefix (p + i, size - i);
+      if (i >= size)
+        break;
+      unsigned char c = static_cast<unsigned char> (p[i]);
+      size_t len;
+      uint32_t cp;
+      if (c >= 0xC2 && c <= 0xDF) {
+        len = 2;
+        cp = c & 0x1F;
+      } else if (c >= 0xE0 && c <= 0xEF) {
+        len = 3;
+        cp = c & 0x0F;
+      } else if (c >= 0xF0 && c <= 0xF4) {
+        len = 4;
+        cp = c & 0x07;
+      } else {
+        return false;
+      }
+      if (i + len > size)
+        return false;
+      for (size_t k = 1; k < len; ++k) {
+        unsigned char cc = static_cast<unsigned char> (p[i + k]);
+        if ((cc & 0xC0) != 0x80)
+          return false;
+        cp = (cp << 6) | (cc & 0x3F);
+      }
+      // overlong, surrogate or out of range sequences
+      if ((len == 3 && (cp < 0x800 || (cp >= 0xD800 && cp <= 0xDFFF)))
+          || (len == 4 && (cp < 0x10000 || cp > 0x10FFFF)))
+        return false;
+      i += len;
+    }
+    return true;
+  }
+
+  Encoding detect (std::string_view data, std::string_view contentType) {
+    if (data.size () >= 3 && data.substr (0, 3) == "\xEF\xBB\xBF")
+      return Encoding::Utf8;
+
+    Encoding declared = fromName (charsetFromXmlDeclaration (data));
+    Encoding encoding = fromName (charsetFromContentType (contentType));
+    if (encoding == Encoding::Unknown)
+      encoding = declared;
+
+    if (encoding == Encoding::Unknown || encoding == Encoding::Utf8) {
+      if (isValidUtf8 (data))
+        return Encoding::Utf8;
+      // Mislabelled (or unlabelled) legacy payload - most of our sources are Czech/Slovak
+      return (declared != Encoding::Unknown && declared != Encoding::Utf8)
+                 ? declared
+                 : Encoding::Windows1250;
+    }
+    return encoding;
+  }
+
+  std::string transcodeToUtf8 (std::string_view data, Encoding encoding) {
+    const ExpansionTable* table = tableFor (encoding);
+    if (!table)
+      return std::string (data);
+
+    const char* in = data.data ();
+    const size_t size = data.size ();
+    std::string out;
+    out.resize (size * 3); // worst case, every byte expands to a 3 byte sequence
+    char* dst = out.data ();
+
+    size_t i = 0;
+    while (i < size) {
+      // bulk copy ASCII words
+      while (i + 8 <= size) {
+        uint64_t word = load64 (in + i);
+        if (word & kHighBits)
+          break;
+        std::memcpy (dst, &word, sizeof (word));
+        dst += 8;
+        i += 8;
+      }
+      if (i >= size)
+        break;
+      const Utf8Seq& seq = (*table)[static_cast<unsigned char> (in[i])];
+      // copying all three bytes unconditionally keeps the hot loop branch free
+      std::memcpy (dst, seq.bytes, 3);
+      dst += seq.len;
+      ++i;
+    }
+    out.resize (static_cast<size_t> (dst - out.data ()));
+    return out;
+  }
+
+  Encoding ensureUtf8 (std::string& data, std::string_view contentType) {
+    Encoding encoding = detect (data, contentType);
+    if (tableFor (encoding)) {
+      data = transcodeToUtf8 (data, encoding);
+    }
+    return encoding;
+  }
+
+} // namespace Charset
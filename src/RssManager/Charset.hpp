@@ -0,0 +1,41 @@
+#ifndef __CHARSET_H__
+#define __CHARSET_H__
+
+#include <string>
+#include <string_view>
+
+// Minimal charset handling for RSS/Atom payloads.
+// tinyxml2 expects UTF-8, but several Czech/Slovak sources still serve windows-1250 or
+// ISO-8859-2. Single-byte codepages are expanded through a 256 entry table, ASCII runs are
+// skipped/copied 8 bytes at a time, and UTF-8 input is never copied.
+
+namespace Charset {
+
+  enum class Encoding { Unknown, Utf8, Windows1250, Iso8859_2, Windows1252, Iso8859_1 };
+
+  // Map an IANA charset label ("windows-1250", "ISO-8859-2", "latin2", ...) to an Encoding.
+  Encoding fromName (std::string_view name);
+  const char* toName (Encoding encoding);
+
+  // charset="..." parameter of a Content-Type header, empty if missing
+  std::string_view charsetFromContentType (std::string_view contentType);
+  // encoding="..." pseudo-attribute of the <?xml ...?> declaration, empty if missing
+  std::string_view charsetFromXmlDeclaration (std::string_view data);
+
+  // BOM > Content-Type charset > XML declaration > UTF-8 validity heuristic.
+  // A declared UTF-8 that does not validate falls back to the XML declaration or windows-1250.
+  Encoding detect (std::string_view data, std::string_view contentType = {});
+
+  bool isAscii (std::string_view data);
+  bool isValidUtf8 (std::string_view data);
+
+  // Convert a single-byte codepage to UTF-8. Utf8/Unknown input is returned unchanged.
+  std::string transcodeToUtf8 (std::string_view data, Encoding encoding);
+
+  // Detect and convert in place. The buffer is left untouched (no copy) when it already is
+  // UTF-8. Returns the detected source encoding.
+  Encoding ensureUtf8 (std::string& data, std::string_view contentType = {});
+
+} // namespace Charset
+
+#endif // __CHARSET_H__
@@ -0,0 +1,117 @@
+#ifndef __FAIRQUEUE_H__
+#define __FAIRQUEUE_H__
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+// Deficit round robin over per-source FIFO sub-queues.
+// Every item costs one unit; a source with weight w is served up to w items per round, so a
+// feed that dumps 50 items at once cannot delay a quiet source by more than one round.
+
+template <typename T> class FairQueue {
+public:
+  void setWeight (const std::string& source, unsigned weight) {
+    queues_[source].weight = weight == 0 ? 1 : weight;
+  }
+
+  unsigned getWeight (const std::string& source) const {
+    auto it = queues_.find (source);
+    return it != queues_.end () ? it->second.weight : 1;
+  }
+
+  void push (const std::string& source, T item) {
+    SubQueue& queue = queues_[source];
+    if (queue.items.empty ())
+      active_.push_back (source);
+    queue.items.push_back (std::move (item));
+    ++size_;
+  }
+
+  // Next item in DRR order
+  std::optional<T> pop () {
+    return pop ([] (const T&) { return true; });
+  }
+
+  // Next item accepted by the filter, sources without a matching item are skipped this round
+  std::optional<T> pop (const std::function<bool (const T&)>& filter) {
+    for (size_t visited = 0; visited < active_.size (); ++visited) {
+      SubQueue& queue = queues_[active_.front ()];
+
+      auto match = queue.items.begin ();
+      while (match != queue.items.end () && !filter (*match))
+        ++match;
+      if (match == queue.items.end ()) {
+        rotate (queue);
+        continue;
+      }
+
+      if (queue.deficit == 0) // a new turn starts
+        queue.deficit = queue.weight;
+
+      T item = std::move (*match);
+      queue.items.erase (match);
+      --size_;
+      --queue.deficit;
+
+      if (queue.items.empty ()) {
+        queue.deficit = 0;
+        active_.pop_front ();
+      } else if (queue.deficit == 0) {
+        active_.push_back (active_.front ());
+        active_.pop_front ();
+      }
+      return item;
+    }
+    return std::nullopt;
+  }
+
+  size_t size () const {
+    return size_;
+  }
+  bool empty () const {
+    return size_ == 0;
+  }
+  size_t size (const std::string& source) const {
+    auto it = queues_.find (source);
+    return it != queues_.end () ? it->second.items.size () : 0;
+  }
+
+  template <typename F> void forEach (F&& fn) const {
+    for (const auto& entry : queues_)
+      for (const auto& item : entry.second.items)
+        fn (item);
+  }
+
+  void clear () {
+    for (auto& entry : queues_) {
+      entry.second.items.clear ();
+      entry.second.deficit = 0;
+    }
+    active_.clear ();
+    size_ = 0;
+  }
+
+private:
+  struct SubQueue {
+    std::deque<T> items;
+    unsigned weight = 1;
+    unsigned deficit = 0;
+  };
+
+  // A source with nothing eligible gives up the rest of its turn
+  void rotate (SubQueue& queue) {
+    queue.deficit = 0;
+    active_.push_back (active_.front ());
+    active_.pop_front ();
+  }
+
+  std::unordered_map<std::string, SubQueue> queues_;
+  std::deque<std::string> active_; // non-empty sources in round-robin order
+  size_t size_ = 0;
+};
+
+#endif // __FAIRQUEUE_H__
@@ -0,0 +1,169 @@
+#include "KeywordRouter.hpp"
+#include <algorithm>
+#include <deque>
+
+namespace {
+  inline unsigned char fold (unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char> (c + ('a' - 'A')) : c;
+  }
+
+  std::vector<std::string> stringList (const nlohmann::json& json, const char* key) {
+    std::vector<std::string> out;
+    if (json.contains (key) && json[key].is_array ()) {
+      for (const auto& value : json[key]) {
+        if (value.is_string () && !value.get<std::string> ().empty ())
+          out.push_back (value.get<std::string> ());
+      }
+    }
+    return out;
+  }
+}
+
+bool RouteMatch::accepts (uint64_t channelId) const {
+  return std::find (rejected.begin (), rejected.end (), channelId) == rejected.end ();
+}
+
+std::vector<ChannelRules> KeywordRouter::rulesFromJson (const nlohmann::json& json) {
+  std::vector<ChannelRules> rules;
+  if (!json.is_object () || !json.contains ("channels") || !json["channels"].is_array ())
+    return rules;
+
+  for (const auto& channel : json["channels"]) {
+    if (!channel.is_object () || !channel.contains ("channelId"))
+      continue;
+    ChannelRules rule;
+    rule.channelId = channel["channelId"].get<uint64_t> ();
+    rule.embedded = channel.value ("embedded", false);
+    rule.include = stringList (channel, "include");
+    rule.exclude = stringList (channel, "exclude");
+    rule.route = stringList (channel, "route");
+    rules.push_back (std::move (rule));
+  }
+  return rules;
+}
+
+int32_t KeywordRouter::addState () {
+  next_.resize (next_.size () + classCount_, -1);
+  outputs_.emplace_back ();
+  outputLink_.push_back (-1);
+  return static_cast<int32_t> (outputs_.size () - 1);
+}
+
+std::shared_ptr<const KeywordRouter>
+KeywordRouter::compile (const std::vector<ChannelRules>& rules) {
+  std::shared_ptr<KeywordRouter> router (new KeywordRouter ());
+  router->rules_ = rules;
+
+  std::vector<std::pair<std::string, Target>> keywords;
+  for (uint32_t channel = 0; channel < rules.size (); ++channel) {
+    auto collect = [&] (const std::vector<std::string>& list, Flag flag) {
+      for (const auto& keyword : list) {
+        std::string folded;
+        for (unsigned char c : keyword)
+          folded += static_cast<char> (fold (c));
+        keywords.push_back ({ folded, Target{ channel, flag } });
+      }
+    };
+    collect (rules[channel].include, Include);
+    collect (rules[channel].exclude, Exclude);
+    collect (rules[channel].route, Route);
+  }
+
+  // Only bytes that occur in some keyword get their own column
+  for (const auto& keyword : keywords) {
+    for (unsigned char c : keyword.first) {
+      if (router->byteClass_[c] == 0)
+        router->byteClass_[c] = router->classCount_++;
+    }
+  }
+  for (int c = 'A'; c <= 'Z'; ++c)
+    router->byteClass_[c] = router->byteClass_[fold (static_cast<unsigned char> (c))];
+
+  // Trie
+  router->addState ();
+  for (const auto& [keyword, target] : keywords) {
+    int32_t state = 0;
+    for (unsigned char c : keyword) {
+      size_t slot = static_cast<size_t> (state) * router->classCount_ + router->byteClass_[c];
+      if (router->next_[slot] < 0) {
+        int32_t added = router->addState ();
+        router->next_[slot] = added;
+      }
+      state = router->next_[slot];
+    }
+    router->outputs_[state].push_back (target);
+  }
+
+  // Breadth-first failure links, folded into the table so matching never backtracks
+  std::vector<int32_t> fail (router->outputs_.size (), 0);
+  std::deque<int32_t> queue;
+  for (uint16_t c = 0; c < router->classCount_; ++c) {
+    int32_t& child = router->next_[c];
+    if (child < 0) {
+      child = 0;
+    } else {
+      fail[child] = 0;
+      queue.push_back (child);
+    }
+  }
+  while (!queue.empty ()) {
+    int32_t state = queue.front ();
+    queue.pop_front ();
+    int32_t suffix = fail[state];
+    router->outputLink_[state]
+        = !router->outputs_[suffix].empty () ? suffix : router->outputLink_[suffix];
+
+    for (uint16_t c = 0; c < router->classCount_; ++c) {
+      size_t slot = static_cast<size_t> (state) * router->classCount_ + c;
+      int32_t fallback = router->next_[static_cast<size_t> (suffix) * router->classCount_ + c];
+      if (router->next_[slot] < 0) {
+        router->next_[slot] = fallback;
+      } else {
+        fail[router->next_[slot]] = fallback;
+        queue.push_back (router->next_[slot]);
+      }
+    }
+  }
+  return router;
+}
+
+void KeywordRouter::scan (std::string_view text, std::vector<uint8_t>& flags) const {
+  int32_t state = 0;
+  for (unsigned char c : text) {
+    state = next_[static_cast<size_t> (state) * classCount_ + byteClass_[c]];
+    for (int32_t hit = outputs_[state].empty () ? outputLink_[state] : state; hit >= 0;
+         hit = outputLink_[hit]) {
+      for (const Target& target : outputs_[hit])
+        flags[target.channel] |= target.flag;
+    }
+  }
+}
+
+RouteMatch KeywordRouter::match (std::string_view title, std::string_view description) const {
+  RouteMatch result;
+  if (rules_.empty ())
+    return result;
+
+  std::vector<uint8_t> flags (rules_.size (), 0);
+  scan (title, flags);
+  scan (description, flags);
+
+  for (size_t channel = 0; channel < rules_.size (); ++channel) {
+    const ChannelRules& rule = rules_[channel];
+    bool excluded = flags[channel] & Exclude;
+    if (excluded || (!rule.include.empty () && !(flags[channel] & Include)))
+      result.rejected.push_back (rule.channelId);
+    if (!excluded && (flags[channel] & Route))
+      result.routed.push_back (rule.channelId);
+  }
+  return result;
+}
+
+std::vector<uint64_t> KeywordRouter::getRouteChannels () const {
+  std::vector<uint64_t> channels;
+  for (const auto& rule : rules_) {
+    if (!rule.route.empty ())
+      channels.push_back (rule.channelId);
+  }
+  return channels;
+}
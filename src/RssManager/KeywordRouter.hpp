@@ -0,0 +1,76 @@
+#ifndef __KEYWORDROUTER_H__
+#define __KEYWORDROUTER_H__
+
+#include <nlohmann/json.hpp>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Per-channel keyword routing of feed items.
+// Every keyword of every channel is compiled into one Aho-Corasick automaton with a dense,
+// alphabet-compressed transition table, so an item is scanned once no matter how many rules
+// exist. Matching is case-insensitive for ASCII and works on raw UTF-8 bytes otherwise.
+//
+// include - the channel only receives items from its subscriptions matching one of these
+// exclude - the channel never receives items matching one of these
+// route   - items from any source matching one of these are delivered to the channel too
+
+struct ChannelRules {
+  uint64_t channelId = 0;
+  bool embedded = false; // format of items routed into the channel
+  std::vector<std::string> include;
+  std::vector<std::string> exclude;
+  std::vector<std::string> route;
+};
+
+struct RouteMatch {
+  std::vector<uint64_t> rejected; // channels whose include/exclude rules drop the item
+  std::vector<uint64_t> routed;   // topic channels the item is routed into
+  bool accepts (uint64_t channelId) const;
+};
+
+class KeywordRouter {
+public:
+  /**
+   * @brief Compile rule sets into a shared, immutable router.
+   * @note Readers keep using the previous router until the new one is swapped in.
+   */
+  static std::shared_ptr<const KeywordRouter> compile (const std::vector<ChannelRules>& rules);
+
+  // routingRules.json: {"channels": [{"channelId": 1, "include": [...], ...}]}
+  static std::vector<ChannelRules> rulesFromJson (const nlohmann::json& json);
+
+  RouteMatch match (std::string_view title, std::string_view description) const;
+
+  const std::vector<ChannelRules>& getRules () const {
+    return rules_;
+  }
+  // Channels that may receive items through route rules
+  std::vector<uint64_t> getRouteChannels () const;
+  size_t getStateCount () const {
+    return outputs_.size ();
+  }
+
+private:
+  enum Flag : uint8_t { Include = 1, Exclude = 2, Route = 4 };
+  struct Target {
+    uint32_t channel; // index into rules_
+    Flag flag;
+  };
+
+  KeywordRouter () = default;
+  int32_t addState ();
+  void scan (std::string_view text, std::vector<uint8_t>& flags) const;
+
+  std::vector<ChannelRules> rules_;
+  std::array<uint16_t, 256> byteClass_{}; // 0 = byte not used by any keyword
+  uint16_t classCount_ = 1;
+  std::vector<int32_t> next_;                // state * classCount_ + class -> state
+  std::vector<std::vector<Target>> outputs_; // targets of keywords ending in the state
+  std::vector<int32_t> outputLink_;          // nearest suffix state with outputs, -1 if none
+};
+
+#endif // __KEYWORDROUTER_H__
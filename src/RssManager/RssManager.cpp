@@ -1,9 +1,12 @@
 #include "RssManager.hpp"
+#include "Charset.hpp"
 #include <Logger/Logger.hpp>
 #include <curl/curl.h>
 #include <fstream>
-#include <random>
 #include <regex>
+#include <algorithm>
+#include <cctype>
+#include <set>
 
 // CURL callback
 size_t WriteCallback (void* contents, size_t size, size_t nmemb, void* userp) {
@@ -11,10 +14,16 @@ size_t WriteCallback (void* contents, size_t size, size_t nmemb, void* userp) {
   return size * nmemb;
 }
 
+// Non-zero aborts the transfer, clientp is the manager's fetch stop flag
+int AbortCallback (void* clientp, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+  return static_cast<std::atomic<bool>*> (clientp)->load () ? 1 : 0;
+}
+
 // RSSItem Struct Implementation
 RSSItem::RSSItem (const std::string& t, const std::string& l, const std::string& d,
                   const std::string& date = "", bool e = false, uint64_t dChId = 0)
-    : title (t), link (l), description (d), pubDate (date), embedded (e), discordChannelId (dChId) {
+    : title (t), link (l), description (d), pubDate (date), embedded (e), discordChannelId (dChId),
+      queuedAt (0), deliveryId (0), attempts (0) {
   generateHash ();
 }
 void RSSItem::generateHash () {
@@ -37,7 +46,7 @@ void RSSFeed::clear () {
 }
 
 // RssManager Class Implementation
-RssManager::RssManager () : rng_ (std::random_device{}()) {
+RssManager::RssManager () : router_ (KeywordRouter::compile ({})) {
 }
 int RssManager::initialize () {
 
@@ -59,6 +68,17 @@ int RssManager::initialize () {
     LOG_I_STREAM << "Created default RSS URLs file at: " << getUrlsPath () << std::endl;
   }
 
+  // A new instance starts from the shared seen hashes, its channels were posted to before
+  std::filesystem::path sharedHashes = AssetContext::getAssetsPath () / "seenHashes.json";
+  if (!instanceName_.empty () && !std::filesystem::exists (getHashesPath ())
+      && std::filesystem::exists (sharedHashes)) {
+    std::error_code ec;
+    std::filesystem::copy_file (sharedHashes, getHashesPath (), ec);
+    if (!ec) {
+      LOG_I_STREAM << "Seeded " << getHashesPath () << " from " << sharedHashes << std::endl;
+    }
+  }
+
   if (!std::filesystem::exists (getHashesPath ())) {
     nlohmann::json defaultHashes = nlohmann::json::array ();
     std::ofstream file (getHashesPath ());
@@ -75,28 +95,135 @@ int RssManager::initialize () {
   if (std::filesystem::exists (getHashesPath ())) {
     hashesLastModified_ = std::filesystem::last_write_time (getHashesPath ());
   }
+  if (std::filesystem::exists (getRoutingRulesPath ())) {
+    routingRulesLastModified_ = std::filesystem::last_write_time (getRoutingRulesPath ());
+  }
+
+  // Search is optional, the bot keeps posting without it
+  if (searchIndex_.open (getSearchIndexPath ()) != 0) {
+    LOG_W_STREAM << "Search index unavailable, /search is disabled." << std::endl;
+  }
+  if (archive_.open (getArchivePath ()) != 0) {
+    LOG_W_STREAM << "Delivery archive unavailable, /recent is disabled." << std::endl;
+  }
 
-  return loadUrls () == 0 && loadSeenHashes () == 0 ? 0 : -1;
+  int result = loadUrls () == 0 && loadSeenHashes () == 0 && loadRoutingRules () == 0 ? 0 : -1;
+  if (outbox_.open (getOutboxPath ()) != 0) {
+    LOG_W_STREAM << "Delivery outbox unavailable, items are marked seen when posted." << std::endl;
+  } else {
+    recoverDeliveries ();
+  }
+  return result;
 }
 
 int RssManager::addUrl (const std::string& url, bool embedded, uint64_t discordChannelId) {
-  // Check if URL already exists
-  for (const auto& existingUrl : urls_) {
-    if (existingUrl.url == url) {
-      LOG_W_STREAM << "URL already exists: " << url << std::endl;
-      return -1; // URL already exists
+  std::lock_guard<std::mutex> lock (mutex_);
+  // The same feed may be subscribed by any number of channels, but only once per channel
+  std::string feedKey = canonicalUrl (url);
+  for (const auto& subscriber : subscribersOf (feedKey)) {
+    if (subscriber.discordChannelId == discordChannelId) {
+      LOG_W_STREAM << "Channel " << discordChannelId << " already subscribes to: " << url
+                   << std::endl;
+      return -1;
     }
   }
   urls_.emplace_back (url, embedded, discordChannelId);
+  sourcesRevision_++;
+  lanes_[discordChannelId].setWeight (subscriptionKey (feedKey, discordChannelId),
+                                      urls_.back ().weight);
   return saveUrls ();
 }
 
+int RssManager::removeUrl (const std::string& url, uint64_t discordChannelId) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  std::string feedKey = canonicalUrl (url);
+  auto it = std::find_if (urls_.begin (), urls_.end (), [&] (const RSSUrl& subscription) {
+    return subscription.discordChannelId == discordChannelId
+           && canonicalUrl (subscription.url) == feedKey;
+  });
+  if (it == urls_.end ())
+    return -1;
+  urls_.erase (it);
+  sourcesRevision_++;
+  return saveUrls ();
+}
+
+std::string RssManager::canonicalUrl (const std::string& url) {
+  size_t first = url.find_first_not_of (" \t\r\n");
+  if (first == std::string::npos)
+    return "";
+  size_t last = url.find_last_not_of (" \t\r\n");
+  std::string result = url.substr (first, last - first + 1);
+
+  size_t fragment = result.find ('#');
+  if (fragment != std::string::npos)
+    result.erase (fragment);
+
+  // scheme and host are case-insensitive, the path is not
+  size_t hostEnd = 0;
+  size_t schemeEnd = result.find ("://");
+  if (schemeEnd != std::string::npos) {
+    hostEnd = result.find_first_of ("/?", schemeEnd + 3);
+    if (hostEnd == std::string::npos)
+      hostEnd = result.size ();
+    std::transform (result.begin (), result.begin () + hostEnd, result.begin (),
+                    [] (unsigned char c) { return static_cast<char> (std::tolower (c)); });
+  }
+
+  if (result.size () > hostEnd && result.back () == '/'
+      && result.find ('?') == std::string::npos)
+    result.pop_back ();
+  return result;
+}
+
+std::vector<RSSUrl> RssManager::subscribersOf (const std::string& feedKey) const {
+  std::vector<RSSUrl> subscribers;
+  for (const auto& subscription : urls_) {
+    if (canonicalUrl (subscription.url) == feedKey) {
+      subscribers.push_back (subscription);
+    }
+  }
+  return subscribers;
+}
+
+void RssManager::setChannelFilter (std::function<bool (uint64_t channelId)> owns) {
+  channelFilter_ = std::move (owns);
+}
+
+bool RssManager::ownsChannel (uint64_t channelId) const {
+  return !channelFilter_ || channelFilter_ (channelId);
+}
+
+void RssManager::setInstanceName (const std::string& name) {
+  instanceName_ = name;
+}
+
+std::filesystem::path RssManager::instancePath (const std::string& stem,
+                                                const std::string& extension) const {
+  std::string name = instanceName_.empty () ? stem : stem + "." + instanceName_;
+  return AssetContext::getAssetsPath () / (name + extension);
+}
+
+std::string RssManager::seenKey (uint64_t discordChannelId, const std::string& hash) {
+  return std::to_string (discordChannelId) + "/" + hash;
+}
+
+std::string RssManager::subscriptionKey (const std::string& feedKey, uint64_t discordChannelId) {
+  return feedKey + "#" + std::to_string (discordChannelId);
+}
+
+bool RssManager::isSeen (uint64_t discordChannelId, const std::string& hash) const {
+  // Plain hashes were written when every feed had a single channel, they count for all of them
+  return seenHashes_.count (hash) > 0 || seenHashes_.count (seenKey (discordChannelId, hash)) > 0;
+}
+
 int RssManager::saveUrls () {
   nlohmann::json jsonData = nlohmann::json::array ();
   for (const auto& url : urls_) {
     jsonData.push_back ({ { "url", url.url },
                           { "embedded", url.embedded },
-                          { "discordChannelId", url.discordChannelId } });
+                          { "discordChannelId", url.discordChannelId },
+                          { "weight", url.weight } });
   }
   std::ofstream file (getUrlsPath ());
   if (!file.is_open ())
@@ -106,18 +233,59 @@ int RssManager::saveUrls () {
 }
 
 std::string RssManager::getSourcesAsList () {
+  std::lock_guard<std::mutex> lock (mutex_);
+  auto describe = [] (const RSSUrl& url) {
+    std::string text = url.embedded ? " (embedded)" : " (non-embedded)";
+    if (url.weight != 1) {
+      text += " [Weight: " + std::to_string (url.weight) + "]";
+    }
+    if (url.discordChannelId != 0) {
+      text += " [Channel: " + std::to_string (url.discordChannelId) + "]";
+    }
+    return text;
+  };
+
   std::string sourcesList;
-  sourcesList = "";
+  std::unordered_set<std::string> listed;
   for (const auto& url : urls_) {
-    sourcesList += "- " + url.url + (url.embedded ? " (embedded)" : " (non-embedded)");
-    if (url.discordChannelId != 0) {
-      sourcesList += " [Channel: " + std::to_string (url.discordChannelId) + "]";
+    std::string feedKey = canonicalUrl (url.url);
+    if (!listed.insert (feedKey).second)
+      continue;
+
+    std::vector<RSSUrl> subscribers = subscribersOf (feedKey);
+    sourcesList += "- " + url.url;
+    if (subscribers.size () == 1) {
+      sourcesList += describe (url);
+    }
+    if (webSub_ && webSub_->isRunning ()) {
+      auto topic = webSubTopics_.find (feedKey);
+      if (topic != webSubTopics_.end () && webSub_->isActive (topic->second)) {
+        sourcesList += " [WebSub]";
+      }
     }
     sourcesList += "\n";
+    if (subscribers.size () > 1) {
+      for (const auto& subscriber : subscribers) {
+        sourcesList += "  -" + describe (subscriber) + "\n";
+      }
+    }
   }
   return sourcesList.empty () ? "No RSS sources available." : sourcesList;
 }
 
+std::string RssManager::getSourcesRevision () const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  // The listing marks feeds with an active WebSub subscription
+  size_t pushed = 0;
+  if (webSub_ && webSub_->isRunning ()) {
+    for (const auto& [feedKey, topic] : webSubTopics_) {
+      if (webSub_->isActive (topic))
+        pushed++;
+    }
+  }
+  return std::to_string (sourcesRevision_) + "/" + std::to_string (pushed);
+}
+
 int RssManager::loadUrls () {
   std::ifstream file (getUrlsPath ());
   if (!file.is_open ())
@@ -126,7 +294,9 @@ int RssManager::loadUrls () {
   nlohmann::json jsonData;
   file >> jsonData;
 
+  std::lock_guard<std::mutex> lock (mutex_);
   urls_.clear ();
+  sourcesRevision_++;
   for (const auto& item : jsonData) {
     if (item.is_object () && item.contains ("url")) {
       std::string url = item["url"].get<std::string> ();
@@ -135,7 +305,24 @@ int RssManager::loadUrls () {
       if (item.contains ("discordChannelId") && !item["discordChannelId"].is_null ()) {
         discordChannelId = item["discordChannelId"].get<uint64_t> ();
       }
-      urls_.emplace_back (url, embedded, discordChannelId);
+      unsigned weight = 1;
+      if (item.contains ("weight")) {
+        // Hand-edited file: a string, a negative or a zero weight must not abort the load
+        const auto& value = item["weight"];
+        if (!value.is_number_unsigned () || value.get<uint64_t> () == 0) {
+          LOG_W_STREAM << "Invalid weight " << value.dump () << " for " << url << ", using 1"
+                       << std::endl;
+        } else if (value.get<uint64_t> () > MAX_SOURCE_WEIGHT) {
+          LOG_W_STREAM << "Weight " << value.dump () << " for " << url << " clamped to "
+                       << MAX_SOURCE_WEIGHT << std::endl;
+          weight = MAX_SOURCE_WEIGHT;
+        } else {
+          weight = value.get<unsigned> ();
+        }
+      }
+      urls_.emplace_back (url, embedded, discordChannelId, weight);
+      lanes_[discordChannelId].setWeight (subscriptionKey (canonicalUrl (url), discordChannelId),
+                                          weight);
     } else if (item.is_string ()) {
       // Backwards compatibility - treat strings as non-embedded
       urls_.emplace_back (item.get<std::string> (), false);
@@ -156,6 +343,7 @@ int RssManager::loadSeenHashes () {
     file >> jsonData;
   } catch (const std::exception& e) {
     LOG_E_STREAM << "Hashes file corrupted: " << e.what () << ". Creating new file." << std::endl;
+    std::lock_guard<std::mutex> lock (mutex_);
     seenHashes_.clear ();
     std::ofstream outFile (getHashesPath ());
     if (!outFile.is_open ())
@@ -164,6 +352,7 @@ int RssManager::loadSeenHashes () {
     return 0;
   }
 
+  std::lock_guard<std::mutex> lock (mutex_);
   seenHashes_.clear ();
   for (const auto& hash : jsonData) {
     if (hash.is_string ()) {
@@ -177,7 +366,10 @@ int RssManager::loadSeenHashes () {
 
 int RssManager::saveSeenHash (const std::string& hash) {
   seenHashes_.insert (hash);
+  return writeSeenHashes ();
+}
 
+int RssManager::writeSeenHashes () {
   nlohmann::json jsonData = nlohmann::json::array ();
   for (const auto& h : seenHashes_) {
     jsonData.push_back (h);
@@ -190,7 +382,7 @@ int RssManager::saveSeenHash (const std::string& hash) {
   return 0;
 }
 
-std::string RssManager::downloadFeed (const std::string& url) {
+std::string RssManager::downloadFeed (const std::string& url, std::string* contentType) {
   std::string buffer = "";
   try {
     CURL* curl = curl_easy_init ();
@@ -205,6 +397,9 @@ std::string RssManager::downloadFeed (const std::string& url) {
     curl_easy_setopt (curl, CURLOPT_URL, url.c_str ());
     curl_easy_setopt (curl, CURLOPT_WRITEFUNCTION, WriteCallback);
     curl_easy_setopt (curl, CURLOPT_WRITEDATA, &buffer);
+    curl_easy_setopt (curl, CURLOPT_XFERINFOFUNCTION, AbortCallback);
+    curl_easy_setopt (curl, CURLOPT_XFERINFODATA, &fetchStopped_);
+    curl_easy_setopt (curl, CURLOPT_NOPROGRESS, 0L);
     curl_easy_setopt (curl, CURLOPT_FOLLOWLOCATION, 1L);
     curl_easy_setopt (curl, CURLOPT_SSL_VERIFYPEER, 0L);
     curl_easy_setopt (curl, CURLOPT_SSL_VERIFYHOST, 0L);
@@ -223,6 +418,14 @@ std::string RssManager::downloadFeed (const std::string& url) {
 
     CURLcode res = curl_easy_perform (curl);
 
+    // Content-Type carries the charset for feeds without an XML declaration
+    if (res == CURLE_OK && contentType) {
+      char* type = nullptr;
+      if (curl_easy_getinfo (curl, CURLINFO_CONTENT_TYPE, &type) == CURLE_OK && type) {
+        *contentType = type;
+      }
+    }
+
     // Clean up headers
     curl_slist_free_all (headers);
     curl_easy_cleanup (curl);
@@ -240,8 +443,8 @@ std::string RssManager::downloadFeed (const std::string& url) {
   return buffer;
 }
 
-RSSFeed RssManager::parseRSS (const std::string& xmlData, bool embedded,
-                              uint64_t discordChannelId) {
+RSSFeed RssManager::parseRSS (const std::string& xmlData,
+                              const std::function<bool (const std::string& hash)>& isSeen) {
   RSSFeed feed;
   tinyxml2::XMLDocument doc;
   doc.Parse (xmlData.c_str ());
@@ -256,21 +459,25 @@ RSSFeed RssManager::parseRSS (const std::string& xmlData, bool embedded,
     if (channel) {
       firstItem = channel->FirstChildElement ("item");
     }
+    feed.format = "RSS 2.0";
   }
   // Try RSS 1.0 format
   else if (auto rdfElement = doc.FirstChildElement ("rdf:RDF")) {
     channel = rdfElement->FirstChildElement ("channel");
     firstItem = rdfElement->FirstChildElement ("item");
+    feed.format = "RSS 1.0";
   }
   // Try Atom format
   else if (auto feedElement = doc.FirstChildElement ("feed")) {
     channel = feedElement;
     firstItem = feedElement->FirstChildElement ("entry");
     isAtom = true;
+    feed.format = "Atom";
   }
 
   if (!channel) {
     LOG_E_STREAM << "No valid RSS/Atom channel found." << std::endl;
+    feed.format.clear ();
     return feed;
   }
 
@@ -300,6 +507,23 @@ RSSFeed RssManager::parseRSS (const std::string& xmlData, bool embedded,
     }
   }
 
+  // WebSub discovery - <link rel="hub"> in Atom, <atom:link rel="hub"> in RSS
+  for (auto linkEl = channel->FirstChildElement (); linkEl;
+       linkEl = linkEl->NextSiblingElement ()) {
+    std::string name = linkEl->Name ();
+    if (name != "link" && (name.size () < 5 || name.compare (name.size () - 5, 5, ":link") != 0))
+      continue;
+    const char* rel = linkEl->Attribute ("rel");
+    const char* href = linkEl->Attribute ("href");
+    if (!rel || !href)
+      continue;
+    if (std::string (rel) == "hub" && feed.hubUrl.empty ()) {
+      feed.hubUrl = href;
+    } else if (std::string (rel) == "self" && feed.selfUrl.empty ()) {
+      feed.selfUrl = href;
+    }
+  }
+
   // Parse items
   int newItems = 0;
   int duplicateItems = 0;
@@ -307,8 +531,6 @@ RSSFeed RssManager::parseRSS (const std::string& xmlData, bool embedded,
 
   for (auto item = firstItem; item; item = item->NextSiblingElement (itemTag)) {
     RSSItem rssItem;
-    rssItem.embedded = embedded;
-    rssItem.discordChannelId = discordChannelId;
 
     if (isAtom) {
       // Parse Atom entry
@@ -368,12 +590,13 @@ RSSFeed RssManager::parseRSS (const std::string& xmlData, bool embedded,
 
     if (rssItem.title.empty () || rssItem.link.empty ())
       continue;
+    feed.totalItems++;
 
     // Generate hash from original, unprocessed data
     rssItem.generateHash ();
 
     // Skip if already seen
-    if (seenHashes_.find (rssItem.hash) != seenHashes_.end ()) {
+    if (isSeen (rssItem.hash)) {
       // LOG_D_STREAM << "Skipping duplicate item: " << rssItem.title << std::endl;
       duplicateItems++;
       continue;
@@ -394,52 +617,208 @@ RSSFeed RssManager::parseRSS (const std::string& xmlData, bool embedded,
   }
 
   LOG_I_STREAM << "Parsed " << newItems << " new items from " << (isAtom ? "Atom" : "RSS")
-               << " feed (embedded: " << (embedded ? "true" : "false") << "), skipped "
-               << duplicateItems << " duplicates." << std::endl;
+               << " feed, skipped " << duplicateItems << " duplicates." << std::endl;
   return feed;
 }
 
-int RssManager::fetchFeed (const std::string& url, bool embedded, uint64_t discordChannelId) {
-  LOG_I_STREAM << "Fetching feed: " << url << " (embedded: " << (embedded ? "true" : "false") << ")"
-               << std::endl;
+int RssManager::fetchFeed (const std::string& url) {
+  LOG_I_STREAM << "Fetching feed: " << url << std::endl;
 
-  std::string xmlData = downloadFeed (url);
+  std::string contentType;
+  std::string xmlData = downloadFeed (url, &contentType);
   if (xmlData.empty ())
     return -1;
 
-  RSSFeed newFeed = parseRSS (xmlData, embedded, discordChannelId);
+  return ingestFeed (url, std::move (xmlData), contentType);
+}
+
+FeedProbe RssManager::probeFeed (const std::string& url) {
+  LOG_I_STREAM << "Probing feed: " << url << std::endl;
+
+  FeedProbe probe;
+  std::string contentType;
+  std::string xmlData = downloadFeed (url, &contentType);
+  if (xmlData.empty ())
+    return probe;
+
+  probe.reachable = true;
+  probe.queuedItems = ingestFeed (url, std::move (xmlData), contentType, &probe);
+  return probe;
+}
 
-  // Create set of current hashes for fast lookup
-  std::unordered_set<std::string> currentHashes;
-  for (const auto& item : feed_.items) {
-    currentHashes.insert (item.hash);
+int RssManager::ingestFeed (const std::string& url, std::string xmlData,
+                            const std::string& contentType, FeedProbe* probe) {
+  std::string feedKey = canonicalUrl (url);
+  std::vector<RSSUrl> subscribers;
+  {
+    std::lock_guard<std::mutex> lock (mutex_);
+    subscribers = subscribersOf (feedKey);
+  }
+  if (subscribers.empty ()) {
+    LOG_W_STREAM << "No channel subscribes to feed: " << url << std::endl;
+    return 0;
+  }
+  // Other processes deliver to the remaining channels
+  subscribers.erase (std::remove_if (subscribers.begin (), subscribers.end (),
+                                     [this] (const RSSUrl& subscriber) {
+                                       return !ownsChannel (subscriber.discordChannelId);
+                                     }),
+                     subscribers.end ());
+
+  // tinyxml2 assumes UTF-8, legacy codepages are converted before parsing
+  Charset::Encoding encoding = Charset::ensureUtf8 (xmlData, contentType);
+  if (encoding != Charset::Encoding::Utf8) {
+    LOG_I_STREAM << "Transcoded feed " << url << " from " << Charset::toName (encoding)
+                 << " to UTF-8" << std::endl;
   }
 
-  // Add new items to main feed buffer, but check for duplicates
+  // Topic channels may receive items of any feed through route rules
+  std::shared_ptr<const KeywordRouter> router = std::atomic_load (&router_);
+  std::vector<uint64_t> routeChannels = router->getRouteChannels ();
+  auto foreign = [this] (uint64_t channelId) { return !ownsChannel (channelId); };
+  routeChannels.erase (std::remove_if (routeChannels.begin (), routeChannels.end (), foreign),
+                       routeChannels.end ());
+  if (subscribers.empty () && routeChannels.empty ()) {
+    return 0;
+  }
+
+  // Parsed once for all subscribers, an item is dropped only when every channel has seen it
+  RSSFeed newFeed = parseRSS (xmlData, [&] (const std::string& hash) {
+    std::lock_guard<std::mutex> lock (mutex_);
+    return std::all_of (subscribers.begin (), subscribers.end (),
+                        [&] (const RSSUrl& subscriber) {
+                          return isSeen (subscriber.discordChannelId, hash);
+                        })
+           && std::all_of (routeChannels.begin (), routeChannels.end (),
+                           [&] (uint64_t channelId) { return isSeen (channelId, hash); });
+  });
+  if (probe) {
+    probe->format = newFeed.format;
+    probe->itemCount = newFeed.totalItems;
+  }
+  maintainWebSub (feedKey, newFeed);
+
+  std::unique_lock<std::mutex> lock (mutex_);
+
+  // Feeds list newest first, queue oldest first so each source is posted in order
   int addedItems = 0;
   int duplicateItems = 0;
-  for (const auto& item : newFeed.items) {
-    if (currentHashes.find (item.hash) == currentHashes.end ()) {
-      feed_.addItem (item);
-      currentHashes.insert (item.hash); // Update set for next iterations
+  int filteredItems = 0;
+  std::set<uint64_t> touchedLanes;
+  std::time_t now = std::time (nullptr);
+  for (auto it = newFeed.items.rbegin (); it != newFeed.items.rend (); ++it) {
+    // One automaton pass per item decides for every channel at once
+    RouteMatch match = router->match (it->title, it->description);
+    std::vector<RSSUrl> targets;
+    for (const auto& subscriber : subscribers) {
+      if (match.accepts (subscriber.discordChannelId)) {
+        targets.push_back (subscriber);
+      } else {
+        filteredItems++;
+      }
+    }
+    for (uint64_t channelId : match.routed) {
+      if (!ownsChannel (channelId)) {
+        continue;
+      }
+      bool subscribed = std::any_of (subscribers.begin (), subscribers.end (),
+                                     [&] (const RSSUrl& subscriber) {
+                                       return subscriber.discordChannelId == channelId;
+                                     });
+      if (!subscribed) {
+        const auto& rules = router->getRules ();
+        auto rule = std::find_if (rules.begin (), rules.end (), [&] (const ChannelRules& r) {
+          return r.channelId == channelId;
+        });
+        // with no owned subscriber the item is credited to the fetched URL
+        targets.emplace_back (subscribers.empty () ? url : subscribers.front ().url,
+                              rule->embedded, channelId);
+      }
+    }
+
+    for (const auto& subscriber : targets) {
+      if (isSeen (subscriber.discordChannelId, it->hash)
+          || !queuedHashes_.insert (seenKey (subscriber.discordChannelId, it->hash)).second) {
+        duplicateItems++;
+        continue;
+      }
+      RSSItem item = *it;
+      item.sourceUrl = subscriber.url;
+      item.embedded = subscriber.embedded;
+      item.discordChannelId = subscriber.discordChannelId;
+      item.queuedAt = now;
+      lanes_[subscriber.discordChannelId].push (
+          subscriptionKey (feedKey, subscriber.discordChannelId), std::move (item));
+      touchedLanes.insert (subscriber.discordChannelId);
       addedItems++;
-    } else {
-      duplicateItems++;
     }
   }
 
   LOG_I_STREAM << "Added " << addedItems << " new items to the feed buffer, skipped "
-               << duplicateItems << " duplicates." << std::endl;
+               << duplicateItems << " duplicates, filtered " << filteredItems << "." << std::endl;
+  lock.unlock ();
+  if (onItemsAvailable_) {
+    for (uint64_t channelId : touchedLanes)
+      onItemsAvailable_ (channelId);
+  }
   return addedItems;
 }
 
 int RssManager::fetchAllFeeds () {
+  bool started = false;
+  int totalItems = fetchFlight_.run ([this] () { return runFetchCycle (); }, &started).get ();
+  if (!started) {
+    LOG_I_STREAM << "Reused the result of a concurrent or recent fetch cycle." << std::endl;
+  }
+  return totalItems;
+}
+
+void RssManager::setFetchFreshness (std::chrono::seconds freshness) {
+  fetchFlight_.setFreshness (freshness);
+}
+
+void RssManager::invalidateFetch () {
+  fetchFlight_.forget ();
+}
+
+int RssManager::runFetchCycle () {
+  if (fetchStopped_) {
+    return 0;
+  }
   checkAndReloadFiles ();
 
   int totalItems = 0;
 
-  for (const auto& rssUrl : urls_) {
-    int items = fetchFeed (rssUrl.url, rssUrl.embedded, rssUrl.discordChannelId);
+  // One download per feed no matter how many channels subscribe to it
+  std::vector<std::string> feeds;
+  {
+    std::lock_guard<std::mutex> lock (mutex_);
+    std::unordered_set<std::string> feedKeys;
+    // Route rules may send items of any feed into an owned topic channel
+    std::vector<uint64_t> routeChannels = std::atomic_load (&router_)->getRouteChannels ();
+    auto owned = [this] (uint64_t channelId) { return ownsChannel (channelId); };
+    bool routesToOwned = std::any_of (routeChannels.begin (), routeChannels.end (), owned);
+    for (const auto& rssUrl : urls_) {
+      if (!routesToOwned && !ownsChannel (rssUrl.discordChannelId)) {
+        continue; // fetched by the process that owns the channel
+      }
+      if (feedKeys.insert (canonicalUrl (rssUrl.url)).second) {
+        feeds.push_back (rssUrl.url);
+      }
+    }
+  }
+
+  for (const auto& url : feeds) {
+    if (fetchStopped_) {
+      LOG_I_STREAM << "Fetch cycle stopped, " << totalItems << " items fetched so far"
+                   << std::endl;
+      return totalItems;
+    }
+    if (!shouldPoll (canonicalUrl (url))) {
+      LOG_D_STREAM << "Skipping poll of WebSub feed: " << url << std::endl;
+      continue;
+    }
+    int items = fetchFeed (url);
     if (items > 0) {
       totalItems += items;
     }
@@ -449,76 +828,336 @@ int RssManager::fetchAllFeeds () {
   return totalItems;
 }
 
+size_t RssManager::getItemCount () const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  size_t count = 0;
+  for (const auto& [channelId, lane] : lanes_) {
+    count += lane.size ();
+  }
+  return count;
+}
+
 size_t RssManager::getItemCount (bool embedded) const {
+  std::lock_guard<std::mutex> lock (mutex_);
   size_t count = 0;
-  for (const auto& item : feed_.items) {
-    if (item.embedded == embedded) {
-      count++;
-    }
+  for (const auto& [channelId, lane] : lanes_) {
+    lane.forEach ([&] (const RSSItem& item) {
+      if (item.embedded == embedded) {
+        count++;
+      }
+    });
   }
   return count;
 }
 
-RSSItem RssManager::getRandomItem () {
-  if (feed_.items.empty ()) {
-    return RSSItem ();
+namespace {
+  std::chrono::seconds ageOf (std::time_t oldest) {
+    if (oldest == 0) {
+      return std::chrono::seconds (0);
+    }
+    return std::chrono::seconds (std::max<std::time_t> (0, std::time (nullptr) - oldest));
+  }
+
+  std::time_t oldestQueuedAt (const FairQueue<RSSItem>& lane, std::time_t oldest) {
+    lane.forEach ([&] (const RSSItem& item) {
+      if (oldest == 0 || item.queuedAt < oldest) {
+        oldest = item.queuedAt;
+      }
+    });
+    return oldest;
+  }
+}
+
+std::chrono::seconds RssManager::getOldestItemAge () const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  std::time_t oldest = 0;
+  for (const auto& [channelId, lane] : lanes_) {
+    oldest = oldestQueuedAt (lane, oldest);
   }
+  return ageOf (oldest);
+}
 
-  std::uniform_int_distribution<size_t> dist (0, feed_.items.size () - 1);
-  size_t index = dist (rng_);
+std::vector<uint64_t> RssManager::getLaneChannels () const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  std::set<uint64_t> channels;
+  for (const auto& subscription : urls_) {
+    if (ownsChannel (subscription.discordChannelId)) {
+      channels.insert (subscription.discordChannelId);
+    }
+  }
+  for (const auto& [channelId, lane] : lanes_) {
+    if (!lane.empty ()) {
+      channels.insert (channelId);
+    }
+  }
+  return std::vector<uint64_t> (channels.begin (), channels.end ());
+}
 
-  RSSItem item = feed_.items[index];
+LaneStatus RssManager::getLaneStatus (uint64_t channelId) const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  LaneStatus status;
+  auto lane = lanes_.find (channelId);
+  if (lane != lanes_.end ()) {
+    status.queuedItems = lane->second.size ();
+    status.oldestItemAge = ageOf (oldestQueuedAt (lane->second, 0));
+  }
+  return status;
+}
 
-  // Save hash immediately to prevent re-processing
-  saveSeenHash (item.hash);
+void RssManager::setOnItemsAvailable (std::function<void (uint64_t channelId)> callback) {
+  onItemsAvailable_ = std::move (callback);
+}
 
-  // Remove item from feed
-  feed_.items.erase (feed_.items.begin () + index);
+RSSItem RssManager::getNextItem () {
+  return takeItem ([] (const RSSItem&) { return true; });
+}
 
+RSSItem RssManager::getNextItem (bool embedded) {
+  return takeItem ([embedded] (const RSSItem& item) { return item.embedded == embedded; });
+}
+
+RSSItem RssManager::getNextLaneItem (uint64_t channelId) {
+  RSSItem item;
+  {
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto lane = lanes_.find (channelId);
+    if (lane != lanes_.end ()) {
+      std::optional<RSSItem> next = lane->second.pop ();
+      if (next) {
+        item = markTaken (std::move (*next));
+      }
+    }
+  }
   return item;
 }
 
-RSSItem RssManager::getRandomItem (bool embedded) {
-  // Find items with matching embedded flag
-  std::vector<size_t> matchingIndices;
-  for (size_t i = 0; i < feed_.items.size (); ++i) {
-    if (feed_.items[i].embedded == embedded) {
-      matchingIndices.push_back (i);
+void RssManager::indexDelivered (const RSSItem& item) {
+  if (item.title.empty ())
+    return;
+  SearchDocument document;
+  document.title = item.title;
+  document.link = item.link;
+  document.description = item.description;
+  document.channelId = item.discordChannelId;
+  document.postedAt = std::time (nullptr);
+  if (searchIndex_.add (document) != 0) {
+    LOG_W_STREAM << "Failed to index delivered item: " << item.link << std::endl;
+  }
+}
+
+std::vector<SearchHit> RssManager::search (const std::string& query, size_t limit) const {
+  return searchIndex_.search (query, limit);
+}
+
+void RssManager::confirmDelivery (const RSSItem& item, uint64_t channelId, uint64_t messageId) {
+  if (item.title.empty ())
+    return;
+  recordDelivery (item, channelId, messageId);
+  indexDelivered (item);
+  bool batchFull = false;
+  {
+    std::lock_guard<std::mutex> lock (mutex_);
+    if (item.deliveryId == 0) { // no outbox, seen right away
+      std::string key = seenKey (item.discordChannelId, item.hash);
+      queuedHashes_.erase (key);
+      saveSeenHash (key);
+    } else {
+      batchFull = outbox_.confirm (item.deliveryId);
     }
   }
+  if (batchFull)
+    flushDeliveries ();
+}
 
-  if (matchingIndices.empty ()) {
-    return RSSItem ();
+void RssManager::failDelivery (const RSSItem& item, uint16_t httpStatus) {
+  if (item.title.empty ())
+    return;
+  uint64_t channelId = item.discordChannelId;
+  // No response, rate limits and server errors may pass, anything else fails again
+  bool transient = httpStatus == 0 || httpStatus == 429 || httpStatus >= 500;
+  RSSItem retry = item;
+  retry.attempts++;
+  bool batchFull = false;
+  {
+    std::lock_guard<std::mutex> lock (mutex_);
+    if (transient && retry.attempts < MAX_DELIVERY_ATTEMPTS) {
+      if (retry.deliveryId != 0) {
+        uint64_t id = outbox_.retry (retry.deliveryId, itemToJson (retry));
+        if (id != 0)
+          retry.deliveryId = id; // otherwise the old entry stays, only the count is lost
+      }
+      lanes_[channelId].push (subscriptionKey (canonicalUrl (retry.sourceUrl), channelId),
+                              retry);
+    } else if (retry.deliveryId == 0) {
+      std::string key = seenKey (channelId, retry.hash);
+      queuedHashes_.erase (key);
+      saveSeenHash (key);
+    } else {
+      // marked seen like a delivery so the next fetch does not queue it again
+      batchFull = outbox_.confirm (retry.deliveryId);
+    }
   }
+  if (transient && retry.attempts < MAX_DELIVERY_ATTEMPTS) {
+    LOG_W_STREAM << "Delivery failed (HTTP " << httpStatus << "), attempt " << retry.attempts
+                 << " of " << MAX_DELIVERY_ATTEMPTS << ", requeued: " << item.link << std::endl;
+    if (onItemsAvailable_)
+      onItemsAvailable_ (channelId);
+    return;
+  }
+  LOG_E_STREAM << "Delivery failed (HTTP " << httpStatus << ") after " << retry.attempts
+               << " attempts, dropped: " << item.link << " to channel " << channelId
+               << std::endl;
+  if (batchFull)
+    flushDeliveries ();
+}
 
-  // Pick random item from matching ones
-  std::uniform_int_distribution<size_t> dist (0, matchingIndices.size () - 1);
-  size_t randomIndex = dist (rng_);
-  size_t actualIndex = matchingIndices[randomIndex];
+int RssManager::flushDeliveries () {
+  std::lock_guard<std::mutex> lock (mutex_);
+  std::vector<std::string> keys = outbox_.getPendingKeys ();
+  if (keys.empty ())
+    return 0;
+  // Seen first: a crash before the acks are written only finds already seen entries
+  for (const auto& key : keys) {
+    queuedHashes_.erase (key);
+    seenHashes_.insert (key);
+  }
+  if (writeSeenHashes () != 0) {
+    LOG_E_STREAM << "Failed to save seen hashes, confirmations stay pending." << std::endl;
+    return -1;
+  }
+  return outbox_.commit ();
+}
 
-  RSSItem item = feed_.items[actualIndex];
+void RssManager::stopFetching () {
+  fetchStopped_ = true;
+}
+
+int RssManager::shutdown () {
+  stopFetching ();
+  disableWebSub ();
+  int result = flushDeliveries ();
+  if (archive_.flush () != 0) {
+    LOG_E_STREAM << "Failed to flush the delivery archive." << std::endl;
+    result = -1;
+  }
+  if (searchIndex_.flush () != 0) {
+    LOG_E_STREAM << "Failed to flush the search index." << std::endl;
+    result = -1;
+  }
+  return result;
+}
+
+void RssManager::setDeliveryBatch (size_t batchSize) {
+  outbox_.setBatchSize (batchSize);
+}
 
-  // Save hash immediately to prevent re-processing
-  saveSeenHash (item.hash);
+void RssManager::recoverDeliveries () {
+  size_t requeued = 0;
+  {
+    std::lock_guard<std::mutex> lock (mutex_);
+    for (const auto& entry : outbox_.getInFlight ()) {
+      RSSItem item = itemFromJson (entry.payload);
+      item.deliveryId = entry.id;
+      if (isSeen (item.discordChannelId, item.hash)) {
+        outbox_.confirm (entry.id); // committed, only the ack was lost
+        continue;
+      }
+      queuedHashes_.insert (entry.key);
+      lanes_[item.discordChannelId].push (
+          subscriptionKey (canonicalUrl (item.sourceUrl), item.discordChannelId), std::move (item));
+      requeued++;
+    }
+    outbox_.commit ();
+  }
+  if (requeued > 0) {
+    LOG_I_STREAM << "Requeued " << requeued << " unconfirmed deliveries." << std::endl;
+  }
+}
 
-  // Remove item from feed
-  feed_.items.erase (feed_.items.begin () + actualIndex);
+nlohmann::json RssManager::itemToJson (const RSSItem& item) {
+  return { { "title", item.title },
+           { "link", item.link },
+           { "description", item.description },
+           { "pubDate", item.pubDate },
+           { "hash", item.hash },
+           { "sourceUrl", item.sourceUrl },
+           { "embedded", item.embedded },
+           { "discordChannelId", item.discordChannelId },
+           { "queuedAt", static_cast<int64_t> (item.queuedAt) },
+           { "attempts", item.attempts } };
+}
 
+RSSItem RssManager::itemFromJson (const nlohmann::json& json) {
+  RSSItem item;
+  item.title = json.value ("title", "");
+  item.link = json.value ("link", "");
+  item.description = json.value ("description", "");
+  item.pubDate = json.value ("pubDate", "");
+  item.hash = json.value ("hash", "");
+  item.sourceUrl = json.value ("sourceUrl", "");
+  item.embedded = json.value ("embedded", false);
+  item.discordChannelId = json.value ("discordChannelId", uint64_t (0));
+  item.queuedAt = static_cast<std::time_t> (json.value ("queuedAt", int64_t (0)));
+  item.attempts = json.value ("attempts", 0u);
   return item;
 }
 
-// Add method to save all hashes at once (call this periodically or at shutdown)
-int RssManager::saveAllSeenHashes () {
-  nlohmann::json jsonData = nlohmann::json::array ();
-  for (const auto& h : seenHashes_) {
-    jsonData.push_back (h);
+void RssManager::recordDelivery (const RSSItem& item, uint64_t channelId, uint64_t messageId) {
+  ArchiveRecord record;
+  record.postedAt = std::time (nullptr);
+  record.queuedAt = item.queuedAt;
+  record.channelId = channelId;
+  record.messageId = messageId;
+  record.sourceUrl = item.sourceUrl;
+  record.title = item.title;
+  record.link = item.link;
+  if (archive_.append (record) != 0) {
+    LOG_W_STREAM << "Failed to archive delivered item: " << item.link << std::endl;
   }
+}
 
-  std::ofstream file (getHashesPath ());
-  if (!file.is_open ())
-    return -1;
-  file << jsonData.dump (4);
-  return 0;
+std::vector<ArchiveRecord> RssManager::getRecentDeliveries (size_t limit,
+                                                            const std::string& sourceUrl) const {
+  if (sourceUrl.empty ())
+    return archive_.recent (limit);
+  std::string feedKey = canonicalUrl (sourceUrl);
+  return archive_.recent (limit, [&feedKey] (const ArchiveRecord& record) {
+    return canonicalUrl (record.sourceUrl) == feedKey;
+  });
+}
+
+RSSItem RssManager::takeItem (const std::function<bool (const RSSItem&)>& filter) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  if (lanes_.empty ()) {
+    return RSSItem ();
+  }
+  // Lanes take turns, starting after the one served last
+  auto lane = lanes_.upper_bound (lastLane_);
+  for (size_t visited = 0; visited < lanes_.size (); ++visited, ++lane) {
+    if (lane == lanes_.end ()) {
+      lane = lanes_.begin ();
+    }
+    std::optional<RSSItem> item = lane->second.pop (filter);
+    if (item) {
+      lastLane_ = lane->first;
+      return markTaken (std::move (*item));
+    }
+  }
+  return RSSItem ();
+}
+
+RSSItem RssManager::markTaken (RSSItem item) {
+  // Seen state is per channel, other subscribers of the feed still get the item.
+  // The key stays in queuedHashes_ until the delivery is confirmed, so a refetch skips it.
+  if (item.deliveryId == 0) // a retried item is journaled already
+    item.deliveryId = outbox_.begin (seenKey (item.discordChannelId, item.hash), itemToJson (item));
+  return item;
+}
+
+// Add method to save all hashes at once (call this periodically or at shutdown)
+int RssManager::saveAllSeenHashes () {
+  std::lock_guard<std::mutex> lock (mutex_);
+  return writeSeenHashes ();
 }
 
 bool RssManager::hasFileChanged (const std::filesystem::path& path,
@@ -548,4 +1187,125 @@ void RssManager::checkAndReloadFiles () {
     LOG_I_STREAM << "Hashes file changed, reloading..." << std::endl;
     loadSeenHashes ();
   }
+
+  if (hasFileChanged (getRoutingRulesPath (), routingRulesLastModified_)) {
+    LOG_I_STREAM << "Routing rules file changed, reloading..." << std::endl;
+    loadRoutingRules ();
+  }
 }
+
+int RssManager::loadRoutingRules () {
+  // The file is optional, without it every channel gets everything it subscribes to
+  if (!std::filesystem::exists (getRoutingRulesPath ())) {
+    std::atomic_store (&router_, KeywordRouter::compile ({}));
+    return 0;
+  }
+
+  std::vector<ChannelRules> rules;
+  try {
+    std::ifstream file (getRoutingRulesPath ());
+    nlohmann::json jsonData;
+    file >> jsonData;
+    rules = KeywordRouter::rulesFromJson (jsonData);
+  } catch (const std::exception& e) {
+    LOG_E_STREAM << "Routing rules corrupted: " << e.what () << ". Keeping previous rules."
+                 << std::endl;
+    return -1;
+  }
+
+  // Compiled outside any lock, ingestion keeps using the old automaton until the swap
+  std::shared_ptr<const KeywordRouter> router = KeywordRouter::compile (rules);
+  std::atomic_store (&router_, router);
+  LOG_I_STREAM << "Loaded routing rules for " << rules.size () << " channels ("
+               << router->getStateCount () << " automaton states)." << std::endl;
+  return 0;
+}
+
+// WebSub push ingestion
+int RssManager::enableWebSub (const WebSubOptions& options) {
+  webSubOptions_ = options;
+  webSub_ = std::make_unique<WebSubSubscriber> ();
+  if (webSub_->start (options, [this] (const std::string& topic, const std::string& body,
+                                       const std::string& contentType) {
+        onWebSubContent (topic, body, contentType);
+      }) != 0) {
+    LOG_E_STREAM << "Failed to start WebSub endpoint, staying on polling only." << std::endl;
+    webSub_.reset ();
+    return -1;
+  }
+  return 0;
+}
+
+void RssManager::disableWebSub () {
+  if (webSub_) {
+    webSub_->stop ();
+    webSub_.reset ();
+  }
+}
+
+bool RssManager::isWebSubActive (const std::string& url) const {
+  if (!webSub_)
+    return false;
+  std::string topic;
+  {
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto it = webSubTopics_.find (canonicalUrl (url));
+    if (it == webSubTopics_.end ())
+      return false;
+    topic = it->second;
+  }
+  return webSub_->isActive (topic);
+}
+
+void RssManager::maintainWebSub (const std::string& feedKey, const RSSFeed& parsed) {
+  if (!webSub_ || parsed.hubUrl.empty ())
+    return;
+
+  std::string topic = parsed.selfUrl.empty () ? feedKey : parsed.selfUrl;
+  {
+    std::lock_guard<std::mutex> lock (mutex_);
+    webSubTopics_[feedKey] = topic;
+  }
+
+  // renew a day before the lease runs out
+  if (webSub_->needsRenewal (topic, std::chrono::hours (24))) {
+    webSub_->subscribe (parsed.hubUrl, topic);
+  }
+}
+
+void RssManager::onWebSubContent (const std::string& topic, const std::string& body,
+                                  const std::string& contentType) {
+  std::string feedKey;
+  {
+    std::lock_guard<std::mutex> lock (mutex_);
+    for (const auto& [key, subscribedTopic] : webSubTopics_) {
+      if (subscribedTopic == topic && !subscribersOf (key).empty ()) {
+        feedKey = key;
+        break;
+      }
+    }
+  }
+
+  if (feedKey.empty ()) {
+    LOG_W_STREAM << "WebSub push for a topic without a source: " << topic << std::endl;
+    return;
+  }
+
+  int added = ingestFeed (feedKey, body, contentType);
+  LOG_I_STREAM << "WebSub push from " << feedKey << " queued " << added << " items."
+               << std::endl;
+}
+
+bool RssManager::shouldPoll (const std::string& feedKey) {
+  auto now = std::chrono::steady_clock::now ();
+  auto last = lastPolled_.find (feedKey);
+  bool safetyNetDue
+      = last == lastPolled_.end ()
+        || now - last->second >= std::chrono::seconds (webSubOptions_.safetyNetPollInterval);
+
+  if (!safetyNetDue && isWebSubActive (feedKey)) {
+    return false;
+  }
+  lastPolled_[feedKey] = now;
+  return true;
+}
\ No newline at end of file
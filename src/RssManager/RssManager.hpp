@@ -1,24 +1,39 @@
 #ifndef __RSSMANAGER_H__
 #define __RSSMANAGER_H__
 
+#include "FairQueue.hpp"
+#include "KeywordRouter.hpp"
+#include "SingleFlight.hpp"
 #include <Assets/AssetContext.hpp>
+#include <Archive/DeliveryArchive.hpp>
 #include <Logger/Logger.hpp>
+#include <Outbox/DeliveryOutbox.hpp>
+#include <Search/SearchIndex.hpp>
+#include <WebSub/WebSubSubscriber.hpp>
 #include <nlohmann/json.hpp>
 #include <tinyxml2.h>
 #include <string>
 #include <vector>
 #include <unordered_set>
-#include <random>
 #include <filesystem>
+#include <chrono>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <ctime>
+#include <unordered_map>
+#include <map>
 
+// One channel subscription of a feed, several subscriptions may share the same URL
 struct RSSUrl {
   std::string url;
   bool embedded; // Whether this item should use embedded format
   uint64_t discordChannelId;
-  RSSUrl () : url (""), embedded (false), discordChannelId (0) {
+  unsigned weight; // Share of the posting slots relative to other sources
+  RSSUrl () : url (""), embedded (false), discordChannelId (0), weight (1) {
   }
-  RSSUrl (const std::string& u, bool e = false, uint64_t dChId = 0)
-      : url (u), embedded (e), discordChannelId (dChId) {
+  RSSUrl (const std::string& u, bool e = false, uint64_t dChId = 0, unsigned w = 1)
+      : url (u), embedded (e), discordChannelId (dChId), weight (w) {
   }
 };
 
@@ -28,10 +43,15 @@ struct RSSItem {
   std::string description;
   std::string pubDate;
   std::string hash;
-  bool embedded; // Whether this item should use embedded format
+  std::string sourceUrl; // Subscription URL the item came from
+  bool embedded;         // Whether this item should use embedded format
   uint64_t discordChannelId;
+  std::time_t queuedAt; // When the item entered the posting queue
+  uint64_t deliveryId;  // Outbox entry while the item is in flight, 0 before it is taken
+  unsigned attempts;    // Failed sends so far, journaled with the outbox entry
 
-  RSSItem () : embedded (false), discordChannelId (0) {
+  RSSItem ()
+      : embedded (false), discordChannelId (0), queuedAt (0), deliveryId (0), attempts (0) {
   }
   RSSItem (const std::string& t, const std::string& l, const std::string& d,
            const std::string& date, bool e, uint64_t dChId);
@@ -43,29 +63,101 @@ struct RSSFeed {
   std::string title;
   std::string description;
   std::string link;
+  std::string hubUrl;  // WebSub hub advertised by <link rel="hub">
+  std::string selfUrl; // canonical topic URL advertised by <link rel="self">
+  std::string format;  // "RSS 2.0", "RSS 1.0" or "Atom", empty if the document is not a feed
+  size_t totalItems = 0; // valid items in the document, including already seen ones
   std::vector<RSSItem> items;
   void addItem (const RSSItem& item);
   size_t size () const;
   void clear ();
 };
 
+// Outcome of probing a newly added source
+struct FeedProbe {
+  bool reachable = false;
+  std::string format;
+  size_t itemCount = 0; // items in the document
+  int queuedItems = 0;  // new items queued for the subscribers
+  bool isValid () const {
+    return reachable && !format.empty ();
+  }
+};
+
+// Backlog of one channel's delivery lane
+struct LaneStatus {
+  size_t queuedItems = 0;
+  std::chrono::seconds oldestItemAge{ 0 };
+};
+
 class RssManager {
 public:
+  static constexpr unsigned MAX_DELIVERY_ATTEMPTS = 5; // transient failures before a drop
+  static constexpr unsigned MAX_SOURCE_WEIGHT = 100;    // rssUrls.json weights are clamped to it
+
   RssManager ();
   ~RssManager () = default;
 
   // Main operations
   int initialize ();
+  // Single-flight: concurrent callers share one cycle, a fresh result is reused
   int fetchAllFeeds ();
-  int fetchFeed (const std::string& url, bool embedded = false, uint64_t discordChannelId = 0);
+  void setFetchFreshness (std::chrono::seconds freshness);
+  // Newly owned channels make the last cycle's result stale, the next fetch runs in full
+  void invalidateFetch ();
+  // Download a feed once and fan its items out to every channel subscribed to it
+  int fetchFeed (const std::string& url);
+  // Parse a downloaded or pushed document and queue unseen items for each subscription
+  int ingestFeed (const std::string& url, std::string xmlData, const std::string& contentType = "",
+                  FeedProbe* probe = nullptr);
+  // Download and validate a single source, queueing its items when it is a valid feed
+  FeedProbe probeFeed (const std::string& url);
 
-  // Item operations
-  RSSItem getRandomItem ();
-  RSSItem getRandomItem (bool embedded); // Get item with specific embedded preference
-  size_t getItemCount () const {
-    return feed_.size ();
-  }
+  // WebSub push ingestion, polling of subscribed feeds drops to the safety net interval
+  int enableWebSub (const WebSubOptions& options);
+  void disableWebSub ();
+  bool isWebSubActive (const std::string& url) const;
+
+  // Item operations - weighted deficit round robin across sources
+  RSSItem getNextItem ();
+  RSSItem getNextItem (bool embedded); // Get item with specific embedded preference
+  size_t getItemCount () const;
   size_t getItemCount (bool embedded) const; // Count items with specific embedded flag
+  std::chrono::seconds getOldestItemAge () const;
+
+  // Delivery lanes - every channel has its own queue, channel 0 is the default channel
+  std::vector<uint64_t> getLaneChannels () const; // subscribed channels and non-empty lanes
+  RSSItem getNextLaneItem (uint64_t channelId);
+  LaneStatus getLaneStatus (uint64_t channelId) const;
+  // Called once per channel that received new items, outside the lock.
+  // Set it before fetching starts.
+  void setOnItemsAvailable (std::function<void (uint64_t channelId)> callback);
+  // Channels this process delivers to, items for other channels are neither fetched nor queued.
+  // Set it before fetching starts, no filter owns every channel.
+  void setChannelFilter (std::function<bool (uint64_t channelId)> owns);
+  // Separate seen hashes, outbox, archive and search index per process sharing the assets.
+  // Set it before initialize, empty keeps the shared file names.
+  void setInstanceName (const std::string& name);
+
+  // Full-text search over delivered items
+  std::vector<SearchHit> search (const std::string& query, size_t limit = 10) const;
+
+  // A taken item is in flight until it is confirmed, it is marked seen with the next group
+  // commit. messageId is 0 when Discord did not report one.
+  void confirmDelivery (const RSSItem& item, uint64_t channelId, uint64_t messageId);
+  // The send failed with httpStatus (0 without a response). Transient failures send the item
+  // back to its lane, permanent ones and the last attempt drop it as seen.
+  void failDelivery (const RSSItem& item, uint16_t httpStatus = 0);
+  // Mark confirmed items seen and journal the confirmations, once per batch
+  int flushDeliveries ();
+  // On exit: WebSub endpoint closed, confirmations, archive and search index written out
+  int shutdown ();
+  // Abort the running fetch cycle between feeds and its download, later cycles do nothing
+  void stopFetching ();
+  void setDeliveryBatch (size_t batchSize);
+  // Newest first, optionally only items of one source
+  std::vector<ArchiveRecord> getRecentDeliveries (size_t limit,
+                                                  const std::string& sourceUrl = "") const;
 
   // Utility
   std::string getItemAsMarkdown (const RSSItem& item) const {
@@ -73,27 +165,79 @@ public:
   }
 
   std::string getSourcesAsList ();
+  // Changes whenever getSourcesAsList would render differently
+  std::string getSourcesRevision () const;
+  // Subscribe a channel to a feed, -1 if that channel already has the feed
   int addUrl (const std::string& url, bool embedded, uint64_t discordChannelId = 0);
+  int removeUrl (const std::string& url, uint64_t discordChannelId);
+
+  // Registry key of a feed - scheme and host lower-cased, fragment and trailing slash dropped
+  static std::string canonicalUrl (const std::string& url);
 
 private:
-  RSSFeed feed_;
-  std::vector<RSSUrl> urls_;
-  std::unordered_set<std::string> seenHashes_;
-  std::mt19937 rng_;
+  mutable std::mutex mutex_; // guards lanes_, urls_ and seenHashes_
+  std::function<void (uint64_t channelId)> onItemsAvailable_;
+  std::function<bool (uint64_t channelId)> channelFilter_;
+  bool ownsChannel (uint64_t channelId) const;
+  std::string instanceName_;
+  std::filesystem::path instancePath (const std::string& stem, const std::string& extension) const;
+  // Pending items per channel, one sub-queue per source within a lane
+  std::map<uint64_t, FairQueue<RSSItem>> lanes_;
+  uint64_t lastLane_ = 0; // lane served last by getNextItem
+  std::unordered_set<std::string> queuedHashes_; // seen keys of queued and in-flight items
+  std::vector<RSSUrl> urls_;                     // subscriptions
+  uint64_t sourcesRevision_ = 0;                 // bumped on every change of urls_
+  std::unordered_set<std::string> seenHashes_;   // seen keys, plain hashes from older versions
+  RSSItem takeItem (const std::function<bool (const RSSItem&)>& filter);
+  RSSItem markTaken (RSSItem item); // callers hold mutex_
+  SingleFlight<int> fetchFlight_;
+  std::atomic<bool> fetchStopped_{ false };
+  SearchIndex searchIndex_;
+  DeliveryArchive archive_;
+  DeliveryOutbox outbox_;
+  void recordDelivery (const RSSItem& item, uint64_t channelId, uint64_t messageId);
+  void recoverDeliveries (); // requeue items a restart left unconfirmed
+  static nlohmann::json itemToJson (const RSSItem& item);
+  static RSSItem itemFromJson (const nlohmann::json& json);
+  void indexDelivered (const RSSItem& item);
+  int runFetchCycle ();
+
+  // Keyword routing, swapped atomically on reload so ingestion never waits for a compile
+  std::shared_ptr<const KeywordRouter> router_;
+  int loadRoutingRules ();
+
+  // Subscription registry, callers hold mutex_
+  std::vector<RSSUrl> subscribersOf (const std::string& feedKey) const;
+  bool isSeen (uint64_t discordChannelId, const std::string& hash) const;
+  static std::string seenKey (uint64_t discordChannelId, const std::string& hash);
+  static std::string subscriptionKey (const std::string& feedKey, uint64_t discordChannelId);
+
+  // WebSub
+  std::unique_ptr<WebSubSubscriber> webSub_;
+  WebSubOptions webSubOptions_;
+  std::unordered_map<std::string, std::string> webSubTopics_; // feed key -> topic
+  std::unordered_map<std::string, std::chrono::steady_clock::time_point> lastPolled_;
+  void maintainWebSub (const std::string& feedKey, const RSSFeed& parsed);
+  void onWebSubContent (const std::string& topic, const std::string& body,
+                        const std::string& contentType);
+  bool shouldPoll (const std::string& feedKey);
 
   // File operations
   int saveUrls ();
   int loadUrls ();
   int loadSeenHashes ();
   int saveSeenHash (const std::string& hash);
-  int saveAllSeenHashes (); // Save all hashes at once
+  int saveAllSeenHashes ();  // Save all hashes at once
+  int writeSeenHashes ();    // callers hold mutex_
   bool hasFileChanged (const std::filesystem::path& path,
                        std::filesystem::file_time_type& lastModified);
   void checkAndReloadFiles ();
 
   // RSS parsing
-  RSSFeed parseRSS (const std::string& xmlData, bool embedded, uint64_t discordChannelId = 0);
-  std::string downloadFeed (const std::string& url);
+  // Items for which isSeen returns true are skipped before any post-processing
+  RSSFeed parseRSS (const std::string& xmlData,
+                    const std::function<bool (const std::string& hash)>& isSeen);
+  std::string downloadFeed (const std::string& url, std::string* contentType = nullptr);
 
   // Paths
   std::filesystem::path getUrlsPath () const {
@@ -101,12 +245,29 @@ private:
   }
 
   std::filesystem::path getHashesPath () const {
-    return AssetContext::getAssetsPath () / "seenHashes.json";
+    return instancePath ("seenHashes", ".json");
+  }
+
+  std::filesystem::path getArchivePath () const {
+    return instancePath ("archive", "");
+  }
+
+  std::filesystem::path getSearchIndexPath () const {
+    return instancePath ("search", "");
+  }
+
+  std::filesystem::path getOutboxPath () const {
+    return instancePath ("outbox", ".journal");
+  }
+
+  std::filesystem::path getRoutingRulesPath () const {
+    return AssetContext::getAssetsPath () / "routingRules.json";
   }
 
   // Add file timestamp tracking
   std::filesystem::file_time_type urlsLastModified_;
   std::filesystem::file_time_type hashesLastModified_;
+  std::filesystem::file_time_type routingRulesLastModified_;
 };
 
 #endif // __RSSMANAGER_H__
\ No newline at end of file
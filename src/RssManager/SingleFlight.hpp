@@ -0,0 +1,84 @@
+#ifndef __SINGLEFLIGHT_H__
+#define __SINGLEFLIGHT_H__
+
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+
+// Coalesces concurrent calls of the same expensive operation.
+// The first caller runs it, callers arriving while it is in flight share its result, and a
+// call within the freshness window after a successful run reuses that run's result.
+
+template <typename R> class SingleFlight {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit SingleFlight (Clock::duration freshness = Clock::duration::zero ())
+      : freshness_ (freshness) {
+  }
+
+  void setFreshness (Clock::duration freshness) {
+    std::lock_guard<std::mutex> lock (mutex_);
+    freshness_ = freshness;
+  }
+
+  /**
+   * @brief Run fn, or attach to the run in flight, or reuse a fresh result.
+   * @param started Set to true when this call ran fn itself.
+   * @return Future of the run this call was served by, exceptions of fn propagate through it.
+   */
+  std::shared_future<R> run (const std::function<R ()>& fn, bool* started = nullptr) {
+    std::unique_lock<std::mutex> lock (mutex_);
+    if (started)
+      *started = false;
+    if (inFlight_.valid ())
+      return inFlight_;
+    if (last_.valid () && Clock::now () - finishedAt_ < freshness_)
+      return last_;
+
+    std::promise<R> promise;
+    std::shared_future<R> future = promise.get_future ().share ();
+    inFlight_ = future;
+    lock.unlock ();
+
+    bool failed = false;
+    try {
+      promise.set_value (fn ());
+    } catch (...) {
+      failed = true;
+      promise.set_exception (std::current_exception ());
+    }
+
+    lock.lock ();
+    inFlight_ = std::shared_future<R> ();
+    if (!failed) { // a failed run is never reused
+      last_ = future;
+      finishedAt_ = Clock::now ();
+    }
+    if (started)
+      *started = true;
+    return future;
+  }
+
+  // The inputs changed, the next call runs fn even within the freshness window
+  void forget () {
+    std::lock_guard<std::mutex> lock (mutex_);
+    last_ = std::shared_future<R> ();
+  }
+
+  bool isInFlight () const {
+    std::lock_guard<std::mutex> lock (mutex_);
+    return inFlight_.valid ();
+  }
+
+private:
+  mutable std::mutex mutex_;
+  Clock::duration freshness_;
+  std::shared_future<R> inFlight_;
+  std::shared_future<R> last_;
+  Clock::time_point finishedAt_;
+};
+
+#endif // __SINGLEFLIGHT_H__
@@ -0,0 +1,247 @@
+#include "Scheduler.hpp"
+#include <Logger/Logger.hpp>
+#include <algorithm>
+
+namespace {
+  constexpr unsigned SLOT_BITS = 6; // log2 (Scheduler::SLOTS)
+  static_assert ((1u << SLOT_BITS) == Scheduler::SLOTS, "slot count must match SLOT_BITS");
+
+  constexpr uint64_t spanOf (size_t level) {
+    return uint64_t{ 1 } << (SLOT_BITS * level);
+  }
+
+  std::chrono::microseconds toMicros (Scheduler::Clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::microseconds> (duration);
+  }
+}
+
+Scheduler::Scheduler (Clock::duration tick) : tick_ (tick), epoch_ (Clock::now ()) {
+}
+
+Scheduler::~Scheduler () {
+  stop ();
+}
+
+void Scheduler::start () {
+  std::lock_guard<std::mutex> lock (mutex_);
+  if (running_)
+    return;
+  running_ = true;
+  thread_ = std::thread (&Scheduler::loop, this);
+}
+
+void Scheduler::stop () {
+  {
+    std::lock_guard<std::mutex> lock (mutex_);
+    running_ = false;
+  }
+  wake_.notify_all ();
+  if (thread_.joinable () && thread_.get_id () != std::this_thread::get_id ())
+    thread_.join ();
+}
+
+bool Scheduler::isRunning () const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  return running_;
+}
+
+uint64_t Scheduler::tickOf (Clock::time_point time) const {
+  if (time <= epoch_)
+    return 0;
+  // first tick boundary at or after the due time, a timer never fires early
+  auto elapsed = time - epoch_;
+  return static_cast<uint64_t> ((elapsed + tick_ - Clock::duration (1)) / tick_);
+}
+
+Scheduler::TaskId Scheduler::scheduleOnce (Clock::duration delay, Task task,
+                                           const std::string& name) {
+  return add (delay,
+              [task = std::move (task)] () -> std::optional<Clock::duration> {
+                task ();
+                return std::nullopt;
+              },
+              name);
+}
+
+Scheduler::TaskId Scheduler::scheduleEvery (Clock::duration interval, Task task,
+                                            const std::string& name,
+                                            std::optional<Clock::duration> firstDelay) {
+  return add (firstDelay.value_or (interval),
+              [task = std::move (task), interval] () -> std::optional<Clock::duration> {
+                task ();
+                return interval;
+              },
+              name);
+}
+
+Scheduler::TaskId Scheduler::scheduleDynamic (Clock::duration firstDelay, DynamicTask task,
+                                              const std::string& name) {
+  return add (firstDelay, std::move (task), name);
+}
+
+Scheduler::TaskId Scheduler::add (Clock::duration delay, DynamicTask run,
+                                  const std::string& name) {
+  TaskId id;
+  {
+    std::lock_guard<std::mutex> lock (mutex_);
+    id = nextId_++;
+    Entry& entry = entries_[id];
+    entry.name = name.empty () ? "task-" + std::to_string (id) : name;
+    entry.run = std::move (run);
+    entry.stats.id = id;
+    entry.stats.name = entry.name;
+    arm (id, entry, Clock::now () + delay);
+  }
+  wake_.notify_all ();
+  return id;
+}
+
+bool Scheduler::cancel (TaskId id) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  // wheel slots still referencing the task are dropped lazily when they expire
+  return entries_.erase (id) > 0;
+}
+
+bool Scheduler::reschedule (TaskId id, Clock::duration delay) {
+  {
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto it = entries_.find (id);
+    if (it == entries_.end ())
+      return false;
+    arm (id, it->second, Clock::now () + delay);
+  }
+  wake_.notify_all ();
+  return true;
+}
+
+bool Scheduler::isScheduled (TaskId id) const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  return entries_.count (id) > 0;
+}
+
+std::vector<Scheduler::TaskStats> Scheduler::getStats () const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  std::vector<TaskStats> stats;
+  for (const auto& [id, entry] : entries_)
+    stats.push_back (entry.stats);
+  std::sort (stats.begin (), stats.end (),
+             [] (const TaskStats& a, const TaskStats& b) { return a.id < b.id; });
+  return stats;
+}
+
+void Scheduler::arm (TaskId id, Entry& entry, Clock::time_point due) {
+  entry.due = due;
+  entry.generation++;
+  entry.expiresTick = tickOf (due);
+  place (Slot{ id, entry.generation }, entry.expiresTick);
+}
+
+void Scheduler::place (const Slot& slot, uint64_t expiresTick) {
+  if (expiresTick <= currentTick_) {
+    overdue_.push_back (slot);
+    return;
+  }
+  // Timers beyond the wheel's range park in the top level and are re-placed on cascade
+  uint64_t target = std::min (expiresTick, currentTick_ + spanOf (LEVELS) - 1);
+  uint64_t delta = target - currentTick_;
+  size_t level = 0;
+  while (level + 1 < LEVELS && delta >= spanOf (level + 1))
+    ++level;
+  wheel_[level][(target >> (SLOT_BITS * level)) & (SLOTS - 1)].push_back (slot);
+}
+
+void Scheduler::advance (std::vector<Slot>& due) {
+  ++currentTick_;
+
+  // Higher levels first, so a timer can cascade through several levels in one tick
+  for (size_t level = LEVELS - 1; level > 0; --level) {
+    if (currentTick_ % spanOf (level) != 0)
+      continue;
+    std::vector<Slot> cascade;
+    cascade.swap (wheel_[level][(currentTick_ >> (SLOT_BITS * level)) & (SLOTS - 1)]);
+    for (const Slot& slot : cascade) {
+      auto it = entries_.find (slot.id);
+      if (it != entries_.end () && it->second.generation == slot.generation)
+        place (slot, it->second.expiresTick);
+    }
+  }
+
+  std::vector<Slot> expired;
+  expired.swap (wheel_[0][currentTick_ & (SLOTS - 1)]);
+  for (const Slot& slot : expired) {
+    auto it = entries_.find (slot.id);
+    if (it == entries_.end () || it->second.generation != slot.generation)
+      continue;
+    if (it->second.expiresTick <= currentTick_) {
+      due.push_back (slot);
+    } else {
+      place (slot, it->second.expiresTick); // parked far-future timer
+    }
+  }
+}
+
+void Scheduler::loop () {
+  std::unique_lock<std::mutex> lock (mutex_);
+  std::vector<Slot> due;
+  while (running_) {
+    if (entries_.empty ()) {
+      // Nothing armed: sleep until a task is added instead of ticking
+      for (auto& level : wheel_)
+        for (auto& slot : level)
+          slot.clear ();
+      wake_.wait (lock, [this] () { return !running_ || !entries_.empty (); });
+      continue;
+    }
+
+    uint64_t nowTick = static_cast<uint64_t> ((Clock::now () - epoch_) / tick_);
+    due.clear ();
+    due.swap (overdue_);
+    while (currentTick_ < nowTick)
+      advance (due);
+
+    if (due.empty ()) {
+      wake_.wait_until (lock, epoch_ + tick_ * static_cast<int64_t> (currentTick_ + 1));
+      continue;
+    }
+
+    for (const Slot& slot : due) {
+      auto it = entries_.find (slot.id);
+      if (it == entries_.end () || it->second.generation != slot.generation)
+        continue;
+
+      DynamicTask run = it->second.run;
+      Clock::time_point started = Clock::now ();
+      auto lateness = toMicros (started - it->second.due);
+      lock.unlock ();
+
+      std::optional<Clock::duration> next;
+      try {
+        next = run ();
+      } catch (const std::exception& e) {
+        LOG_E_STREAM << "Scheduled task failed: " << e.what () << std::endl;
+        next = std::nullopt;
+      }
+
+      lock.lock ();
+      it = entries_.find (slot.id);
+      if (it == entries_.end ())
+        continue; // cancelled while running
+      Entry& entry = it->second;
+      entry.stats.runs++;
+      entry.stats.lastLateness = lateness;
+      entry.stats.maxLateness = std::max (entry.stats.maxLateness, lateness);
+      entry.totalLateness += lateness;
+      entry.stats.meanLateness
+          = entry.totalLateness / static_cast<int64_t> (entry.stats.runs);
+      entry.stats.lastDuration = toMicros (Clock::now () - started);
+
+      if (entry.generation != slot.generation)
+        continue; // rescheduled while running, the new timer is already armed
+      if (next) {
+        arm (slot.id, entry, Clock::now () + *next);
+      } else {
+        entries_.erase (it);
+      }
+    }
+  }
+}
@@ -0,0 +1,99 @@
+#ifndef __SCHEDULER_H__
+#define __SCHEDULER_H__
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Single-threaded scheduler for one-shot and periodic tasks.
+// Timers live in a hierarchical timer wheel (LEVELS levels of SLOTS slots), so arming,
+// cancelling and expiring a timer is O(1) regardless of how many tasks exist. Tasks run on the
+// scheduler thread one after another and should hand long blocking work elsewhere.
+
+class Scheduler {
+public:
+  using Clock = std::chrono::steady_clock;
+  using TaskId = uint64_t;
+  using Task = std::function<void ()>;
+  // Returns the delay before the next run, std::nullopt ends the task
+  using DynamicTask = std::function<std::optional<Clock::duration> ()>;
+
+  static constexpr size_t SLOTS = 64;
+  static constexpr size_t LEVELS = 4;
+
+  struct TaskStats {
+    TaskId id = 0;
+    std::string name;
+    uint64_t runs = 0;
+    std::chrono::microseconds lastLateness{ 0 }; // wake-up latency past the due time
+    std::chrono::microseconds maxLateness{ 0 };
+    std::chrono::microseconds meanLateness{ 0 };
+    std::chrono::microseconds lastDuration{ 0 };
+  };
+
+  explicit Scheduler (Clock::duration tick = std::chrono::milliseconds (100));
+  ~Scheduler ();
+  Scheduler (const Scheduler&) = delete;
+  Scheduler& operator= (const Scheduler&) = delete;
+
+  void start ();
+  void stop (); // waits for a running task to finish, armed timers are kept
+  bool isRunning () const;
+
+  TaskId scheduleOnce (Clock::duration delay, Task task, const std::string& name = "");
+  TaskId scheduleEvery (Clock::duration interval, Task task, const std::string& name = "",
+                        std::optional<Clock::duration> firstDelay = std::nullopt);
+  TaskId scheduleDynamic (Clock::duration firstDelay, DynamicTask task,
+                          const std::string& name = "");
+
+  bool cancel (TaskId id);
+  // Move the next run of a task, a periodic task continues its interval from that run
+  bool reschedule (TaskId id, Clock::duration delay);
+  bool isScheduled (TaskId id) const;
+
+  std::vector<TaskStats> getStats () const;
+
+private:
+  struct Entry {
+    std::string name;
+    DynamicTask run;
+    Clock::time_point due;
+    uint64_t expiresTick = 0;
+    uint64_t generation = 0; // bumped on reschedule, stale wheel slots are skipped
+    TaskStats stats;
+    std::chrono::microseconds totalLateness{ 0 };
+  };
+  struct Slot {
+    TaskId id;
+    uint64_t generation;
+  };
+
+  TaskId add (Clock::duration delay, DynamicTask run, const std::string& name);
+  void arm (TaskId id, Entry& entry, Clock::time_point due);
+  void place (const Slot& slot, uint64_t expiresTick);
+  void advance (std::vector<Slot>& due);
+  uint64_t tickOf (Clock::time_point time) const;
+  void loop ();
+
+  const Clock::duration tick_;
+  const Clock::time_point epoch_;
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  std::thread thread_;
+  bool running_ = false;
+  uint64_t currentTick_ = 0;
+  TaskId nextId_ = 1;
+  std::unordered_map<TaskId, Entry> entries_;
+  std::array<std::array<std::vector<Slot>, SLOTS>, LEVELS> wheel_;
+  std::vector<Slot> overdue_; // armed at or before the current tick
+};
+
+#endif // __SCHEDULER_H__
@@ -0,0 +1,528 @@
+#include "SearchIndex.hpp"
+#include "Tokenizer.hpp"
+#include <Logger/Logger.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <set>
+#include <string_view>
+#include <unordered_set>
+
+namespace {
+  constexpr char SEGMENT_MAGIC[4] = { 'B', 'S', 'I', 'X' };
+  constexpr uint32_t SEGMENT_VERSION = 1;
+  // magic, version, firstDoc, lastDoc, termCount, dictionary offset
+  constexpr std::streamoff SEGMENT_HEADER_SIZE = 4 + 4 + 4 + 4 + 4 + 8;
+
+  template <typename T> void put (std::ostream& out, T value) {
+    char bytes[sizeof (T)];
+    for (size_t i = 0; i < sizeof (T); ++i)
+      bytes[i] = static_cast<char> ((static_cast<uint64_t> (value) >> (8 * i)) & 0xFF);
+    out.write (bytes, sizeof (T));
+  }
+
+  template <typename T> bool get (std::istream& in, T& value) {
+    unsigned char bytes[sizeof (T)];
+    if (!in.read (reinterpret_cast<char*> (bytes), sizeof (T)))
+      return false;
+    uint64_t result = 0;
+    for (size_t i = 0; i < sizeof (T); ++i)
+      result |= static_cast<uint64_t> (bytes[i]) << (8 * i);
+    value = static_cast<T> (result);
+    return true;
+  }
+
+  bool getString (std::istream& in, std::string& value, size_t length) {
+    value.resize (length);
+    return length == 0 || static_cast<bool> (in.read (&value[0], length));
+  }
+
+  void putVarint (std::string& out, uint32_t value) {
+    while (value >= 0x80) {
+      out += static_cast<char> ((value & 0x7F) | 0x80);
+      value >>= 7;
+    }
+    out += static_cast<char> (value);
+  }
+
+  // Sorted doc ids as the first id followed by gaps, each a LEB128 varint
+  std::string encodePostings (const std::vector<uint32_t>& docIds) {
+    std::string out;
+    uint32_t previous = 0;
+    for (size_t i = 0; i < docIds.size (); ++i) {
+      putVarint (out, i == 0 ? docIds[i] : docIds[i] - previous);
+      previous = docIds[i];
+    }
+    return out;
+  }
+
+  std::vector<uint32_t> decodePostings (std::string_view data, uint32_t expected) {
+    std::vector<uint32_t> docIds;
+    docIds.reserve (expected);
+    uint32_t value = 0;
+    int shift = 0;
+    uint32_t previous = 0;
+    for (unsigned char byte : data) {
+      value |= static_cast<uint32_t> (byte & 0x7F) << shift;
+      if (byte & 0x80) {
+        shift += 7;
+        continue;
+      }
+      previous = docIds.empty () ? value : previous + value;
+      docIds.push_back (previous);
+      value = 0;
+      shift = 0;
+    }
+    return docIds;
+  }
+
+  // Cut at a UTF-8 boundary
+  std::string truncateUtf8 (const std::string& text, size_t maxBytes) {
+    if (text.size () <= maxBytes)
+      return text;
+    size_t cut = maxBytes;
+    while (cut > 0 && (static_cast<unsigned char> (text[cut]) & 0xC0) == 0x80)
+      --cut;
+    return text.substr (0, cut);
+  }
+
+  std::string segmentName (uint32_t firstDoc, uint32_t lastDoc) {
+    char name[48];
+    std::snprintf (name, sizeof (name), "seg_%010u_%010u.idx", firstDoc, lastDoc);
+    return name;
+  }
+
+  // floor (log_MERGE_FACTOR (documents)), segments of one tier differ in size by < MERGE_FACTOR x
+  size_t sizeTier (uint32_t documents) {
+    size_t tier = 0;
+    for (; documents >= SearchIndex::MERGE_FACTOR; documents /= SearchIndex::MERGE_FACTOR)
+      ++tier;
+    return tier;
+  }
+
+  // Streams postings first and the dictionary last, so merging never holds all postings
+  class SegmentWriter {
+  public:
+    bool open (const std::filesystem::path& path, uint32_t firstDoc, uint32_t lastDoc) {
+      out_.open (path, std::ios::binary | std::ios::trunc);
+      if (!out_.is_open ())
+        return false;
+      out_.write (SEGMENT_MAGIC, sizeof (SEGMENT_MAGIC));
+      put<uint32_t> (out_, SEGMENT_VERSION);
+      put<uint32_t> (out_, firstDoc);
+      put<uint32_t> (out_, lastDoc);
+      put<uint32_t> (out_, 0); // term count, patched in finish ()
+      put<uint64_t> (out_, 0); // dictionary offset, patched in finish ()
+      return true;
+    }
+
+    void addTerm (const std::string& term, const std::vector<uint32_t>& docIds) {
+      std::string encoded = encodePostings (docIds);
+      dictionary_.push_back ({ term, static_cast<uint32_t> (docIds.size ()),
+                               static_cast<uint64_t> (out_.tellp ()),
+                               static_cast<uint32_t> (encoded.size ()) });
+      out_.write (encoded.data (), static_cast<std::streamsize> (encoded.size ()));
+    }
+
+    bool finish () {
+      uint64_t dictionaryOffset = static_cast<uint64_t> (out_.tellp ());
+      for (const auto& entry : dictionary_) {
+        put<uint16_t> (out_, static_cast<uint16_t> (entry.term.size ()));
+        out_.write (entry.term.data (), static_cast<std::streamsize> (entry.term.size ()));
+        put<uint32_t> (out_, entry.docCount);
+        put<uint64_t> (out_, entry.offset);
+        put<uint32_t> (out_, entry.length);
+      }
+      out_.seekp (4 + 4 + 4 + 4);
+      put<uint32_t> (out_, static_cast<uint32_t> (dictionary_.size ()));
+      put<uint64_t> (out_, dictionaryOffset);
+      out_.flush ();
+      bool ok = out_.good ();
+      out_.close ();
+      return ok;
+    }
+
+  private:
+    struct Entry {
+      std::string term;
+      uint32_t docCount;
+      uint64_t offset;
+      uint32_t length;
+    };
+    std::ofstream out_;
+    std::vector<Entry> dictionary_;
+  };
+}
+
+SearchIndex::~SearchIndex () {
+  close ();
+}
+
+bool SearchIndex::isOpen () const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  return docs_.is_open ();
+}
+
+int SearchIndex::open (const std::filesystem::path& directory) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  directory_ = directory;
+  std::error_code ec;
+  std::filesystem::create_directories (directory_, ec);
+
+  // A crash between the two appends can leave a partial offset entry behind
+  auto offsetsPath = directory_ / "docs.idx";
+  if (std::filesystem::exists (offsetsPath)) {
+    auto size = std::filesystem::file_size (offsetsPath);
+    if (size % sizeof (uint64_t) != 0)
+      std::filesystem::resize_file (offsetsPath, size - size % sizeof (uint64_t));
+  }
+
+  auto mode = std::ios::in | std::ios::out | std::ios::binary | std::ios::app;
+  docs_.open (directory_ / "docs.dat", mode);
+  offsets_.open (offsetsPath, mode);
+  if (!docs_.is_open () || !offsets_.is_open ()) {
+    LOG_E_STREAM << "Cannot open search index in " << directory_ << std::endl;
+    docs_.close ();
+    offsets_.close ();
+    return -1;
+  }
+  documentCount_
+      = static_cast<uint32_t> (std::filesystem::file_size (offsetsPath) / sizeof (uint64_t));
+
+  segments_.clear ();
+  for (const auto& entry : std::filesystem::directory_iterator (directory_)) {
+    std::string name = entry.path ().filename ().string ();
+    if (entry.path ().extension () == ".tmp") {
+      std::filesystem::remove (entry.path (), ec);
+    } else if (name.rfind ("seg_", 0) == 0 && entry.path ().extension () == ".idx") {
+      loadSegment (entry.path ());
+    }
+  }
+
+  // A merge interrupted before deleting its inputs leaves segments covered by the merged one
+  std::sort (segments_.begin (), segments_.end (), [] (const Segment& a, const Segment& b) {
+    return a.firstDoc != b.firstDoc ? a.firstDoc < b.firstDoc : a.lastDoc > b.lastDoc;
+  });
+  std::vector<Segment> kept;
+  for (auto& segment : segments_) {
+    if (!kept.empty () && segment.lastDoc <= kept.back ().lastDoc) {
+      std::filesystem::remove (segment.path, ec);
+      continue;
+    }
+    kept.push_back (std::move (segment));
+  }
+  segments_ = std::move (kept);
+
+  // Documents added after the last flush are recovered from the document store
+  memory_.clear ();
+  memoryFirstDoc_ = segments_.empty () ? 0 : segments_.back ().lastDoc + 1;
+  for (uint32_t docId = memoryFirstDoc_; docId < documentCount_; ++docId) {
+    SearchDocument document;
+    if (readDocument (docId, document))
+      indexTerms (docId, document);
+  }
+
+  LOG_I_STREAM << "Search index: " << documentCount_ << " documents in " << segments_.size ()
+               << " segments, " << (documentCount_ - memoryFirstDoc_) << " recovered."
+               << std::endl;
+  return 0;
+}
+
+void SearchIndex::close () {
+  std::lock_guard<std::mutex> lock (mutex_);
+  if (!docs_.is_open ())
+    return;
+  flushLocked ();
+  docs_.close ();
+  offsets_.close ();
+  segments_.clear ();
+  memory_.clear ();
+}
+
+int SearchIndex::loadSegment (const std::filesystem::path& path) {
+  std::ifstream in (path, std::ios::binary);
+  char magic[4];
+  uint32_t version = 0;
+  Segment segment;
+  uint32_t termCount = 0;
+  uint64_t dictionaryOffset = 0;
+  if (!in.read (magic, sizeof (magic)) || !std::equal (magic, magic + 4, SEGMENT_MAGIC)
+      || !get (in, version) || version != SEGMENT_VERSION || !get (in, segment.firstDoc)
+      || !get (in, segment.lastDoc) || !get (in, termCount) || !get (in, dictionaryOffset)
+      || dictionaryOffset < static_cast<uint64_t> (SEGMENT_HEADER_SIZE)) {
+    LOG_W_STREAM << "Ignoring damaged search segment " << path << std::endl;
+    return -1;
+  }
+
+  in.seekg (static_cast<std::streamoff> (dictionaryOffset));
+  for (uint32_t i = 0; i < termCount; ++i) {
+    uint16_t termLength = 0;
+    std::string term;
+    PostingRef ref{};
+    if (!get (in, termLength) || !getString (in, term, termLength) || !get (in, ref.docCount)
+        || !get (in, ref.offset) || !get (in, ref.length)) {
+      LOG_W_STREAM << "Ignoring truncated search segment " << path << std::endl;
+      return -1;
+    }
+    segment.terms.emplace_hint (segment.terms.end (), std::move (term), ref);
+  }
+  segment.path = path;
+  segments_.push_back (std::move (segment));
+  return 0;
+}
+
+void SearchIndex::indexTerms (uint32_t docId, const SearchDocument& document) {
+  std::vector<std::string> tokens = Search::tokenize (document.title);
+  std::vector<std::string> body = Search::tokenize (document.description);
+  tokens.insert (tokens.end (), body.begin (), body.end ());
+  std::sort (tokens.begin (), tokens.end ());
+  tokens.erase (std::unique (tokens.begin (), tokens.end ()), tokens.end ());
+  for (auto& token : tokens)
+    memory_[std::move (token)].push_back (docId);
+}
+
+int SearchIndex::add (const SearchDocument& document) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  if (!docs_.is_open ())
+    return -1;
+
+  SearchDocument stored = document;
+  stored.title = truncateUtf8 (stored.title, UINT16_MAX);
+  stored.link = truncateUtf8 (stored.link, UINT16_MAX);
+  stored.description = truncateUtf8 (stored.description, MAX_STORED_DESCRIPTION);
+
+  docs_.clear ();
+  docs_.seekp (0, std::ios::end);
+  uint64_t offset = static_cast<uint64_t> (docs_.tellp ());
+  put<uint64_t> (docs_, static_cast<uint64_t> (stored.postedAt));
+  put<uint64_t> (docs_, stored.channelId);
+  put<uint16_t> (docs_, static_cast<uint16_t> (stored.title.size ()));
+  docs_ << stored.title;
+  put<uint16_t> (docs_, static_cast<uint16_t> (stored.link.size ()));
+  docs_ << stored.link;
+  put<uint32_t> (docs_, static_cast<uint32_t> (stored.description.size ()));
+  docs_ << stored.description;
+  docs_.flush ();
+
+  // The offset entry is written last, a document without one is simply not there
+  offsets_.clear ();
+  put<uint64_t> (offsets_, offset);
+  offsets_.flush ();
+  if (!docs_.good () || !offsets_.good ())
+    return -1;
+
+  uint32_t docId = documentCount_++;
+  indexTerms (docId, stored);
+  if (documentCount_ - memoryFirstDoc_ >= FLUSH_DOCS)
+    flushLocked ();
+  return 0;
+}
+
+bool SearchIndex::readDocument (uint32_t docId, SearchDocument& document) const {
+  uint64_t offset = 0;
+  offsets_.clear ();
+  offsets_.seekg (static_cast<std::streamoff> (docId) * sizeof (uint64_t));
+  if (!get (offsets_, offset))
+    return false;
+
+  docs_.clear ();
+  docs_.seekg (static_cast<std::streamoff> (offset));
+  uint64_t postedAt = 0;
+  uint16_t titleLength = 0;
+  uint16_t linkLength = 0;
+  uint32_t descriptionLength = 0;
+  bool ok = get (docs_, postedAt) && get (docs_, document.channelId) && get (docs_, titleLength)
+            && getString (docs_, document.title, titleLength) && get (docs_, linkLength)
+            && getString (docs_, document.link, linkLength) && get (docs_, descriptionLength)
+            && getString (docs_, document.description, descriptionLength);
+  document.postedAt = static_cast<std::time_t> (postedAt);
+  return ok;
+}
+
+int SearchIndex::flush () {
+  std::lock_guard<std::mutex> lock (mutex_);
+  return flushLocked ();
+}
+
+int SearchIndex::flushLocked () {
+  if (documentCount_ == memoryFirstDoc_)
+    return 0;
+
+  uint32_t firstDoc = memoryFirstDoc_;
+  uint32_t lastDoc = documentCount_ - 1;
+  auto path = directory_ / segmentName (firstDoc, lastDoc);
+  auto temporary = path;
+  temporary += ".tmp";
+
+  std::map<std::string, std::vector<uint32_t>*> sorted;
+  for (auto& [term, docIds] : memory_)
+    sorted.emplace (term, &docIds);
+
+  SegmentWriter writer;
+  if (!writer.open (temporary, firstDoc, lastDoc))
+    return -1;
+  for (const auto& [term, docIds] : sorted)
+    writer.addTerm (term, *docIds);
+  if (!writer.finish ()) {
+    LOG_E_STREAM << "Failed to write search segment " << path << std::endl;
+    return -1;
+  }
+  std::filesystem::rename (temporary, path);
+  if (loadSegment (path) != 0)
+    return -1;
+
+  memory_.clear ();
+  memoryFirstDoc_ = documentCount_;
+  return mergeTiers ();
+}
+
+int SearchIndex::mergeTiers () {
+  // Only MERGE_FACTOR adjacent segments of one size tier are merged at a time, the result lands
+  // in the next tier, so a document is rewritten once per tier rather than on every merge
+  for (;;) {
+    size_t begin = segments_.size ();
+    size_t run = 1;
+    for (size_t i = 1; i < segments_.size () && begin == segments_.size (); ++i) {
+      bool sameTier = sizeTier (segments_[i].lastDoc - segments_[i].firstDoc + 1)
+                      == sizeTier (segments_[i - 1].lastDoc - segments_[i - 1].firstDoc + 1);
+      run = sameTier ? run + 1 : 1;
+      if (run == MERGE_FACTOR)
+        begin = i + 1 - MERGE_FACTOR;
+    }
+    if (begin == segments_.size ())
+      return 0;
+    if (mergeSegments (begin, begin + MERGE_FACTOR) != 0)
+      return -1;
+  }
+}
+
+int SearchIndex::mergeSegments (size_t begin, size_t end) {
+  std::set<std::string_view> terms;
+  for (size_t i = begin; i < end; ++i)
+    for (const auto& entry : segments_[i].terms)
+      terms.insert (entry.first);
+
+  uint32_t firstDoc = segments_[begin].firstDoc;
+  uint32_t lastDoc = segments_[end - 1].lastDoc;
+  auto path = directory_ / segmentName (firstDoc, lastDoc);
+  auto temporary = path;
+  temporary += ".tmp";
+
+  std::vector<std::ifstream> inputs;
+  for (size_t i = begin; i < end; ++i)
+    inputs.emplace_back (segments_[i].path, std::ios::binary);
+
+  SegmentWriter writer;
+  if (!writer.open (temporary, firstDoc, lastDoc))
+    return -1;
+  // Segments cover ascending, disjoint doc ranges, so concatenation keeps postings sorted
+  for (std::string_view term : terms) {
+    std::vector<uint32_t> merged;
+    for (size_t i = begin; i < end; ++i) {
+      auto ref = segments_[i].terms.find (term);
+      if (ref == segments_[i].terms.end ())
+        continue;
+      std::string data;
+      inputs[i - begin].seekg (static_cast<std::streamoff> (ref->second.offset));
+      getString (inputs[i - begin], data, ref->second.length);
+      auto docIds = decodePostings (data, ref->second.docCount);
+      merged.insert (merged.end (), docIds.begin (), docIds.end ());
+    }
+    writer.addTerm (std::string (term), merged);
+  }
+  inputs.clear ();
+  if (!writer.finish ()) {
+    LOG_E_STREAM << "Failed to merge search segments" << std::endl;
+    return -1;
+  }
+
+  std::filesystem::rename (temporary, path);
+  std::vector<std::filesystem::path> obsolete;
+  for (size_t i = begin; i < end; ++i)
+    if (segments_[i].path != path)
+      obsolete.push_back (segments_[i].path);
+  segments_.erase (segments_.begin () + begin, segments_.begin () + end);
+  if (loadSegment (path) != 0)
+    return -1;
+  // loadSegment appends, the merged segment takes the place of its inputs
+  std::rotate (segments_.begin () + begin, segments_.end () - 1, segments_.end ());
+  std::error_code ec;
+  for (const auto& old : obsolete)
+    std::filesystem::remove (old, ec);
+
+  LOG_I_STREAM << "Merged " << (end - begin) << " search segments into one with "
+               << terms.size () << " terms." << std::endl;
+  return 0;
+}
+
+std::vector<uint32_t> SearchIndex::readPostings (const Segment& segment,
+                                                 const PostingRef& ref) const {
+  std::ifstream in (segment.path, std::ios::binary);
+  std::string data;
+  in.seekg (static_cast<std::streamoff> (ref.offset));
+  if (!getString (in, data, ref.length))
+    return {};
+  return decodePostings (data, ref.docCount);
+}
+
+std::vector<uint32_t> SearchIndex::postingsFor (const std::string& term) const {
+  std::vector<uint32_t> docIds;
+  for (const auto& segment : segments_) {
+    auto ref = segment.terms.find (term);
+    if (ref == segment.terms.end ())
+      continue;
+    auto part = readPostings (segment, ref->second);
+    docIds.insert (docIds.end (), part.begin (), part.end ());
+  }
+  auto recent = memory_.find (term);
+  if (recent != memory_.end ())
+    docIds.insert (docIds.end (), recent->second.begin (), recent->second.end ());
+  return docIds;
+}
+
+std::vector<SearchHit> SearchIndex::search (const std::string& query, size_t limit) const {
+  std::vector<std::string> terms = Search::tokenize (query);
+  std::sort (terms.begin (), terms.end ());
+  terms.erase (std::unique (terms.begin (), terms.end ()), terms.end ());
+
+  std::lock_guard<std::mutex> lock (mutex_);
+  if (terms.empty () || !docs_.is_open ())
+    return {};
+
+  std::vector<std::vector<uint32_t>> lists;
+  for (const auto& term : terms) {
+    lists.push_back (postingsFor (term));
+    if (lists.back ().empty ())
+      return {};
+  }
+  // Intersect starting from the rarest term
+  std::sort (lists.begin (), lists.end (),
+             [] (const auto& a, const auto& b) { return a.size () < b.size (); });
+  std::vector<uint32_t> matches = lists.front ();
+  for (size_t i = 1; i < lists.size () && !matches.empty (); ++i) {
+    std::vector<uint32_t> next;
+    std::set_intersection (matches.begin (), matches.end (), lists[i].begin (), lists[i].end (),
+                           std::back_inserter (next));
+    matches.swap (next);
+  }
+
+  // Newest first; the same link delivered to several channels is reported once
+  std::vector<SearchHit> hits;
+  std::unordered_set<std::string> links;
+  for (auto it = matches.rbegin (); it != matches.rend () && hits.size () < limit; ++it) {
+    SearchHit hit;
+    hit.docId = *it;
+    if (readDocument (*it, hit.document) && links.insert (hit.document.link).second)
+      hits.push_back (std::move (hit));
+  }
+  return hits;
+}
+
+size_t SearchIndex::getDocumentCount () const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  return documentCount_;
+}
+
+size_t SearchIndex::getSegmentCount () const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  return segments_.size ();
+}
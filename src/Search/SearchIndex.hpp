@@ -0,0 +1,99 @@
+#ifndef __SEARCHINDEX_H__
+#define __SEARCHINDEX_H__
+
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Embedded inverted index over delivered items.
+//
+// docs.dat      append-only document store, the source of truth and the recovery log
+// docs.idx      fixed 8-byte offsets of each document in docs.dat
+// seg_*.idx     immutable segments: sorted term dictionary + varint delta-coded postings
+//
+// New documents go to an in-memory segment that is flushed every FLUSH_DOCS documents;
+// documents written after the last flush are re-tokenized from docs.dat on open. Only the
+// term dictionaries stay in memory, postings are read from disk per query. Adjacent segments of
+// a similar size are merged MERGE_FACTOR at a time, so the segment count grows logarithmically.
+
+struct SearchDocument {
+  std::string title;
+  std::string link;
+  std::string description;
+  uint64_t channelId = 0;
+  std::time_t postedAt = 0;
+};
+
+struct SearchHit {
+  uint32_t docId = 0;
+  SearchDocument document;
+};
+
+class SearchIndex {
+public:
+  static constexpr size_t FLUSH_DOCS = 512;
+  static constexpr size_t MERGE_FACTOR = 4;
+  static constexpr size_t MAX_STORED_DESCRIPTION = 1024;
+
+  SearchIndex () = default;
+  ~SearchIndex ();
+  SearchIndex (const SearchIndex&) = delete;
+  SearchIndex& operator= (const SearchIndex&) = delete;
+
+  /**
+   * @brief Open or create the index in a directory.
+   * @return 0 on success, -1 on failure.
+   */
+  int open (const std::filesystem::path& directory);
+  void close ();
+  bool isOpen () const;
+
+  int add (const SearchDocument& document);
+  // Documents containing every query term, newest first, one hit per link
+  std::vector<SearchHit> search (const std::string& query, size_t limit = 10) const;
+
+  int flush (); // write the in-memory segment out
+  size_t getDocumentCount () const;
+  size_t getSegmentCount () const;
+
+private:
+  struct PostingRef {
+    uint32_t docCount;
+    uint64_t offset;
+    uint32_t length;
+  };
+  struct Segment {
+    std::filesystem::path path;
+    uint32_t firstDoc;
+    uint32_t lastDoc;
+    std::map<std::string, PostingRef, std::less<>> terms;
+  };
+
+  int loadSegment (const std::filesystem::path& path);
+  int writeSegment (const std::map<std::string, std::vector<uint32_t>>& postings, uint32_t firstDoc,
+                    uint32_t lastDoc);
+  int flushLocked ();
+  int mergeTiers ();
+  int mergeSegments (size_t begin, size_t end); // [begin, end) of segments_
+  std::vector<uint32_t> readPostings (const Segment& segment, const PostingRef& ref) const;
+  std::vector<uint32_t> postingsFor (const std::string& term) const;
+  bool readDocument (uint32_t docId, SearchDocument& document) const;
+  void indexTerms (uint32_t docId, const SearchDocument& document);
+
+  mutable std::mutex mutex_;
+  std::filesystem::path directory_;
+  mutable std::fstream docs_;
+  mutable std::fstream offsets_;
+  uint32_t documentCount_ = 0;
+  std::vector<Segment> segments_; // ordered by firstDoc
+  std::unordered_map<std::string, std::vector<uint32_t>> memory_;
+  uint32_t memoryFirstDoc_ = 0;
+};
+
+#endif // __SEARCHINDEX_H__
@@ -0,0 +1,109 @@
+#include "Tokenizer.hpp"
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+  // U+00C0..U+017F folded to a base letter, ' ' marks a separator (multiplication, division)
+  constexpr char LATIN_FOLD[] = "aaaaaaaceeeeiiiidnooooo ouuuuyts"
+                                "aaaaaaaceeeeiiiidnooooo ouuuuyty"
+                                "aaaaaaccccccccddddeeeeeeeeeegggg"
+                                "gggghhhhiiiiiiiiiiiijjkkklllllll"
+                                "lllnnnnnnnnnoooooooorrrrrrssssss"
+                                "ssttttttuuuuuuuuuuuuwwyyyzzzzzzs";
+  static_assert (sizeof (LATIN_FOLD) == 0x180 - 0xC0 + 1, "one entry per code point");
+
+  size_t sequenceLength (unsigned char lead) {
+    if (lead < 0x80)
+      return 1;
+    if ((lead & 0xE0) == 0xC0)
+      return 2;
+    if ((lead & 0xF0) == 0xE0)
+      return 3;
+    if ((lead & 0xF8) == 0xF0)
+      return 4;
+    return 1; // stray continuation byte
+  }
+
+  // Appends the folded form of the code point at text[pos], returns false for separators
+  bool foldCodePoint (std::string_view text, size_t pos, size_t length, std::string& out) {
+    unsigned char c = static_cast<unsigned char> (text[pos]);
+    if (length == 1) {
+      if (c >= 'A' && c <= 'Z') {
+        out += static_cast<char> (c + ('a' - 'A'));
+        return true;
+      }
+      if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) {
+        out += static_cast<char> (c);
+        return true;
+      }
+      return false;
+    }
+
+    uint32_t codePoint = 0;
+    if (length == 2) {
+      codePoint = ((c & 0x1Fu) << 6) | (static_cast<unsigned char> (text[pos + 1]) & 0x3Fu);
+    } else if (length == 3) {
+      codePoint = ((c & 0x0Fu) << 12) | ((static_cast<unsigned char> (text[pos + 1]) & 0x3Fu) << 6)
+                  | (static_cast<unsigned char> (text[pos + 2]) & 0x3Fu);
+    }
+
+    if (codePoint >= 0xC0 && codePoint < 0x180) {
+      char folded = LATIN_FOLD[codePoint - 0xC0];
+      if (folded == ' ')
+        return false;
+      out += folded;
+      return true;
+    }
+    // no-break space, Latin-1 punctuation and General Punctuation (dashes, quotes)
+    if ((codePoint >= 0x80 && codePoint < 0xC0) || (codePoint >= 0x2000 && codePoint < 0x2070))
+      return false;
+
+    out.append (text.substr (pos, length));
+    return true;
+  }
+}
+
+namespace Search {
+
+  std::string fold (std::string_view text) {
+    std::string out;
+    out.reserve (text.size ());
+    for (size_t pos = 0; pos < text.size ();) {
+      size_t length = std::min (sequenceLength (static_cast<unsigned char> (text[pos])),
+                                text.size () - pos);
+      if (!foldCodePoint (text, pos, length, out))
+        out.append (text.substr (pos, length));
+      pos += length;
+    }
+    return out;
+  }
+
+  std::vector<std::string> tokenize (std::string_view text) {
+    std::vector<std::string> tokens;
+    std::string token;
+    auto finish = [&] () {
+      if (!token.empty () && token.size () <= MAX_TOKEN_LENGTH)
+        tokens.push_back (token);
+      token.clear ();
+    };
+
+    bool inMarkup = false;
+    for (size_t pos = 0; pos < text.size ();) {
+      size_t length = std::min (sequenceLength (static_cast<unsigned char> (text[pos])),
+                                text.size () - pos);
+      char c = text[pos];
+      if (inMarkup) {
+        inMarkup = c != '>';
+      } else if (c == '<') {
+        finish ();
+        inMarkup = true;
+      } else if (!foldCodePoint (text, pos, length, token)) {
+        finish ();
+      }
+      pos += length;
+    }
+    finish ();
+    return tokens;
+  }
+
+} // namespace Search
@@ -0,0 +1,22 @@
+#ifndef __TOKENIZER_H__
+#define __TOKENIZER_H__
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Search tokenizer for Czech and Slovak text.
+// Tokens are lower-cased and stripped of diacritics (Latin-1 Supplement and Latin Extended-A),
+// so "Příliš žluťoučký" and "prilis zlutoucky" produce the same terms. Markup between '<' and
+// '>' is skipped, other scripts are kept as raw UTF-8.
+
+namespace Search {
+
+  constexpr size_t MAX_TOKEN_LENGTH = 64;
+
+  std::string fold (std::string_view text);
+  std::vector<std::string> tokenize (std::string_view text);
+
+} // namespace Search
+
+#endif // __TOKENIZER_H__
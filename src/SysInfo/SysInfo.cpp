@@ -0,0 +1,310 @@
+#include "SysInfo.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <sys/statvfs.h>
+#include <sys/utsname.h>
+
+namespace SysInfo {
+
+  namespace {
+    std::string readFile (const std::string& path) {
+      std::ifstream file (path);
+      if (!file.is_open ())
+        return "";
+      std::ostringstream content;
+      content << file.rdbuf ();
+      return content.str ();
+    }
+
+    std::string trim (const std::string& text) {
+      size_t first = text.find_first_not_of (" \t\r\n");
+      if (first == std::string::npos)
+        return "";
+      size_t last = text.find_last_not_of (" \t\r\n");
+      return text.substr (first, last - first + 1);
+    }
+
+    // 1024-based value with one decimal below 10, e.g. 9.8 or 468
+    std::string scaled (uint64_t bytes, const char* const* units, size_t unitCount) {
+      double value = static_cast<double> (bytes);
+      size_t unit = 0;
+      while (value >= 1024.0 && unit + 1 < unitCount) {
+        value /= 1024.0;
+        unit++;
+      }
+      char text[32];
+      if (unit == 0)
+        std::snprintf (text, sizeof (text), "%llu%s", static_cast<unsigned long long> (bytes),
+                       units[0]);
+      else if (value < 10.0)
+        std::snprintf (text, sizeof (text), "%.1f%s", value, units[unit]);
+      else
+        std::snprintf (text, sizeof (text), "%.0f%s", value, units[unit]);
+      return text;
+    }
+
+    unsigned percent (uint64_t part, uint64_t whole) {
+      return whole == 0 ? 0 : static_cast<unsigned> ((part * 100 + whole - 1) / whole);
+    }
+  }
+
+  MemInfo parseMemInfo (const std::string& text) {
+    MemInfo memory;
+    uint64_t reclaimable = 0;
+    std::istringstream lines (text);
+    std::string key;
+    uint64_t value = 0;
+    std::string unit;
+    std::string line;
+    while (std::getline (lines, line)) {
+      std::istringstream fields (line);
+      if (!(fields >> key >> value))
+        continue;
+      if (key == "MemTotal:")
+        memory.totalKb = value;
+      else if (key == "MemFree:")
+        memory.freeKb = value;
+      else if (key == "MemAvailable:")
+        memory.availableKb = value;
+      else if (key == "Buffers:")
+        memory.buffersKb = value;
+      else if (key == "Cached:")
+        memory.cachedKb = value;
+      else if (key == "SReclaimable:")
+        reclaimable = value;
+      else if (key == "Shmem:")
+        memory.sharedKb = value;
+      else if (key == "SwapTotal:")
+        memory.swapTotalKb = value;
+      else if (key == "SwapFree:")
+        memory.swapFreeKb = value;
+    }
+    memory.cachedKb += reclaimable;
+    return memory;
+  }
+
+  LoadAvg parseLoadAvg (const std::string& text) {
+    LoadAvg load;
+    std::istringstream fields (text);
+    std::string tasks;
+    fields >> load.one >> load.five >> load.fifteen >> tasks;
+    size_t slash = tasks.find ('/');
+    if (slash != std::string::npos) {
+      load.running = static_cast<unsigned> (std::strtoul (tasks.c_str (), nullptr, 10));
+      load.total = static_cast<unsigned> (std::strtoul (tasks.c_str () + slash + 1, nullptr, 10));
+    }
+    return load;
+  }
+
+  CpuInfo parseCpuInfo (const std::string& text) {
+    CpuInfo cpu;
+    std::istringstream lines (text);
+    std::string line;
+    while (std::getline (lines, line)) {
+      size_t colon = line.find (':');
+      if (colon == std::string::npos)
+        continue;
+      std::string key = trim (line.substr (0, colon));
+      if (key == "processor")
+        cpu.threads++;
+      else if (cpu.model.empty () && (key == "model name" || key == "Model"))
+        cpu.model = trim (line.substr (colon + 1));
+    }
+    return cpu;
+  }
+
+  std::map<std::string, std::string> parseOsRelease (const std::string& text) {
+    std::map<std::string, std::string> fields;
+    std::istringstream lines (text);
+    std::string line;
+    while (std::getline (lines, line)) {
+      size_t equals = line.find ('=');
+      if (line.empty () || line[0] == '#' || equals == std::string::npos)
+        continue;
+      std::string value = trim (line.substr (equals + 1));
+      if (value.size () >= 2 && (value.front () == '"' || value.front () == '\'')
+          && value.back () == value.front ())
+        value = value.substr (1, value.size () - 2);
+      fields[trim (line.substr (0, equals))] = value;
+    }
+    return fields;
+  }
+
+  std::vector<std::pair<std::string, std::string>> parseMounts (const std::string& text) {
+    std::vector<std::pair<std::string, std::string>> mounts;
+    std::istringstream lines (text);
+    std::string line;
+    while (std::getline (lines, line)) {
+      std::istringstream fields (line);
+      std::string device, mountPoint;
+      if (!(fields >> device >> mountPoint) || device.empty () || device[0] != '/')
+        continue; // proc, tmpfs, overlay and friends
+      bool known = false;
+      for (const auto& mount : mounts)
+        known = known || mount.first == device;
+      if (!known)
+        mounts.emplace_back (device, mountPoint);
+    }
+    return mounts;
+  }
+
+  std::string formatDf (uint64_t bytes) {
+    static const char* const units[] = { "", "K", "M", "G", "T", "P" };
+    return scaled (bytes, units, 6);
+  }
+
+  std::string formatFree (uint64_t bytes) {
+    static const char* const units[] = { "B", "Ki", "Mi", "Gi", "Ti", "Pi" };
+    return scaled (bytes, units, 6);
+  }
+
+  std::string formatUptime (uint64_t seconds) {
+    uint64_t days = seconds / 86400;
+    uint64_t hours = seconds % 86400 / 3600;
+    uint64_t mins = seconds % 3600 / 60;
+    std::string text;
+    if (days > 0)
+      text += std::to_string (days) + (days == 1 ? " day, " : " days, ");
+    if (days > 0 || hours > 0)
+      text += std::to_string (hours) + (hours == 1 ? " hour, " : " hours, ");
+    text += std::to_string (mins) + (mins == 1 ? " min" : " mins");
+    return text;
+  }
+
+  std::string renderFree (const MemInfo& memory) {
+    auto column = [] (uint64_t kb) {
+      char text[16];
+      std::snprintf (text, sizeof (text), "%12s", formatFree (kb * 1024).c_str ());
+      return std::string (text);
+    };
+    uint64_t used = memory.totalKb > memory.availableKb ? memory.totalKb - memory.availableKb : 0;
+    std::string text
+        = "               total        used        free      shared  buff/cache   available\n";
+    text += "Mem:   " + column (memory.totalKb) + column (used) + column (memory.freeKb)
+            + column (memory.sharedKb) + column (memory.buffersKb + memory.cachedKb)
+            + column (memory.availableKb) + "\n";
+    text += "Swap:  " + column (memory.swapTotalKb)
+            + column (memory.swapTotalKb - std::min (memory.swapFreeKb, memory.swapTotalKb))
+            + column (memory.swapFreeKb) + "\n";
+    return text;
+  }
+
+  std::string renderDf (const std::vector<FsUsage>& filesystems) {
+    std::string text = "Filesystem      Size  Used Avail Use% Mounted on\n";
+    for (const auto& fs : filesystems) {
+      char line[512];
+      std::snprintf (line, sizeof (line), "%-15s %5s %5s %5s %3u%% %s\n", fs.device.c_str (),
+                     formatDf (fs.size).c_str (), formatDf (fs.used).c_str (),
+                     formatDf (fs.available).c_str (), percent (fs.used, fs.used + fs.available),
+                     fs.mountPoint.c_str ());
+      text += line;
+    }
+    return text;
+  }
+
+  Collector::Collector (std::chrono::milliseconds ttl) : ttl_ (ttl) {
+  }
+
+  std::string Collector::get (Report report) {
+    auto now = std::chrono::steady_clock::now ();
+    {
+      std::lock_guard<std::mutex> lock (mutex_);
+      auto it = cache_.find (report);
+      if (it != cache_.end () && now - it->second.renderedAt < ttl_)
+        return it->second.text;
+    }
+    std::string text = render (report);
+    std::lock_guard<std::mutex> lock (mutex_);
+    cache_[report] = Entry{ text, now };
+    return text;
+  }
+
+  void Collector::refresh () {
+    for (Report report : { Report::Summary, Report::Memory, Report::Disks, Report::OsRelease }) {
+      std::string text = render (report);
+      std::lock_guard<std::mutex> lock (mutex_);
+      cache_[report] = Entry{ std::move (text), std::chrono::steady_clock::now () };
+    }
+  }
+
+  std::string Collector::render (Report report) const {
+    switch (report) {
+    case Report::Summary:
+      return renderSummary ();
+    case Report::Memory:
+      return renderFree (parseMemInfo (readFile ("/proc/meminfo")));
+    case Report::Disks:
+      return renderDf (readFilesystems ());
+    case Report::OsRelease:
+      return readFile ("/etc/os-release");
+    }
+    return "";
+  }
+
+  std::vector<FsUsage> Collector::readFilesystems () const {
+    std::vector<FsUsage> filesystems;
+    for (const auto& [device, mountPoint] : parseMounts (readFile ("/proc/mounts"))) {
+      struct statvfs stats;
+      if (statvfs (mountPoint.c_str (), &stats) != 0 || stats.f_blocks == 0)
+        continue;
+      FsUsage fs;
+      fs.device = device;
+      fs.mountPoint = mountPoint;
+      fs.size = static_cast<uint64_t> (stats.f_blocks) * stats.f_frsize;
+      fs.used = static_cast<uint64_t> (stats.f_blocks - stats.f_bfree) * stats.f_frsize;
+      fs.available = static_cast<uint64_t> (stats.f_bavail) * stats.f_frsize;
+      filesystems.push_back (fs);
+    }
+    return filesystems;
+  }
+
+  std::string Collector::renderSummary () const {
+    std::string text;
+    struct utsname system;
+    bool haveUname = uname (&system) == 0;
+
+    auto os = parseOsRelease (readFile ("/etc/os-release"));
+    std::string osName = os.count ("PRETTY_NAME") ? os["PRETTY_NAME"] : os["NAME"];
+    if (!osName.empty ())
+      text += "OS: " + osName + (haveUname ? std::string (" ") + system.machine : "") + "\n";
+    if (haveUname) {
+      text += "Host: " + std::string (system.nodename) + "\n";
+      text += "Kernel: " + std::string (system.sysname) + " " + system.release + "\n";
+    }
+
+    double uptime = 0;
+    std::istringstream (readFile ("/proc/uptime")) >> uptime;
+    if (uptime > 0)
+      text += "Uptime: " + formatUptime (static_cast<uint64_t> (uptime)) + "\n";
+
+    CpuInfo cpu = parseCpuInfo (readFile ("/proc/cpuinfo"));
+    if (!cpu.model.empty ())
+      text += "CPU: " + cpu.model + " (" + std::to_string (cpu.threads) + ")\n";
+
+    LoadAvg load = parseLoadAvg (readFile ("/proc/loadavg"));
+    char line[128];
+    std::snprintf (line, sizeof (line), "Load: %.2f %.2f %.2f\n", load.one, load.five,
+                   load.fifteen);
+    text += line;
+
+    MemInfo memory = parseMemInfo (readFile ("/proc/meminfo"));
+    if (memory.totalKb > 0) {
+      uint64_t used = memory.totalKb - std::min (memory.availableKb, memory.totalKb);
+      text += "Memory: " + formatFree (used * 1024) + " / " + formatFree (memory.totalKb * 1024)
+              + " (" + std::to_string (percent (used, memory.totalKb)) + "%)\n";
+    }
+
+    struct statvfs root;
+    if (statvfs ("/", &root) == 0 && root.f_blocks > 0) {
+      uint64_t used = static_cast<uint64_t> (root.f_blocks - root.f_bfree) * root.f_frsize;
+      uint64_t available = static_cast<uint64_t> (root.f_bavail) * root.f_frsize;
+      text += "Disk (/): " + formatFree (used) + " / " + formatFree (used + available) + " ("
+              + std::to_string (percent (used, used + available)) + "%)\n";
+    }
+    return text;
+  }
+
+} // namespace SysInfo
@@ -0,0 +1,95 @@
+#ifndef __SYSINFO_H__
+#define __SYSINFO_H__
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// System information read straight from /proc, statvfs and uname instead of spawning
+// fastfetch, df or free. Reports are rendered into text and cached for a short TTL; refresh ()
+// re-renders all of them, so a periodic task keeps the commands answering from memory.
+
+namespace SysInfo {
+
+  struct MemInfo {
+    uint64_t totalKb = 0;
+    uint64_t freeKb = 0;
+    uint64_t availableKb = 0;
+    uint64_t buffersKb = 0;
+    uint64_t cachedKb = 0; // Cached + SReclaimable, as free counts it
+    uint64_t sharedKb = 0;
+    uint64_t swapTotalKb = 0;
+    uint64_t swapFreeKb = 0;
+  };
+
+  struct LoadAvg {
+    double one = 0, five = 0, fifteen = 0;
+    unsigned running = 0;
+    unsigned total = 0;
+  };
+
+  struct CpuInfo {
+    std::string model;
+    unsigned threads = 0;
+  };
+
+  struct FsUsage {
+    std::string device;
+    std::string mountPoint;
+    uint64_t size = 0; // bytes
+    uint64_t used = 0;
+    uint64_t available = 0;
+  };
+
+  // Parsers take the file contents, so they work on captured samples as well
+  MemInfo parseMemInfo (const std::string& text);
+  LoadAvg parseLoadAvg (const std::string& text);
+  CpuInfo parseCpuInfo (const std::string& text);
+  std::map<std::string, std::string> parseOsRelease (const std::string& text);
+  // device and mount point of block device mounts, first mount of a device only
+  std::vector<std::pair<std::string, std::string>> parseMounts (const std::string& text);
+
+  // "9.8G" / "468G" as df -h, "5.1Gi" / "512Mi" as free -h
+  std::string formatDf (uint64_t bytes);
+  std::string formatFree (uint64_t bytes);
+  std::string formatUptime (uint64_t seconds);
+
+  std::string renderFree (const MemInfo& memory);
+  std::string renderDf (const std::vector<FsUsage>& filesystems);
+
+  enum class Report {
+    Summary,   // fastfetch-like overview
+    Memory,    // free -h
+    Disks,     // df -h
+    OsRelease, // cat /etc/os-release
+  };
+
+  class Collector {
+  public:
+    explicit Collector (std::chrono::milliseconds ttl = std::chrono::seconds (10));
+
+    // Cached text, rendered on the spot when older than the TTL
+    std::string get (Report report);
+    // Re-render every report, meant for a background task
+    void refresh ();
+
+  private:
+    std::string render (Report report) const;
+    std::string renderSummary () const;
+    std::vector<FsUsage> readFilesystems () const;
+
+    struct Entry {
+      std::string text;
+      std::chrono::steady_clock::time_point renderedAt;
+    };
+    const std::chrono::milliseconds ttl_;
+    std::mutex mutex_;
+    std::map<Report, Entry> cache_;
+  };
+
+} // namespace SysInfo
+
+#endif // __SYSINFO_H__
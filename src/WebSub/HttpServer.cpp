@@ -0,0 +1,268 @@
+#include "HttpServer.hpp"
+#include <Logger/Logger.hpp>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cctype>
+#include <cstring>
+
+namespace {
+  constexpr size_t MAX_HEADER_SIZE = 16 * 1024;
+  constexpr size_t MAX_BODY_SIZE = 4 * 1024 * 1024; // plenty for a fat-ping feed document
+  constexpr int ACCEPT_POLL_MS = 250;                // how quickly stop () is noticed
+  constexpr int SEND_TIMEOUT_SEC = 5;
+
+  std::string toLower (std::string text) {
+    for (auto& c : text)
+      c = static_cast<char> (std::tolower (static_cast<unsigned char> (c)));
+    return text;
+  }
+
+  std::string trim (std::string_view text) {
+    size_t start = text.find_first_not_of (" \t");
+    if (start == std::string_view::npos)
+      return "";
+    size_t end = text.find_last_not_of (" \t\r");
+    return std::string (text.substr (start, end - start + 1));
+  }
+
+  const char* reasonPhrase (int status) {
+    switch (status) {
+    case 200:
+      return "OK";
+    case 202:
+      return "Accepted";
+    case 204:
+      return "No Content";
+    case 400:
+      return "Bad Request";
+    case 404:
+      return "Not Found";
+    case 405:
+      return "Method Not Allowed";
+    case 413:
+      return "Payload Too Large";
+    default:
+      return status < 400 ? "OK" : "Error";
+    }
+  }
+
+  // recv bounded by the deadline of the whole request, not per call, 0 once it passed
+  ssize_t recvBefore (int fd, char* buffer, size_t size,
+                      std::chrono::steady_clock::time_point deadline) {
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds> (
+        deadline - std::chrono::steady_clock::now ());
+    if (left.count () <= 0)
+      return 0;
+    pollfd pfd{ fd, POLLIN, 0 };
+    if (::poll (&pfd, 1, static_cast<int> (left.count ())) <= 0)
+      return 0;
+    return ::recv (fd, buffer, size, 0);
+  }
+
+  bool sendAll (int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size ()) {
+      ssize_t n = ::send (fd, data.data () + sent, data.size () - sent, MSG_NOSIGNAL);
+      if (n <= 0)
+        return false;
+      sent += static_cast<size_t> (n);
+    }
+    return true;
+  }
+}
+
+std::string HttpRequest::header (const std::string& name) const {
+  auto it = headers.find (toLower (name));
+  return it != headers.end () ? it->second : "";
+}
+
+std::string HttpRequest::param (const std::string& name) const {
+  auto it = query.find (name);
+  return it != query.end () ? it->second : "";
+}
+
+HttpServer::~HttpServer () {
+  stop ();
+}
+
+int HttpServer::start (const std::string& bindAddress, uint16_t port, Handler handler) {
+  if (running_.load ())
+    return -1;
+
+  listenFd_ = ::socket (AF_INET, SOCK_STREAM, 0);
+  if (listenFd_ < 0) {
+    LOG_E_STREAM << "HttpServer: socket() failed: " << std::strerror (errno) << std::endl;
+    return -1;
+  }
+  int reuse = 1;
+  ::setsockopt (listenFd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof (reuse));
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons (port);
+  if (::inet_pton (AF_INET, bindAddress.c_str (), &addr.sin_addr) != 1) {
+    LOG_E_STREAM << "HttpServer: invalid bind address: " << bindAddress << std::endl;
+    ::close (listenFd_);
+    listenFd_ = -1;
+    return -1;
+  }
+  if (::bind (listenFd_, reinterpret_cast<sockaddr*> (&addr), sizeof (addr)) != 0
+      || ::listen (listenFd_, 16) != 0) {
+    LOG_E_STREAM << "HttpServer: cannot listen on " << bindAddress << ":" << port << ": "
+                 << std::strerror (errno) << std::endl;
+    ::close (listenFd_);
+    listenFd_ = -1;
+    return -1;
+  }
+
+  socklen_t len = sizeof (addr);
+  ::getsockname (listenFd_, reinterpret_cast<sockaddr*> (&addr), &len);
+  port_ = ntohs (addr.sin_port);
+
+  handler_ = std::move (handler);
+  running_.store (true);
+  thread_ = std::thread (&HttpServer::run, this);
+  LOG_I_STREAM << "HttpServer listening on " << bindAddress << ":" << port_ << std::endl;
+  return 0;
+}
+
+void HttpServer::stop () {
+  if (!running_.exchange (false))
+    return;
+  if (thread_.joinable ())
+    thread_.join ();
+  ::close (listenFd_);
+  listenFd_ = -1;
+  LOG_I_STREAM << "HttpServer on port " << port_ << " stopped" << std::endl;
+}
+
+void HttpServer::run () {
+  while (running_.load ()) {
+    pollfd pfd{ listenFd_, POLLIN, 0 };
+    if (::poll (&pfd, 1, ACCEPT_POLL_MS) <= 0)
+      continue;
+    int clientFd = ::accept (listenFd_, nullptr, nullptr);
+    if (clientFd < 0)
+      continue;
+    timeval timeout{ SEND_TIMEOUT_SEC, 0 };
+    ::setsockopt (clientFd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof (timeout));
+    try {
+      handleConnection (clientFd);
+    } catch (const std::exception& e) {
+      LOG_E_STREAM << "HttpServer: exception while handling request: " << e.what () << std::endl;
+    }
+    ::close (clientFd);
+  }
+}
+
+void HttpServer::handleConnection (int clientFd) {
+  auto deadline = std::chrono::steady_clock::now () + requestTimeout_;
+  std::string data;
+  char buffer[4096];
+  size_t headerEnd = std::string::npos;
+
+  // headers
+  while (headerEnd == std::string::npos) {
+    ssize_t n = recvBefore (clientFd, buffer, sizeof (buffer), deadline);
+    if (n <= 0)
+      return;
+    data.append (buffer, static_cast<size_t> (n));
+    headerEnd = data.find ("\r\n\r\n");
+    if (headerEnd == std::string::npos && data.size () > MAX_HEADER_SIZE)
+      return;
+  }
+
+  HttpRequest request;
+  std::string_view head (data.data (), headerEnd);
+  size_t lineEnd = head.find ("\r\n");
+  std::string_view requestLine = head.substr (0, lineEnd);
+
+  size_t sp1 = requestLine.find (' ');
+  size_t sp2 = requestLine.find (' ', sp1 + 1);
+  if (sp1 == std::string_view::npos || sp2 == std::string_view::npos) {
+    sendAll (clientFd, "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+    return;
+  }
+  request.method = std::string (requestLine.substr (0, sp1));
+  std::string_view target = requestLine.substr (sp1 + 1, sp2 - sp1 - 1);
+  size_t qmark = target.find ('?');
+  request.path = urlDecode (target.substr (0, qmark));
+  if (qmark != std::string_view::npos)
+    request.query = parseQuery (target.substr (qmark + 1));
+
+  while (lineEnd != std::string_view::npos) {
+    size_t next = head.find ("\r\n", lineEnd + 2);
+    std::string_view line = head.substr (lineEnd + 2, next == std::string_view::npos
+                                                          ? std::string_view::npos
+                                                          : next - lineEnd - 2);
+    size_t colon = line.find (':');
+    if (colon != std::string_view::npos)
+      request.headers[toLower (std::string (line.substr (0, colon)))]
+          = trim (line.substr (colon + 1));
+    lineEnd = next;
+  }
+
+  // body
+  size_t contentLength = 0;
+  std::string lengthHeader = request.header ("content-length");
+  if (!lengthHeader.empty ())
+    contentLength = std::strtoull (lengthHeader.c_str (), nullptr, 10);
+  if (contentLength > MAX_BODY_SIZE) {
+    sendAll (clientFd,
+             "HTTP/1.1 413 Payload Too Large\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+    return;
+  }
+  request.body = data.substr (headerEnd + 4);
+  while (request.body.size () < contentLength) {
+    ssize_t n = recvBefore (clientFd, buffer, sizeof (buffer), deadline);
+    if (n <= 0)
+      return;
+    request.body.append (buffer, static_cast<size_t> (n));
+  }
+  request.body.resize (contentLength);
+
+  HttpResponse response = handler_ ? handler_ (request) : HttpResponse{ 404, "text/plain", "" };
+  std::string out = "HTTP/1.1 " + std::to_string (response.status) + " "
+                    + reasonPhrase (response.status) + "\r\nContent-Type: "
+                    + response.contentType
+                    + "\r\nContent-Length: " + std::to_string (response.body.size ())
+                    + "\r\nConnection: close\r\n\r\n" + response.body;
+  sendAll (clientFd, out);
+}
+
+std::string HttpServer::urlDecode (std::string_view text) {
+  std::string out;
+  out.reserve (text.size ());
+  for (size_t i = 0; i < text.size (); ++i) {
+    if (text[i] == '+') {
+      out.push_back (' ');
+    } else if (text[i] == '%' && i + 2 < text.size () && std::isxdigit (static_cast<unsigned char> (text[i + 1]))
+               && std::isxdigit (static_cast<unsigned char> (text[i + 2]))) {
+      out.push_back (static_cast<char> (std::stoi (std::string (text.substr (i + 1, 2)), nullptr,
+                                                    16)));
+      i += 2;
+    } else {
+      out.push_back (text[i]);
+    }
+  }
+  return out;
+}
+
+std::map<std::string, std::string> HttpServer::parseQuery (std::string_view query) {
+  std::map<std::string, std::string> params;
+  while (!query.empty ()) {
+    size_t amp = query.find ('&');
+    std::string_view pair = query.substr (0, amp);
+    size_t eq = pair.find ('=');
+    if (!pair.empty ())
+      params[urlDecode (pair.substr (0, eq))]
+          = eq == std::string_view::npos ? "" : urlDecode (pair.substr (eq + 1));
+    if (amp == std::string_view::npos)
+      break;
+    query.remove_prefix (amp + 1);
+  }
+  return params;
+}
@@ -0,0 +1,77 @@
+#ifndef __HTTPSERVER_H__
+#define __HTTPSERVER_H__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// Tiny blocking HTTP/1.1 server for low-volume callbacks (WebSub verification and pushes).
+// One background thread, one request per connection, POSIX sockets only. Each request has to
+// arrive completely within the request timeout, so a slow client holds the thread only that long.
+
+struct HttpRequest {
+  std::string method;
+  std::string path;
+  std::map<std::string, std::string> query;
+  std::map<std::string, std::string> headers; // lower-case names
+  std::string body;
+
+  std::string header (const std::string& name) const;
+  std::string param (const std::string& name) const;
+};
+
+struct HttpResponse {
+  int status = 200;
+  std::string contentType = "text/plain";
+  std::string body;
+};
+
+class HttpServer {
+public:
+  using Handler = std::function<HttpResponse (const HttpRequest&)>;
+
+  HttpServer () = default;
+  ~HttpServer ();
+  HttpServer (const HttpServer&) = delete;
+  HttpServer& operator= (const HttpServer&) = delete;
+
+  /**
+   * @brief Bind and start serving on a background thread.
+   * @param port 0 picks an ephemeral port, see port ().
+   * @return 0 on success, -1 on failure.
+   */
+  int start (const std::string& bindAddress, uint16_t port, Handler handler);
+  void stop ();
+  // Deadline for reading a whole request, set before start
+  void setRequestTimeout (std::chrono::milliseconds timeout) {
+    requestTimeout_ = timeout;
+  }
+
+  bool isRunning () const {
+    return running_.load ();
+  }
+  uint16_t port () const {
+    return port_;
+  }
+
+  static std::string urlDecode (std::string_view text);
+  static std::map<std::string, std::string> parseQuery (std::string_view query);
+
+private:
+  void run ();
+  void handleConnection (int clientFd);
+
+  int listenFd_ = -1;
+  uint16_t port_ = 0;
+  std::chrono::milliseconds requestTimeout_{ 5000 };
+  Handler handler_;
+  std::thread thread_;
+  std::atomic<bool> running_{ false };
+};
+
+#endif // __HTTPSERVER_H__
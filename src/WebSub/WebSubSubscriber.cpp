@@ -0,0 +1,326 @@
+#include "WebSubSubscriber.hpp"
+#include <Logger/Logger.hpp>
+#include <curl/curl.h>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+#include <cctype>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+  size_t DiscardCallback (void* /*contents*/, size_t size, size_t nmemb, void* /*userp*/) {
+    return size * nmemb;
+  }
+
+  std::string toHex (const unsigned char* data, size_t size) {
+    std::ostringstream out;
+    for (size_t i = 0; i < size; ++i)
+      out << std::hex << std::setw (2) << std::setfill ('0') << static_cast<int> (data[i]);
+    return out.str ();
+  }
+
+  std::string formField (CURL* curl, const std::string& name, const std::string& value) {
+    char* escaped = curl_easy_escape (curl, value.c_str (), static_cast<int> (value.size ()));
+    std::string field = name + "=" + (escaped ? escaped : "");
+    curl_free (escaped);
+    return field;
+  }
+
+  const EVP_MD* digestFor (const std::string& method) {
+    if (method == "sha1")
+      return EVP_sha1 ();
+    if (method == "sha256")
+      return EVP_sha256 ();
+    if (method == "sha384")
+      return EVP_sha384 ();
+    if (method == "sha512")
+      return EVP_sha512 ();
+    return nullptr;
+  }
+}
+
+WebSubSubscriber::~WebSubSubscriber () {
+  stop ();
+}
+
+int WebSubSubscriber::start (const WebSubOptions& options, ContentHandler onContent) {
+  options_ = options;
+  onContent_ = std::move (onContent);
+  if (server_.start (options_.bindAddress, options_.port,
+                     [this] (const HttpRequest& request) { return handleRequest (request); })
+      != 0) {
+    return -1;
+  }
+  LOG_I_STREAM << "WebSub callback endpoint ready at " << getCallbackUrl ("<id>") << std::endl;
+  return 0;
+}
+
+void WebSubSubscriber::stop () {
+  server_.stop ();
+}
+
+std::string WebSubSubscriber::getCallbackUrl (const std::string& id) const {
+  std::string base = options_.callbackUrl;
+  if (base.empty ())
+    base = "http://127.0.0.1:" + std::to_string (server_.port ()) + "/websub";
+  if (!base.empty () && base.back () == '/')
+    base.pop_back ();
+  return base + "/" + id;
+}
+
+std::string WebSubSubscriber::makeId (const std::string& topic) {
+  std::ostringstream id;
+  id << std::hex << std::hash<std::string>{}(topic);
+  return id.str ();
+}
+
+std::string WebSubSubscriber::makeSecret () {
+  unsigned char bytes[20];
+  if (RAND_bytes (bytes, sizeof (bytes)) != 1)
+    return "";
+  return toHex (bytes, sizeof (bytes));
+}
+
+std::string WebSubSubscriber::signature (const std::string& secret, const std::string& body,
+                                         const std::string& method) {
+  const EVP_MD* md = digestFor (method);
+  if (!md)
+    return "";
+
+  unsigned char digest[EVP_MAX_MD_SIZE];
+  unsigned int digestLen = 0;
+  if (!HMAC (md, secret.data (), static_cast<int> (secret.size ()),
+             reinterpret_cast<const unsigned char*> (body.data ()), body.size (), digest,
+             &digestLen))
+    return "";
+  return method + "=" + toHex (digest, digestLen);
+}
+
+bool WebSubSubscriber::verifySignature (const std::string& secret,
+                                        const std::string& signatureHeader,
+                                        const std::string& body) {
+  size_t eq = signatureHeader.find ('=');
+  if (eq == std::string::npos)
+    return false;
+
+  std::string expected = signature (secret, body, signatureHeader.substr (0, eq));
+  return !expected.empty () && expected.size () == signatureHeader.size ()
+         && CRYPTO_memcmp (expected.data (), signatureHeader.data (), expected.size ()) == 0;
+}
+
+bool WebSubSubscriber::isSecureHub (const std::string& hub) {
+  std::string url = hub;
+  for (auto& c : url)
+    c = static_cast<char> (std::tolower (static_cast<unsigned char> (c)));
+  if (url.rfind ("https://", 0) == 0)
+    return true;
+  if (url.rfind ("http://", 0) != 0)
+    return false;
+  std::string host = url.substr (7);
+  if (host.rfind ("[::1]", 0) == 0)
+    return host.size () == 5 || std::string (":/?#").find (host[5]) != std::string::npos;
+  host = host.substr (0, host.find_first_of (":/?#"));
+  return host == "localhost" || host.rfind ("127.", 0) == 0;
+}
+
+int WebSubSubscriber::subscribe (const std::string& hub, const std::string& topic) {
+  if (!server_.isRunning ())
+    return -1;
+  if (!isSecureHub (hub)) {
+    // Pushes are accepted only signed, and the secret must not cross the network in the clear
+    LOG_W_STREAM << "WebSub hub " << hub << " is not https, " << topic << " stays on polling"
+                 << std::endl;
+    return -1;
+  }
+
+  WebSubSubscription subscription;
+  {
+    std::lock_guard<std::mutex> lock (mutex_);
+    std::string id = makeId (topic);
+    auto& entry = subscriptions_[id];
+    if (entry.id.empty ()) {
+      entry.id = id;
+      entry.topic = topic;
+      entry.secret = makeSecret ();
+      if (entry.secret.empty ()) {
+        // Without a secret pushes cannot be authenticated
+        subscriptions_.erase (id);
+        LOG_E_STREAM << "Failed to generate a WebSub secret for " << topic << std::endl;
+        return -1;
+      }
+    }
+    entry.hub = hub; // a renewal keeps the secret so in-flight pushes still verify
+    entry.requestedAt = std::chrono::system_clock::now ();
+    subscription = entry;
+  }
+
+  if (sendHubRequest (hub, "subscribe", subscription) != 0) {
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto it = subscriptions_.find (subscription.id);
+    if (it != subscriptions_.end () && !it->second.verified)
+      subscriptions_.erase (it);
+    return -1;
+  }
+  LOG_I_STREAM << "WebSub subscription requested for " << topic << " at hub " << hub << std::endl;
+  return 0;
+}
+
+int WebSubSubscriber::unsubscribe (const std::string& topic) {
+  WebSubSubscription subscription;
+  {
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto it = subscriptions_.find (makeId (topic));
+    if (it == subscriptions_.end ())
+      return -1;
+    subscription = it->second;
+    pendingUnsubscribe_[subscription.id] = topic;
+  }
+  return sendHubRequest (subscription.hub, "unsubscribe", subscription);
+}
+
+bool WebSubSubscriber::isActive (const std::string& topic) const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  auto it = subscriptions_.find (makeId (topic));
+  return it != subscriptions_.end () && it->second.verified
+         && it->second.leaseExpiry > std::chrono::system_clock::now ();
+}
+
+bool WebSubSubscriber::needsRenewal (const std::string& topic,
+                                     std::chrono::seconds margin) const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  auto it = subscriptions_.find (makeId (topic));
+  if (it == subscriptions_.end ())
+    return true;
+  if (!it->second.verified) {
+    // The verification GET may have been lost or the callback may be unreachable
+    auto timeout = std::chrono::seconds (options_.verifyTimeoutSeconds);
+    if (it->second.requestedAt + timeout > std::chrono::system_clock::now ())
+      return false; // verification still pending at the hub
+    LOG_W_STREAM << "WebSub hub " << it->second.hub << " did not verify " << topic << " within "
+                 << options_.verifyTimeoutSeconds << " s, subscribing again" << std::endl;
+    return true;
+  }
+  return it->second.leaseExpiry - margin <= std::chrono::system_clock::now ();
+}
+
+int WebSubSubscriber::sendHubRequest (const std::string& hub, const std::string& mode,
+                                      const WebSubSubscription& subscription) {
+  CURL* curl = curl_easy_init ();
+  if (!curl)
+    return -1;
+
+  std::string form = formField (curl, "hub.mode", mode) + "&"
+                     + formField (curl, "hub.topic", subscription.topic) + "&"
+                     + formField (curl, "hub.callback", getCallbackUrl (subscription.id)) + "&"
+                     + formField (curl, "hub.lease_seconds",
+                                  std::to_string (options_.leaseSeconds));
+  if (!subscription.secret.empty ())
+    form += "&" + formField (curl, "hub.secret", subscription.secret);
+
+  curl_easy_setopt (curl, CURLOPT_URL, hub.c_str ());
+  curl_easy_setopt (curl, CURLOPT_POSTFIELDS, form.c_str ());
+  curl_easy_setopt (curl, CURLOPT_WRITEFUNCTION, DiscardCallback);
+  curl_easy_setopt (curl, CURLOPT_FOLLOWLOCATION, 1L);
+  curl_easy_setopt (curl, CURLOPT_TIMEOUT, 30L);
+  curl_easy_setopt (curl, CURLOPT_CONNECTTIMEOUT, 10L);
+
+  CURLcode res = curl_easy_perform (curl);
+  long status = 0;
+  curl_easy_getinfo (curl, CURLINFO_RESPONSE_CODE, &status);
+  curl_easy_cleanup (curl);
+
+  if (res != CURLE_OK) {
+    LOG_E_STREAM << "WebSub " << mode << " request to " << hub
+                 << " failed: " << curl_easy_strerror (res) << std::endl;
+    return -1;
+  }
+  if (status < 200 || status >= 300) {
+    LOG_W_STREAM << "WebSub hub " << hub << " rejected " << mode << " of "
+                 << subscription.topic << " with HTTP " << status << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+HttpResponse WebSubSubscriber::handleRequest (const HttpRequest& request) {
+  size_t slash = request.path.find_last_of ('/');
+  std::string id = slash == std::string::npos ? request.path : request.path.substr (slash + 1);
+  if (request.method == "GET")
+    return handleVerification (request, id);
+  if (request.method == "POST")
+    return handleContent (request, id);
+  return { 405, "text/plain", "" };
+}
+
+HttpResponse WebSubSubscriber::handleVerification (const HttpRequest& request,
+                                                   const std::string& id) {
+  const std::string mode = request.param ("hub.mode");
+  const std::string topic = request.param ("hub.topic");
+
+  std::lock_guard<std::mutex> lock (mutex_);
+  auto it = subscriptions_.find (id);
+
+  if (mode == "denied") {
+    if (it != subscriptions_.end () && it->second.topic == topic) {
+      LOG_W_STREAM << "WebSub hub denied subscription of " << topic << ": "
+                   << request.param ("hub.reason") << std::endl;
+      subscriptions_.erase (it);
+    }
+    return { 200, "text/plain", "" };
+  }
+
+  if (mode == "subscribe" && it != subscriptions_.end () && it->second.topic == topic) {
+    long lease = options_.leaseSeconds;
+    std::string leaseParam = request.param ("hub.lease_seconds");
+    if (!leaseParam.empty ())
+      lease = std::strtol (leaseParam.c_str (), nullptr, 10);
+    it->second.verified = true;
+    it->second.leaseExpiry = std::chrono::system_clock::now () + std::chrono::seconds (lease);
+    LOG_I_STREAM << "WebSub subscription verified for " << topic << " (lease " << lease << " s)"
+                 << std::endl;
+    return { 200, "text/plain", request.param ("hub.challenge") };
+  }
+
+  auto pending = pendingUnsubscribe_.find (id);
+  if (mode == "unsubscribe" && pending != pendingUnsubscribe_.end ()
+      && pending->second == topic) {
+    pendingUnsubscribe_.erase (pending);
+    subscriptions_.erase (id);
+    LOG_I_STREAM << "WebSub unsubscription verified for " << topic << std::endl;
+    return { 200, "text/plain", request.param ("hub.challenge") };
+  }
+
+  LOG_W_STREAM << "WebSub verification for unknown subscription: " << mode << " " << topic
+               << std::endl;
+  return { 404, "text/plain", "" };
+}
+
+HttpResponse WebSubSubscriber::handleContent (const HttpRequest& request,
+                                              const std::string& id) {
+  WebSubSubscription subscription;
+  {
+    std::lock_guard<std::mutex> lock (mutex_);
+    auto it = subscriptions_.find (id);
+    if (it == subscriptions_.end ())
+      return { 404, "text/plain", "" };
+    subscription = it->second;
+  }
+
+  // Per spec the distribution is acknowledged either way, but unauthenticated content is dropped
+  if (subscription.secret.empty ()
+      || !verifySignature (subscription.secret, request.header ("x-hub-signature"),
+                           request.body)) {
+    LOG_W_STREAM << "WebSub push for " << subscription.topic
+                 << " has a missing or invalid signature, ignoring." << std::endl;
+    return { 200, "text/plain", "" };
+  }
+
+  LOG_I_STREAM << "WebSub push received for " << subscription.topic << " ("
+               << request.body.size () << " bytes)" << std::endl;
+  if (onContent_)
+    onContent_ (subscription.topic, request.body, request.header ("content-type"));
+  return { 200, "text/plain", "" };
+}
@@ -0,0 +1,93 @@
+#ifndef __WEBSUBSUBSCRIBER_H__
+#define __WEBSUBSUBSCRIBER_H__
+
+#include "HttpServer.hpp"
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// WebSub (PubSubHubbub) subscriber side: subscribes topics at their hubs, answers the
+// intent verification and hands authenticated content distributions to the owner.
+// https://www.w3.org/TR/websub/
+
+struct WebSubOptions {
+  std::string bindAddress = "0.0.0.0";
+  uint16_t port = 8765;
+  std::string callbackUrl;                  // public base URL, empty = http://127.0.0.1:<port>
+  int leaseSeconds = 864000;                // requested lease (10 days)
+  int safetyNetPollInterval = 60 * 60 * 24; // polling of pushed feeds, seconds
+  int verifyTimeoutSeconds = 60 * 10;       // subscribe again when the hub has not verified
+};
+
+struct WebSubSubscription {
+  std::string id; // callback path component
+  std::string topic;
+  std::string hub;
+  std::string secret; // random per subscription, every push must be signed with it
+  bool verified = false;
+  std::chrono::system_clock::time_point leaseExpiry;
+  std::chrono::system_clock::time_point requestedAt; // last subscribe request to the hub
+};
+
+class WebSubSubscriber {
+public:
+  using ContentHandler = std::function<void (const std::string& topic, const std::string& body,
+                                             const std::string& contentType)>;
+
+  WebSubSubscriber () = default;
+  ~WebSubSubscriber ();
+
+  /**
+   * @brief Start the callback endpoint.
+   * @return 0 on success, -1 on failure.
+   */
+  int start (const WebSubOptions& options, ContentHandler onContent);
+  void stop ();
+  bool isRunning () const {
+    return server_.isRunning ();
+  }
+
+  /**
+   * @brief Ask the hub to subscribe our callback to the topic.
+   * @return 0 when the hub accepted the request, -1 otherwise.
+   */
+  int subscribe (const std::string& hub, const std::string& topic);
+  int unsubscribe (const std::string& topic);
+
+  // Verified and the lease has not expired
+  bool isActive (const std::string& topic) const;
+  // Unknown, not verified within verifyTimeoutSeconds, or the lease expires within the margin
+  bool needsRenewal (const std::string& topic, std::chrono::seconds margin) const;
+
+  std::string getCallbackUrl (const std::string& id) const;
+
+  // "<method>=<hex hmac>" as sent by hubs in X-Hub-Signature
+  static std::string signature (const std::string& secret, const std::string& body,
+                                const std::string& method = "sha256");
+  // hub.secret may only travel over https, plain http is accepted for a hub on this host
+  static bool isSecureHub (const std::string& hub);
+
+private:
+  HttpResponse handleRequest (const HttpRequest& request);
+  HttpResponse handleVerification (const HttpRequest& request, const std::string& id);
+  HttpResponse handleContent (const HttpRequest& request, const std::string& id);
+  int sendHubRequest (const std::string& hub, const std::string& mode,
+                      const WebSubSubscription& subscription);
+
+  static std::string makeId (const std::string& topic);
+  static std::string makeSecret ();
+  static bool verifySignature (const std::string& secret, const std::string& signatureHeader,
+                               const std::string& body);
+
+  HttpServer server_;
+  WebSubOptions options_;
+  ContentHandler onContent_;
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, WebSubSubscription> subscriptions_; // by id
+  std::unordered_map<std::string, std::string> pendingUnsubscribe_;   // id -> topic
+};
+
+#endif // __WEBSUBSUBSCRIBER_H__
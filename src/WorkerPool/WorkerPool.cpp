@@ -0,0 +1,99 @@
+#include "WorkerPool.hpp"
+#include <Logger/Logger.hpp>
+#include <algorithm>
+#include <exception>
+
+WorkerPool::WorkerPool (size_t threads, size_t maxQueued) : maxQueued_ (maxQueued) {
+  threads = std::max<size_t> (1, threads);
+  for (size_t i = 0; i < threads; ++i)
+    threads_.emplace_back (&WorkerPool::work, this);
+}
+
+WorkerPool::~WorkerPool () {
+  stop ();
+}
+
+void WorkerPool::setLimit (const std::string& key, size_t maxConcurrent) {
+  std::lock_guard<std::mutex> lock (mutex_);
+  limits_[key] = maxConcurrent;
+  changed_.notify_all ();
+}
+
+bool WorkerPool::submit (const std::string& key, Task task) {
+  {
+    std::lock_guard<std::mutex> lock (mutex_);
+    if (stopping_ || queue_.size () >= maxQueued_)
+      return false;
+    queue_.push_back (Job{ key, std::move (task) });
+  }
+  changed_.notify_all ();
+  return true;
+}
+
+void WorkerPool::stop () {
+  std::deque<Job> dropped;
+  {
+    std::lock_guard<std::mutex> lock (mutex_);
+    stopping_ = true;
+    dropped.swap (queue_);
+  }
+  changed_.notify_all ();
+  if (!dropped.empty ()) {
+    LOG_W_STREAM << "Worker pool stopping, dropped " << dropped.size () << " queued tasks"
+                 << std::endl;
+  }
+  for (auto& thread : threads_)
+    if (thread.joinable ())
+      thread.join ();
+  threads_.clear ();
+}
+
+size_t WorkerPool::getQueued () const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  return queue_.size ();
+}
+
+size_t WorkerPool::getRunning () const {
+  std::lock_guard<std::mutex> lock (mutex_);
+  return runningTotal_;
+}
+
+bool WorkerPool::runnable (const Job& job) const {
+  auto limit = limits_.find (job.key);
+  if (limit == limits_.end () || limit->second == 0)
+    return true;
+  auto running = running_.find (job.key);
+  return running == running_.end () || running->second < limit->second;
+}
+
+void WorkerPool::work () {
+  std::unique_lock<std::mutex> lock (mutex_);
+  while (true) {
+    // Oldest task whose key still has a free slot, later keys may overtake a saturated one
+    auto job = queue_.end ();
+    changed_.wait (lock, [&] () {
+      job = std::find_if (queue_.begin (), queue_.end (),
+                          [this] (const Job& candidate) { return runnable (candidate); });
+      return job != queue_.end () || stopping_;
+    });
+    if (stopping_)
+      return; // queued tasks were dropped by stop
+
+    Job current = std::move (*job);
+    queue_.erase (job);
+    running_[current.key]++;
+    runningTotal_++;
+    lock.unlock ();
+
+    try {
+      current.task ();
+    } catch (const std::exception& e) {
+      LOG_E_STREAM << "Worker task " << current.key << " failed: " << e.what () << std::endl;
+    }
+
+    lock.lock ();
+    running_[current.key]--;
+    runningTotal_--;
+    changed_.notify_all ();
+  }
+}
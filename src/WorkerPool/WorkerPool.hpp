@@ -0,0 +1,62 @@
+#ifndef __WORKERPOOL_H__
+#define __WORKERPOOL_H__
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Fixed set of threads for blocking work (HTTP calls, popen, fetch cycles).
+// The queue is bounded so a burst is refused instead of piling up, and every task carries a key
+// with an optional concurrency limit, so one slow command cannot occupy every worker.
+
+class WorkerPool {
+public:
+  using Task = std::function<void ()>;
+
+  WorkerPool (size_t threads, size_t maxQueued);
+  ~WorkerPool ();
+  WorkerPool (const WorkerPool&) = delete;
+  WorkerPool& operator= (const WorkerPool&) = delete;
+
+  // At most maxConcurrent tasks of the key run at once, 0 lifts the limit
+  void setLimit (const std::string& key, size_t maxConcurrent);
+
+  /**
+   * @brief Queue a task.
+   * @return false when the queue is full or the pool is stopping, the task is not run.
+   */
+  bool submit (const std::string& key, Task task);
+
+  // Drop the tasks that have not started, wait for the running ones and join the threads
+  void stop ();
+
+  size_t getQueued () const;
+  size_t getRunning () const;
+
+private:
+  struct Job {
+    std::string key;
+    Task task;
+  };
+
+  void work ();
+  bool runnable (const Job& job) const; // callers hold mutex_
+
+  const size_t maxQueued_;
+  mutable std::mutex mutex_;
+  std::condition_variable changed_;
+  std::deque<Job> queue_;
+  std::unordered_map<std::string, size_t> limits_;
+  std::unordered_map<std::string, size_t> running_;
+  size_t runningTotal_ = 0;
+  bool stopping_ = false;
+  std::vector<std::thread> threads_;
+};
+
+#endif // __WORKERPOOL_H__
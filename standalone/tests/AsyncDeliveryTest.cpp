@@ -0,0 +1,119 @@
+// MIT License
+// Copyright (c) 2024-2025 Tomáš Mark
+// Async semaphore and retry policy tests
+
+#include "../../src/DiscordBot/AsyncSemaphore.hpp"
+#include "../../src/DiscordBot/RetryPolicy.hpp"
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+  // Eager fire-and-forget coroutine, enough to drive the semaphore without an event loop
+  struct Detached {
+    struct promise_type {
+      Detached get_return_object () {
+        return {};
+      }
+      std::suspend_never initial_suspend () noexcept {
+        return {};
+      }
+      std::suspend_never final_suspend () noexcept {
+        return {};
+      }
+      void return_void () {
+      }
+      void unhandled_exception () {
+        std::terminate ();
+      }
+    };
+  };
+
+  // Takes a permit, logs entry and waits for the test to open its gate
+  struct Gate {
+    std::coroutine_handle<> handle;
+    bool await_ready () {
+      return false;
+    }
+    void await_suspend (std::coroutine_handle<> waiter) {
+      handle = waiter;
+    }
+    void await_resume () {
+    }
+  };
+
+  Detached worker (AsyncSemaphore& semaphore, Gate& gate, std::vector<std::string>& log,
+                   std::string name) {
+    co_await semaphore.acquire ();
+    AsyncSemaphore::Permit permit (semaphore);
+    log.push_back (name + "+");
+    co_await gate;
+    log.push_back (name + "-");
+  }
+}
+
+TEST (AsyncDeliveryTest, SemaphoreBoundsConcurrency) {
+  AsyncSemaphore semaphore (2);
+  Gate a, b, c;
+  std::vector<std::string> log;
+  worker (semaphore, a, log, "a");
+  worker (semaphore, b, log, "b");
+  worker (semaphore, c, log, "c");
+
+  EXPECT_EQ (log, (std::vector<std::string>{ "a+", "b+" }));
+  EXPECT_EQ (semaphore.getAvailable (), 0u);
+  EXPECT_EQ (semaphore.getWaiting (), 1u);
+
+  a.handle.resume (); // a finishes and hands its permit to c
+  EXPECT_EQ (log, (std::vector<std::string>{ "a+", "b+", "a-", "c+" }));
+  EXPECT_EQ (semaphore.getWaiting (), 0u);
+
+  b.handle.resume ();
+  c.handle.resume ();
+  EXPECT_EQ (semaphore.getAvailable (), 2u);
+}
+
+TEST (AsyncDeliveryTest, SemaphoreServesWaitersInOrder) {
+  AsyncSemaphore semaphore (1);
+  Gate first, second, third;
+  std::vector<std::string> log;
+  worker (semaphore, first, log, "1");
+  worker (semaphore, second, log, "2");
+  worker (semaphore, third, log, "3");
+
+  first.handle.resume ();
+  second.handle.resume ();
+  third.handle.resume ();
+  EXPECT_EQ (log, (std::vector<std::string>{ "1+", "1-", "2+", "2-", "3+", "3-" }));
+  EXPECT_EQ (semaphore.getAvailable (), 1u);
+}
+
+TEST (AsyncDeliveryTest, RetriesOnlyTransientFailures) {
+  RetryPolicy policy;
+  EXPECT_FALSE (policy.shouldRetry (0, 0));   // no response, the request may have been executed
+  EXPECT_FALSE (policy.shouldRetry (0, 429)); // rate limited, SendPipeline requeues it
+  EXPECT_TRUE (policy.shouldRetry (0, 502));
+  EXPECT_FALSE (policy.shouldRetry (0, 403)); // missing permission will not heal
+  EXPECT_FALSE (policy.shouldRetry (0, 404));
+  EXPECT_TRUE (policy.shouldRetry (1, 500));
+  EXPECT_FALSE (policy.shouldRetry (2, 500)); // third attempt was the last
+}
+
+TEST (AsyncDeliveryTest, BackoffStaysWithinJitterBounds) {
+  RetryPolicy policy;
+  policy.base = std::chrono::milliseconds (1000);
+  policy.cap = std::chrono::milliseconds (5000);
+  std::mt19937 rng (42);
+  for (int i = 0; i < 200; ++i) {
+    auto first = policy.delay (0, rng).count ();
+    EXPECT_GE (first, 500);
+    EXPECT_LE (first, 1000);
+    auto second = policy.delay (1, rng).count ();
+    EXPECT_GE (second, 1000);
+    EXPECT_LE (second, 2000);
+    auto capped = policy.delay (10, rng).count ();
+    EXPECT_GE (capped, 2500);
+    EXPECT_LE (capped, 5000);
+  }
+}
@@ -0,0 +1,38 @@
+// MIT License
+// Copyright (c) 2024-2025 Tomáš Mark
+// Channel type cache tests
+
+#include "../../src/DiscordBot/ChannelTypeCache.hpp"
+#include <gtest/gtest.h>
+
+TEST (ChannelTypeCacheTest, UnknownUntilSeen) {
+  ChannelTypeCache cache;
+  EXPECT_FALSE (cache.isAnnouncement (1).has_value ());
+  cache.set (1, true);
+  cache.set (2, false);
+  ASSERT_TRUE (cache.isAnnouncement (1).has_value ());
+  EXPECT_TRUE (*cache.isAnnouncement (1));
+  EXPECT_FALSE (*cache.isAnnouncement (2));
+
+  // A channel converted to announcement is updated in place
+  cache.set (2, true);
+  EXPECT_TRUE (*cache.isAnnouncement (2));
+  cache.remove (1);
+  EXPECT_FALSE (cache.isAnnouncement (1).has_value ());
+  EXPECT_EQ (cache.getStats ().cachedChannels, 1u);
+}
+
+TEST (ChannelTypeCacheTest, CountsAvoidedRequests) {
+  ChannelTypeCache cache;
+  EXPECT_TRUE (cache.shouldCrosspost (true));
+  EXPECT_FALSE (cache.shouldCrosspost (false));
+  EXPECT_FALSE (cache.shouldCrosspost (false));
+  cache.countRestLookup ();
+  EXPECT_EQ (cache.getStats ().crosspostsSent, 0u); // not accepted yet
+  cache.countCrosspost ();
+
+  ChannelTypeStats stats = cache.getStats ();
+  EXPECT_EQ (stats.crosspostsSent, 1u);
+  EXPECT_EQ (stats.crosspostsSkipped, 2u);
+  EXPECT_EQ (stats.restLookups, 1u);
+}
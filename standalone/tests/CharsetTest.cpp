@@ -0,0 +1,79 @@
+// MIT License
+// Copyright (c) 2024-2025 Tomáš Mark
+// Charset detection and transcoding tests
+
+#include "../../src/RssManager/Charset.hpp"
+#include <gtest/gtest.h>
+#include <string>
+
+using Charset::Encoding;
+
+TEST (CharsetTest, NameLookup) {
+  EXPECT_EQ (Charset::fromName ("windows-1250"), Encoding::Windows1250);
+  EXPECT_EQ (Charset::fromName ("CP1250"), Encoding::Windows1250);
+  EXPECT_EQ (Charset::fromName ("ISO-8859-2"), Encoding::Iso8859_2);
+  EXPECT_EQ (Charset::fromName ("latin2"), Encoding::Iso8859_2);
+  EXPECT_EQ (Charset::fromName ("utf-8"), Encoding::Utf8);
+  EXPECT_EQ (Charset::fromName ("koi8-r"), Encoding::Unknown);
+  EXPECT_EQ (Charset::fromName (""), Encoding::Unknown);
+}
+
+TEST (CharsetTest, DeclarationParsing) {
+  EXPECT_EQ (Charset::charsetFromXmlDeclaration (
+                 "<?xml version=\"1.0\" encoding=\"windows-1250\"?><rss/>"),
+             "windows-1250");
+  EXPECT_EQ (Charset::charsetFromXmlDeclaration ("\n<?xml version='1.0' encoding='iso-8859-2' ?>"),
+             "iso-8859-2");
+  EXPECT_EQ (Charset::charsetFromXmlDeclaration ("<?xml version=\"1.0\"?><rss/>"), "");
+  EXPECT_EQ (Charset::charsetFromXmlDeclaration ("<rss encoding=\"x\"/>"), "");
+
+  EXPECT_EQ (Charset::charsetFromContentType ("text/xml; charset=ISO-8859-2"), "ISO-8859-2");
+  EXPECT_EQ (Charset::charsetFromContentType ("application/rss+xml;Charset=\"utf-8\""), "utf-8");
+  EXPECT_EQ (Charset::charsetFromContentType ("application/rss+xml"), "");
+}
+
+TEST (CharsetTest, Detection) {
+  const std::string cp1250Doc = "<?xml version=\"1.0\" encoding=\"windows-1250\"?><t>\x9E</t>";
+  EXPECT_EQ (Charset::detect (cp1250Doc), Encoding::Windows1250);
+  // Content-Type wins over the declaration
+  EXPECT_EQ (Charset::detect (cp1250Doc, "text/xml; charset=iso-8859-2"), Encoding::Iso8859_2);
+  // A wrong "utf-8" label on invalid UTF-8 falls back to the declaration
+  EXPECT_EQ (Charset::detect (cp1250Doc, "text/xml; charset=utf-8"), Encoding::Windows1250);
+  // Unlabelled valid UTF-8 stays UTF-8, unlabelled garbage defaults to windows-1250
+  EXPECT_EQ (Charset::detect ("<t>\xC5\xBE\xC3\xA1</t>"), Encoding::Utf8);
+  EXPECT_EQ (Charset::detect ("<t>\xE8</t>"), Encoding::Windows1250);
+}
+
+TEST (CharsetTest, Utf8Validation) {
+  EXPECT_TRUE (Charset::isValidUtf8 ("plain ascii text that is longer than a word"));
+  EXPECT_TRUE (Charset::isValidUtf8 ("P\xC5\x99\xC3\xADli\xC5\xA1 \xC5\xBEluou\xC4\x8Dk\xC3\xBD"));
+  EXPECT_TRUE (Charset::isValidUtf8 ("\xE2\x82\xAC \xF0\x9F\x99\x82"));
+  EXPECT_FALSE (Charset::isValidUtf8 ("\xC0\xAF"));         // overlong
+  EXPECT_FALSE (Charset::isValidUtf8 ("\xED\xA0\x80"));     // surrogate
+  EXPECT_FALSE (Charset::isValidUtf8 ("abc\xC5"));          // truncated
+  EXPECT_TRUE (Charset::isAscii ("0123456789abcdef0123"));
+  EXPECT_FALSE (Charset::isAscii ("0123456789abcdef\xE9"));
+}
+
+TEST (CharsetTest, TranscodeCzech) {
+  // "Příliš žluťoučký kůň" in windows-1250 and ISO-8859-2
+  const std::string expected = "P\xC5\x99\xC3\xADli\xC5\xA1 \xC5\xBElu\xC5\xA5ou\xC4\x8Dk\xC3\xBD "
+                               "k\xC5\xAF\xC5\x88";
+  const std::string cp1250 = "P\xF8\xEDli\x9A \x9Elu\x9Dou\xE8k\xFD k\xF9\xF2";
+  const std::string latin2 = "P\xF8\xEDli\xB9 \xBElu\xBBou\xE8k\xFD k\xF9\xF2";
+  EXPECT_EQ (Charset::transcodeToUtf8 (cp1250, Encoding::Windows1250), expected);
+  EXPECT_EQ (Charset::transcodeToUtf8 (latin2, Encoding::Iso8859_2), expected);
+  EXPECT_EQ (Charset::transcodeToUtf8 ("\x80", Encoding::Windows1250), "\xE2\x82\xAC");
+}
+
+TEST (CharsetTest, EnsureUtf8InPlace) {
+  std::string utf8 = "<?xml version=\"1.0\" encoding=\"utf-8\"?><t>\xC5\xBE</t>";
+  const char* before = utf8.data ();
+  EXPECT_EQ (Charset::ensureUtf8 (utf8), Encoding::Utf8);
+  EXPECT_EQ (utf8.data (), before); // untouched, no copy
+
+  std::string legacy = "<?xml version=\"1.0\" encoding=\"windows-1250\"?><t>\x9E</t>";
+  EXPECT_EQ (Charset::ensureUtf8 (legacy), Encoding::Windows1250);
+  EXPECT_TRUE (Charset::isValidUtf8 (legacy));
+  EXPECT_NE (legacy.find ("<t>\xC5\xBE</t>"), std::string::npos);
+}
@@ -0,0 +1,75 @@
+// MIT License
+// Copyright (c) 2024-2025 Tomáš Mark
+// Slash command router and latency histogram tests
+
+#include "../../src/DiscordBot/CommandRouter.hpp"
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+
+using namespace std::chrono_literals;
+
+TEST (CommandRouterTest, DispatchesByName) {
+  CommandRouter<std::string> router;
+  std::string received;
+  auto ping = [&] (const std::string& event) { received = "ping:" + event; };
+  EXPECT_EQ (router.add ("ping", ping), 0);
+  EXPECT_EQ (router.add ("ping", [] (const std::string&) {}), -1); // first route wins
+  EXPECT_TRUE (router.dispatch ("ping", "hello"));
+  EXPECT_EQ (received, "ping:hello");
+  EXPECT_FALSE (router.dispatch ("pong", "hello"));
+}
+
+TEST (CommandRouterTest, CountsCallsAndFailures) {
+  CommandRouter<int> router;
+  router.add ("ok", [] (const int&) {});
+  router.add ("broken", [] (const int&) { throw std::runtime_error ("boom"); });
+  router.add ("unused", [] (const int&) {});
+  for (int i = 0; i < 3; ++i)
+    router.dispatch ("ok", i);
+  router.dispatch ("broken", 0);
+
+  auto stats = router.getStats ();
+  ASSERT_EQ (stats.size (), 2u); // unused commands are left out
+  EXPECT_EQ (stats[0].name, "ok");
+  EXPECT_EQ (stats[0].calls, 3u);
+  EXPECT_EQ (stats[0].latency.getSamples (), 3u);
+  EXPECT_EQ (stats[1].name, "broken");
+  EXPECT_EQ (stats[1].failures, 1u);
+}
+
+TEST (CommandRouterTest, RecordsDeferredExecution) {
+  CommandRouter<int> router;
+  router.add ("slow", [] (const int&) {}); // hands its work to a worker
+  router.dispatch ("slow", 0);
+  router.recordExecution ("slow", 1500ms, false);
+  router.recordExecution ("slow", 2ms, true);
+  router.recordExecution ("unknown", 1ms, false);
+
+  auto stats = router.getStats ();
+  ASSERT_EQ (stats.size (), 1u);
+  EXPECT_EQ (stats[0].latency.getSamples (), 1u);
+  EXPECT_EQ (stats[0].execution.getSamples (), 2u);
+  EXPECT_EQ (stats[0].execution.getMax (), 1500ms);
+  EXPECT_EQ (stats[0].failures, 1u);
+}
+
+TEST (LatencyHistogramTest, PercentilesFollowBuckets) {
+  LatencyHistogram histogram;
+  EXPECT_EQ (histogram.percentile (0.5), 0us);
+  for (int i = 0; i < 90; ++i)
+    histogram.record (100us); // below 128 us
+  for (int i = 0; i < 10; ++i)
+    histogram.record (5000us); // below 8192 us
+  EXPECT_EQ (histogram.percentile (0.5), 128us);
+  EXPECT_EQ (histogram.percentile (0.95), 8192us);
+  EXPECT_EQ (histogram.getMax (), 5000us);
+  EXPECT_EQ (histogram.getMean (), 590us);
+}
+
+TEST (LatencyHistogramTest, SlowSamplesLandInLastBucket) {
+  LatencyHistogram histogram;
+  histogram.record (std::chrono::seconds (60));
+  EXPECT_EQ (histogram.getBuckets ().back (), 1u);
+  EXPECT_EQ (histogram.percentile (0.99), std::chrono::seconds (60));
+}
@@ -0,0 +1,44 @@
+// MIT License
+// Copyright (c) 2024-2025 Tomáš Mark
+// Slash command registration diff tests
+
+#include "../../src/DiscordBot/CommandSync.hpp"
+#include <gtest/gtest.h>
+
+namespace {
+  nlohmann::json command (const std::string& name, const std::string& description) {
+    return { { "name", name }, { "description", description }, { "type", 1 } };
+  }
+}
+
+TEST (CommandSyncTest, IgnoresOrderAndAssignedKeys) {
+  nlohmann::json local = { command ("sun", "Sunrise"), command ("bot", "About") };
+  nlohmann::json remote = { command ("bot", "About"), command ("sun", "Sunrise") };
+  remote[0]["id"] = "1234";
+  remote[0]["version"] = "5678";
+  remote[1]["application_id"] = "42";
+
+  EXPECT_TRUE (CommandSync::matches (local, remote));
+  EXPECT_EQ (CommandSync::signature (local), CommandSync::signature (remote));
+}
+
+TEST (CommandSyncTest, DetectsChanges) {
+  nlohmann::json local = { command ("sun", "Sunrise"), command ("bot", "About") };
+  EXPECT_FALSE (CommandSync::matches (local, { command ("sun", "Sunrise") }));
+  EXPECT_FALSE (
+      CommandSync::matches (local, { command ("sun", "Sunset"), command ("bot", "About") }));
+  EXPECT_NE (CommandSync::signature (local),
+             CommandSync::signature ({ command ("sun", "Sunrise") }));
+}
+
+TEST (CommandSyncTest, SignatureRoundTrip) {
+  auto path = std::filesystem::temp_directory_path () / "CommandSyncTest.txt";
+  std::filesystem::remove (path);
+  EXPECT_EQ (CommandSync::loadSignature (path), "");
+
+  std::string signature = CommandSync::signature ({ command ("bot", "About") });
+  EXPECT_EQ (signature.size (), 16u);
+  ASSERT_EQ (CommandSync::saveSignature (path, signature), 0);
+  EXPECT_EQ (CommandSync::loadSignature (path), signature);
+  std::filesystem::remove (path);
+}
@@ -0,0 +1,138 @@
+// MIT License
+// Copyright (c) 2024-2025 Tomáš Mark
+// Daily compressed delivery archive tests
+
+#include "../../src/Archive/DeliveryArchive.hpp"
+#include <gtest/gtest.h>
+#include <filesystem>
+
+namespace {
+  constexpr std::time_t DAY = 24 * 60 * 60;
+
+  ArchiveRecord record (std::time_t postedAt, const std::string& source, uint64_t channelId,
+                        int n) {
+    ArchiveRecord r;
+    r.postedAt = postedAt;
+    r.queuedAt = postedAt - 60;
+    r.channelId = channelId;
+    r.messageId = 1000 + static_cast<uint64_t> (n);
+    r.sourceUrl = source;
+    r.title = "Zpráva číslo " + std::to_string (n);
+    r.link = source + "/" + std::to_string (n);
+    return r;
+  }
+}
+
+class DeliveryArchiveTest : public ::testing::Test {
+protected:
+  void SetUp () override {
+    directory_ = std::filesystem::temp_directory_path () / "botpp_archive_test";
+    std::filesystem::remove_all (directory_);
+  }
+  void TearDown () override {
+    std::filesystem::remove_all (directory_);
+  }
+  std::filesystem::path directory_;
+};
+
+TEST_F (DeliveryArchiveTest, RecentIsNewestFirstAcrossDays) {
+  DeliveryArchive archive;
+  ASSERT_EQ (archive.open (directory_), 0);
+  std::time_t start = 1700000000 - 3 * DAY;
+  for (int i = 0; i < 200; ++i)
+    archive.append (record (start + i * 1200, "https://a", 1, i)); // spans three days
+
+  EXPECT_GE (archive.getSegmentCount (), 3u);
+  auto latest = archive.recent (5);
+  ASSERT_EQ (latest.size (), 5u);
+  EXPECT_EQ (latest[0].messageId, 1199u);
+  EXPECT_EQ (latest[4].messageId, 1195u);
+  EXPECT_EQ (latest[0].title, "Zpráva číslo 199");
+  EXPECT_TRUE (archive.recent (0).empty ());
+}
+
+TEST_F (DeliveryArchiveTest, FailedFlushOnDayChangeRejectsTheAppend) {
+  DeliveryArchive archive;
+  ASSERT_EQ (archive.open (directory_), 0);
+  std::time_t start = 1700000000 - 3 * DAY;
+  ASSERT_EQ (archive.append (record (start, "https://a", 1, 0)), 0);
+
+  // A directory in place of the day's segment makes its flush fail
+  std::filesystem::path segment;
+  for (const auto& entry : std::filesystem::directory_iterator (directory_))
+    if (entry.path ().extension () == ".pending")
+      segment = std::filesystem::path (entry.path ()).replace_extension (".seg");
+  ASSERT_FALSE (segment.empty ());
+  std::filesystem::create_directory (segment);
+
+  EXPECT_EQ (archive.append (record (start + DAY, "https://a", 1, 1)), -1);
+  std::filesystem::remove (segment);
+  ASSERT_EQ (archive.append (record (start + DAY, "https://a", 1, 1)), 0);
+
+  auto latest = archive.recent (10);
+  ASSERT_EQ (latest.size (), 2u);
+  EXPECT_EQ (latest[0].messageId, 1001u);
+  EXPECT_EQ (latest[1].messageId, 1000u);
+  auto firstDay = [&] (const ArchiveRecord& r) { return r.postedAt == start; };
+  EXPECT_EQ (archive.recent (10, firstDay).size (), 1u); // filed under its own day
+}
+
+TEST_F (DeliveryArchiveTest, PerSourceHistoryAndReopen) {
+  std::time_t now = std::time (nullptr);
+  {
+    DeliveryArchive archive;
+    ASSERT_EQ (archive.open (directory_), 0);
+    for (int i = 0; i < 10; ++i)
+      archive.append (record (now + i, i % 2 ? "https://odd" : "https://even", 7, i));
+    // no close: pending records must come back from the pending file
+    std::filesystem::copy (directory_, directory_.string () + "_crash");
+  }
+  std::filesystem::remove_all (directory_);
+  std::filesystem::rename (directory_.string () + "_crash", directory_);
+
+  DeliveryArchive archive;
+  ASSERT_EQ (archive.open (directory_), 0);
+  auto odd = archive.recent (
+      100, [] (const ArchiveRecord& r) { return r.sourceUrl == "https://odd"; });
+  ASSERT_EQ (odd.size (), 5u);
+  EXPECT_EQ (odd[0].link, "https://odd/9");
+  EXPECT_EQ (odd[4].link, "https://odd/1");
+}
+
+TEST_F (DeliveryArchiveTest, RangeScanForAnalytics) {
+  DeliveryArchive archive;
+  ASSERT_EQ (archive.open (directory_), 0);
+  std::time_t start = 1600000000;
+  for (int i = 0; i < 500; ++i)
+    archive.append (record (start + i * 600, "https://a", static_cast<uint64_t> (i % 3), i));
+  archive.close ();
+  ASSERT_EQ (archive.open (directory_), 0);
+
+  size_t count = 0;
+  std::time_t previous = 0;
+  archive.forEach (start + 100 * 600, start + 200 * 600, [&] (const ArchiveRecord& r) {
+    EXPECT_GE (r.postedAt, previous);
+    previous = r.postedAt;
+    count++;
+  });
+  EXPECT_EQ (count, 100u);
+}
+
+TEST_F (DeliveryArchiveTest, CompressesWellBelowJson) {
+  DeliveryArchive archive;
+  ASSERT_EQ (archive.open (directory_), 0);
+  std::time_t start = 1650000000;
+  size_t jsonBytes = 0;
+  for (int i = 0; i < 640; ++i) {
+    ArchiveRecord r
+        = record (start + i * 60, "https://www.root.cz/rss/clanky", 1398904149856223262u, i);
+    archive.append (r);
+    jsonBytes += 120 + r.sourceUrl.size () + r.title.size () + r.link.size ();
+  }
+  archive.close ();
+
+  size_t archiveBytes = 0;
+  for (const auto& entry : std::filesystem::directory_iterator (directory_))
+    archiveBytes += std::filesystem::file_size (entry.path ());
+  EXPECT_LT (archiveBytes * 4, jsonBytes);
+}
@@ -0,0 +1,145 @@
+// MIT License
+// Copyright (c) 2024-2025 Tomáš Mark
+// Delivery lane wake-ups racing with the lane's own scheduling
+
+#include "../../src/Assets/AssetContext.hpp"
+#include "../../src/BotConfig/BotConfig.hpp"
+#include "../../src/DiscordBot/DeliveryLanes.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+  constexpr uint64_t CHANNEL = 7;
+
+  RSSItem laneItem (const std::string& title) {
+    RSSItem item (title, "https://example.com/" + title, "d", "", false, CHANNEL);
+    item.sourceUrl = "https://example.com/feed.xml";
+    return item;
+  }
+
+  // Stub post function, records the titles in posting order
+  struct Posted {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<std::string> titles;
+
+    void add (const std::string& title) {
+      std::lock_guard<std::mutex> lock (mutex);
+      titles.push_back (title);
+      changed.notify_all ();
+    }
+    bool waitFor (size_t count, std::chrono::milliseconds timeout) {
+      std::unique_lock<std::mutex> lock (mutex);
+      return changed.wait_for (lock, timeout, [&] () { return titles.size () >= count; });
+    }
+  };
+}
+
+class DeliveryLanesTest : public ::testing::Test {
+protected:
+  void SetUp () override {
+    assetsDir_ = std::filesystem::temp_directory_path () / "botpp_lanes_test";
+    std::filesystem::remove_all (assetsDir_);
+    std::filesystem::create_directories (assetsDir_);
+    AssetContext::setAssetsPath (assetsDir_);
+    std::ofstream (assetsDir_ / "rssUrls.json") << "[]";
+    std::ofstream (assetsDir_ / "seenHashes.json") << "[]";
+    // No quiet hours, a parked lane waits out the whole quiet interval unless it is woken
+    std::ofstream (assetsDir_ / "botConfig.json")
+        << "{\"lanes\": {\"" << CHANNEL << "\": {\"minIntervalSeconds\": 1,"
+        << " \"maxIntervalSeconds\": 1, \"quietIntervalSeconds\": 3600,"
+        << " \"quietStartHour\": 0, \"quietEndHour\": 0}}}";
+    BotConfig::load ();
+    ASSERT_EQ (rss_.initialize (), 0);
+    scheduler_.start ();
+  }
+
+  void TearDown () override {
+    scheduler_.stop ();
+    std::filesystem::remove (assetsDir_ / "botConfig.json");
+    BotConfig::load (); // defaults again for the other suites
+    AssetContext::clearAssetsPath ();
+    std::filesystem::remove_all (assetsDir_);
+  }
+
+  // A requeued delivery queues an item and announces it like a fetch would
+  void queue (const std::string& title) {
+    rss_.failDelivery (laneItem (title));
+  }
+
+  // Owned by the fixture, its lane tasks must not outlive it while the scheduler runs
+  DeliveryLanes& lanes (std::function<void (const RSSItem&)> before = nullptr) {
+    lanes_ = std::make_unique<DeliveryLanes> (
+        scheduler_, rss_, [this, before] (const RSSItem& item, uint64_t, bool, bool) {
+          if (before)
+            before (item);
+          posted_.add (item.title);
+        });
+    lanes_->start (0ms);
+    return *lanes_;
+  }
+
+  std::filesystem::path assetsDir_;
+  RssManager rss_;
+  Scheduler scheduler_{ 10ms };
+  Posted posted_;
+  std::unique_ptr<DeliveryLanes> lanes_;
+};
+
+TEST_F (DeliveryLanesTest, ItemArrivingWhileParkedWakesTheLane) {
+  DeliveryLanes& lane = lanes ();
+  lane.onItemsAvailable (CHANNEL); // opens the lane, it finds nothing and parks
+  std::this_thread::sleep_for (100ms);
+  EXPECT_EQ (lane.getLaneCount (), 1u);
+
+  queue ("first");
+  ASSERT_TRUE (posted_.waitFor (1, 2s)); // not after the hour of the quiet interval
+  std::lock_guard<std::mutex> lock (posted_.mutex);
+  EXPECT_EQ (posted_.titles[0], "first");
+}
+
+TEST_F (DeliveryLanesTest, ItemArrivingDuringServiceIsNotLost) {
+  auto injected = std::make_shared<std::atomic<bool>> (false);
+  lanes ([this, injected] (const RSSItem&) {
+    // Arrives while the lane is running, before it parks: no wake-up is due, the lane must
+    // still see the item when it looks at its queue
+    if (!injected->exchange (true)) {
+      queue ("second");
+    }
+  });
+  queue ("first");
+  ASSERT_TRUE (posted_.waitFor (2, 4s));
+  std::lock_guard<std::mutex> lock (posted_.mutex);
+  EXPECT_EQ (posted_.titles, (std::vector<std::string>{ "first", "second" }));
+}
+
+TEST_F (DeliveryLanesTest, WakeUpsFromManyThreadsPostEveryItem) {
+  lanes ().onItemsAvailable (CHANNEL);
+  std::this_thread::sleep_for (50ms);
+
+  std::vector<std::thread> producers;
+  for (int producer = 0; producer < 2; ++producer) {
+    producers.emplace_back ([this, producer] () {
+      for (int i = 0; i < 3; ++i) {
+        queue ("p" + std::to_string (producer) + "-" + std::to_string (i));
+        std::this_thread::sleep_for (std::chrono::milliseconds (5 * (producer + 1)));
+      }
+    });
+  }
+  for (auto& producer : producers)
+    producer.join ();
+  // One post a second at most, none of the six waits for the quiet interval
+  EXPECT_TRUE (posted_.waitFor (6, 10s));
+}
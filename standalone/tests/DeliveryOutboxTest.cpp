@@ -0,0 +1,102 @@
+// MIT License
+// Copyright (c) 2024-2025 Tomáš Mark
+// Write-ahead delivery outbox tests
+
+#include "../../src/Outbox/DeliveryOutbox.hpp"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+
+class DeliveryOutboxTest : public ::testing::Test {
+protected:
+  void SetUp () override {
+    path_ = std::filesystem::temp_directory_path () / "botpp_outbox_test.journal";
+    std::filesystem::remove (path_);
+  }
+  void TearDown () override {
+    std::filesystem::remove (path_);
+  }
+  std::filesystem::path path_;
+};
+
+TEST_F (DeliveryOutboxTest, UnconfirmedEntriesSurviveRestart) {
+  {
+    DeliveryOutbox outbox;
+    ASSERT_EQ (outbox.open (path_), 0);
+    uint64_t sent = outbox.begin ("1/a", { { "title", "A" } });
+    outbox.begin ("1/b", { { "title", "B" } });
+    EXPECT_FALSE (outbox.confirm (sent));
+    EXPECT_EQ (outbox.commit (), 0);
+  } // crash: "b" was never confirmed
+
+  DeliveryOutbox outbox;
+  ASSERT_EQ (outbox.open (path_), 0);
+  auto inFlight = outbox.getInFlight ();
+  ASSERT_EQ (inFlight.size (), 1u);
+  EXPECT_EQ (inFlight[0].key, "1/b");
+  EXPECT_EQ (inFlight[0].payload["title"], "B");
+  // new ids never collide with recovered ones
+  EXPECT_GT (outbox.begin ("1/c", {}), inFlight[0].id);
+}
+
+TEST_F (DeliveryOutboxTest, ConfirmationsAreGroupCommitted) {
+  DeliveryOutbox outbox;
+  ASSERT_EQ (outbox.open (path_), 0);
+  outbox.setBatchSize (3);
+  uint64_t a = outbox.begin ("a", {});
+  uint64_t b = outbox.begin ("b", {});
+  uint64_t c = outbox.begin ("c", {});
+  EXPECT_FALSE (outbox.confirm (a));
+  EXPECT_FALSE (outbox.confirm (a)); // counted once
+  EXPECT_FALSE (outbox.confirm (b));
+  EXPECT_TRUE (outbox.confirm (c));
+  EXPECT_EQ (outbox.getPendingKeys (), (std::vector<std::string>{ "a", "b", "c" }));
+  EXPECT_EQ (outbox.getInFlightCount (), 3u); // confirmed but not durable yet
+  EXPECT_EQ (outbox.commit (), 0);
+  EXPECT_EQ (outbox.getPendingCount (), 0u);
+  EXPECT_EQ (outbox.getInFlightCount (), 0u);
+}
+
+TEST_F (DeliveryOutboxTest, RetryReplacesEntryWithUpdatedPayload) {
+  {
+    DeliveryOutbox outbox;
+    ASSERT_EQ (outbox.open (path_), 0);
+    uint64_t first = outbox.begin ("1/a", { { "attempts", 0 } });
+    uint64_t second = outbox.retry (first, { { "attempts", 1 } });
+    EXPECT_NE (second, 0u);
+    EXPECT_NE (second, first);
+    EXPECT_EQ (outbox.retry (first, {}), 0u); // already replaced
+    EXPECT_EQ (outbox.getInFlightCount (), 1u);
+  }
+
+  DeliveryOutbox outbox;
+  ASSERT_EQ (outbox.open (path_), 0);
+  auto inFlight = outbox.getInFlight ();
+  ASSERT_EQ (inFlight.size (), 1u);
+  EXPECT_EQ (inFlight[0].key, "1/a");
+  EXPECT_EQ (inFlight[0].payload["attempts"], 1);
+}
+
+TEST_F (DeliveryOutboxTest, TornRecordIsSkipped) {
+  {
+    DeliveryOutbox outbox;
+    ASSERT_EQ (outbox.open (path_), 0);
+    outbox.begin ("kept", {});
+  }
+  {
+    std::ofstream journal (path_, std::ios::app);
+    journal << "{\"take\":7,\"key\":\"tor"; // crash in the middle of a write
+  }
+  DeliveryOutbox outbox;
+  ASSERT_EQ (outbox.open (path_), 0);
+  auto inFlight = outbox.getInFlight ();
+  ASSERT_EQ (inFlight.size (), 1u);
+  EXPECT_EQ (inFlight[0].key, "kept");
+}
+
+TEST_F (DeliveryOutboxTest, ClosedOutboxHandsOutNoIds) {
+  DeliveryOutbox outbox;
+  EXPECT_FALSE (outbox.isOpen ());
+  EXPECT_EQ (outbox.begin ("a", {}), 0u);
+  EXPECT_FALSE (outbox.confirm (0));
+}
@@ -0,0 +1,85 @@
+// MIT License
+// Copyright (c) 2024-2025 Tomáš Mark
+// Deficit round robin queue tests
+
+#include "../../src/RssManager/FairQueue.hpp"
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+  std::vector<std::string> drain (FairQueue<std::string>& queue, size_t count) {
+    std::vector<std::string> out;
+    for (size_t i = 0; i < count; ++i) {
+      auto item = queue.pop ();
+      if (!item)
+        break;
+      out.push_back (*item);
+    }
+    return out;
+  }
+}
+
+TEST (FairQueueTest, EmptyQueue) {
+  FairQueue<std::string> queue;
+  EXPECT_TRUE (queue.empty ());
+  EXPECT_FALSE (queue.pop ().has_value ());
+}
+
+TEST (FairQueueTest, BurstySourceDoesNotStarveQuietOne) {
+  FairQueue<std::string> queue;
+  for (int i = 0; i < 50; ++i)
+    queue.push ("bursty", "b" + std::to_string (i));
+  queue.push ("quiet", "q0");
+
+  auto order = drain (queue, 3);
+  ASSERT_EQ (order.size (), 3u);
+  EXPECT_EQ (order[0], "b0");
+  EXPECT_EQ (order[1], "q0"); // served within one round
+  EXPECT_EQ (order[2], "b1");
+  EXPECT_EQ (queue.size (), 48u);
+}
+
+TEST (FairQueueTest, WeightsShareSlots) {
+  FairQueue<std::string> queue;
+  queue.setWeight ("heavy", 3);
+  for (int i = 0; i < 30; ++i) {
+    queue.push ("heavy", "h");
+    queue.push ("light", "l");
+  }
+
+  std::map<std::string, int> served;
+  for (const auto& item : drain (queue, 20))
+    served[item]++;
+  EXPECT_EQ (served["h"], 15);
+  EXPECT_EQ (served["l"], 5);
+}
+
+TEST (FairQueueTest, FifoWithinSource) {
+  FairQueue<std::string> queue;
+  queue.push ("a", "a1");
+  queue.push ("a", "a2");
+  queue.push ("a", "a3");
+  EXPECT_EQ (drain (queue, 3), (std::vector<std::string>{ "a1", "a2", "a3" }));
+}
+
+TEST (FairQueueTest, FilteredPopSkipsSources) {
+  FairQueue<std::string> queue;
+  queue.push ("a", "a-plain");
+  queue.push ("b", "b-embedded");
+  queue.push ("a", "a-embedded");
+
+  auto embedded
+      = [] (const std::string& item) { return item.find ("embedded") != std::string::npos; };
+  // "a" holds the turn and has an eligible item behind a non-matching one
+  auto first = queue.pop (embedded);
+  ASSERT_TRUE (first.has_value ());
+  EXPECT_EQ (*first, "a-embedded");
+  auto second = queue.pop (embedded);
+  ASSERT_TRUE (second.has_value ());
+  EXPECT_EQ (*second, "b-embedded");
+  EXPECT_FALSE (queue.pop (embedded).has_value ());
+  EXPECT_EQ (queue.size (), 1u);
+  EXPECT_EQ (queue.size ("a"), 1u);
+}
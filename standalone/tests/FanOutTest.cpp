@@ -0,0 +1,125 @@
+// MIT License
+// Copyright (c) 2024-2025 Tomáš Mark
+// One feed subscribed by several channels is fetched once and delivered to each
+
+#include "../../src/Assets/AssetContext.hpp"
+#include "../../src/RssManager/RssManager.hpp"
+#include "../../src/WebSub/HttpServer.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+  std::string rssDocument (const std::string& base, std::initializer_list<std::string> titles) {
+    std::string doc = "<?xml version=\"1.0\" encoding=\"UTF-8\"?><rss version=\"2.0\"><channel>"
+                      "<title>Local</title><link>"
+                      + base + "</link><description>fan-out</description>";
+    for (const auto& title : titles)
+      doc += "<item><title>" + title + "</title><link>" + base + "/" + title
+             + "</link><description>d</description></item>";
+    return doc + "</channel></rss>";
+  }
+}
+
+class FanOutTest : public ::testing::Test {
+protected:
+  void SetUp () override {
+    assetsDir_ = std::filesystem::temp_directory_path () / "botpp_fanout_test";
+    std::filesystem::remove_all (assetsDir_);
+    std::filesystem::create_directories (assetsDir_);
+    AssetContext::setAssetsPath (assetsDir_);
+
+    ASSERT_EQ (server_.start ("127.0.0.1", 0,
+                              [this] (const HttpRequest&) {
+                                feedRequests_++;
+                                return HttpResponse{ 200, "application/rss+xml",
+                                                     rssDocument (base_, { "two", "one" }) };
+                              }),
+               0);
+    base_ = "http://127.0.0.1:" + std::to_string (server_.port ());
+  }
+
+  void TearDown () override {
+    server_.stop ();
+    AssetContext::clearAssetsPath ();
+    std::filesystem::remove_all (assetsDir_);
+  }
+
+  std::filesystem::path assetsDir_;
+  HttpServer server_;
+  std::string base_;
+  std::atomic<int> feedRequests_{ 0 };
+};
+
+TEST (FanOutCanonicalUrlTest, EquivalentSpellingsShareAKey) {
+  EXPECT_EQ (RssManager::canonicalUrl ("https://WWW.Root.cz/rss/clanky/"),
+             "https://www.root.cz/rss/clanky");
+  EXPECT_EQ (RssManager::canonicalUrl (" https://www.root.cz/rss/clanky#top "),
+             "https://www.root.cz/rss/clanky");
+  EXPECT_EQ (RssManager::canonicalUrl ("https://example.com/"), "https://example.com");
+  // the path stays case-sensitive
+  EXPECT_NE (RssManager::canonicalUrl ("https://example.com/Feed"),
+             RssManager::canonicalUrl ("https://example.com/feed"));
+}
+
+TEST_F (FanOutTest, FetchOnceDeliverToEveryChannel) {
+  std::ofstream (assetsDir_ / "rssUrls.json") << "[]";
+  std::ofstream (assetsDir_ / "seenHashes.json") << "[]";
+
+  RssManager rss;
+  ASSERT_EQ (rss.initialize (), 0);
+  ASSERT_EQ (rss.addUrl (base_ + "/feed.xml", false, 1), 0);
+  ASSERT_EQ (rss.addUrl (base_ + "/feed.xml/", true, 2), 0); // same feed, other channel
+  EXPECT_EQ (rss.addUrl (base_ + "/feed.xml", false, 1), -1);
+
+  EXPECT_EQ (rss.fetchAllFeeds (), 4);
+  EXPECT_EQ (feedRequests_.load (), 1);
+  EXPECT_EQ (rss.getItemCount (true), 2u);
+
+  // channel 1 consumes its copies, channel 2 keeps its own
+  RSSItem first = rss.getNextItem (false);
+  RSSItem second = rss.getNextItem (false);
+  EXPECT_EQ (first.discordChannelId, 1u);
+  EXPECT_EQ (first.title, "one"); // oldest first
+  EXPECT_EQ (second.title, "two");
+  EXPECT_EQ (rss.getItemCount (), 2u);
+
+  // a refetch does not bring back what channel 1 already posted
+  EXPECT_EQ (rss.fetchAllFeeds (), 0);
+  EXPECT_EQ (feedRequests_.load (), 2);
+  RSSItem other = rss.getNextItem ();
+  EXPECT_EQ (other.discordChannelId, 2u);
+  EXPECT_TRUE (other.embedded);
+}
+
+TEST_F (FanOutTest, LegacyPlainHashesCountForEveryChannel) {
+  RSSItem legacy ("one", base_ + "/one", "d", "", false, 0);
+  std::ofstream (assetsDir_ / "seenHashes.json") << "[\"" << legacy.hash << "\"]";
+  std::ofstream (assetsDir_ / "rssUrls.json")
+      << "[{\"url\": \"" << base_ << "/feed.xml\", \"discordChannelId\": 1},"
+      << " {\"url\": \"" << base_ << "/feed.xml\", \"discordChannelId\": 2}]";
+
+  RssManager rss;
+  ASSERT_EQ (rss.initialize (), 0);
+  EXPECT_EQ (rss.fetchAllFeeds (), 2); // only "two", once per channel
+}
+
+TEST_F (FanOutTest, InvalidWeightsFallBackInsteadOfAbortingTheLoad) {
+  std::ofstream (assetsDir_ / "seenHashes.json") << "[]";
+  std::ofstream (assetsDir_ / "rssUrls.json")
+      << "[{\"url\": \"" << base_ << "/a.xml\", \"weight\": \"3\"},"
+      << " {\"url\": \"" << base_ << "/b.xml\", \"weight\": -2},"
+      << " {\"url\": \"" << base_ << "/c.xml\", \"weight\": 100000},"
+      << " {\"url\": \"" << base_ << "/d.xml\", \"weight\": 2}]";
+
+  RssManager rss;
+  ASSERT_EQ (rss.initialize (), 0);
+  std::string sources = rss.getSourcesAsList ();
+  EXPECT_NE (sources.find ("/a.xml (non-embedded)\n"), std::string::npos);
+  EXPECT_NE (sources.find ("/b.xml (non-embedded)\n"), std::string::npos);
+  EXPECT_NE (sources.find ("/c.xml (non-embedded) [Weight: "
+                           + std::to_string (RssManager::MAX_SOURCE_WEIGHT) + "]"),
+             std::string::npos);
+  EXPECT_NE (sources.find ("/d.xml (non-embedded) [Weight: 2]"), std::string::npos);
+}
@@ -0,0 +1,91 @@
+// MIT License
+// Copyright (c) 2024-2025 Tomáš Mark
+// Keyword routing automaton tests
+
+#include "../../src/RssManager/KeywordRouter.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+
+namespace {
+  bool contains (const std::vector<uint64_t>& channels, uint64_t channelId) {
+    return std::find (channels.begin (), channels.end (), channelId) != channels.end ();
+  }
+}
+
+TEST (KeywordRouterTest, NoRulesAcceptEverything) {
+  auto router = KeywordRouter::compile ({});
+  RouteMatch match = router->match ("Anything", "at all");
+  EXPECT_TRUE (match.accepts (1));
+  EXPECT_TRUE (match.routed.empty ());
+}
+
+TEST (KeywordRouterTest, IncludeAndExcludeAreCaseInsensitive) {
+  ChannelRules linuxNews;
+  linuxNews.channelId = 1;
+  linuxNews.include = { "linux", "kernel" };
+  linuxNews.exclude = { "Windows" };
+  auto router = KeywordRouter::compile ({ linuxNews });
+
+  EXPECT_TRUE (router->match ("New LINUX release", "").accepts (1));
+  EXPECT_TRUE (router->match ("Release notes", "the kernel got faster").accepts (1));
+  EXPECT_FALSE (router->match ("Gaming news", "").accepts (1));
+  EXPECT_FALSE (router->match ("Linux vs WINDOWS", "").accepts (1));
+  EXPECT_TRUE (router->match ("Gaming news", "").accepts (2)); // channel without rules
+}
+
+TEST (KeywordRouterTest, OverlappingKeywordsAllReport) {
+  ChannelRules rust;
+  rust.channelId = 10;
+  rust.route = { "rust" };
+  ChannelRules security;
+  security.channelId = 20;
+  security.route = { "trust", "security" };
+  ChannelRules diacritics;
+  diacritics.channelId = 30;
+  diacritics.route = { "bezpečnost" };
+  auto router = KeywordRouter::compile ({ rust, security, diacritics });
+
+  // "trust" contains "rust", both must be reported through the output links
+  RouteMatch match = router->match ("Zero trust networking", "");
+  EXPECT_TRUE (contains (match.routed, 10));
+  EXPECT_TRUE (contains (match.routed, 20));
+  EXPECT_FALSE (contains (match.routed, 30));
+
+  match = router->match ("Kybernetická bezpečnost", "");
+  EXPECT_EQ (match.routed, (std::vector<uint64_t>{ 30 }));
+}
+
+TEST (KeywordRouterTest, ExcludeBlocksRouting) {
+  ChannelRules topic;
+  topic.channelId = 5;
+  topic.route = { "gpu" };
+  topic.exclude = { "sponsored" };
+  auto router = KeywordRouter::compile ({ topic });
+  EXPECT_EQ (router->match ("GPU drivers", "").routed.size (), 1u);
+  EXPECT_TRUE (router->match ("GPU drivers", "Sponsored content").routed.empty ());
+}
+
+TEST (KeywordRouterTest, ManyRulesStayOneAutomaton) {
+  std::vector<ChannelRules> rules;
+  for (uint64_t channel = 0; channel < 500; ++channel) {
+    ChannelRules rule;
+    rule.channelId = channel + 1;
+    rule.route = { "topic" + std::to_string (channel) + "x" };
+    rules.push_back (rule);
+  }
+  auto router = KeywordRouter::compile (rules);
+  RouteMatch match = router->match ("about topic123x and topic7x", "");
+  EXPECT_EQ (match.routed, (std::vector<uint64_t>{ 8, 124 }));
+}
+
+TEST (KeywordRouterTest, RulesFromJson) {
+  auto json = nlohmann::json::parse (R"({"channels": [
+      {"channelId": 42, "embedded": true, "include": ["linux", ""], "route": ["kernel"]},
+      {"include": ["ignored without channelId"]}]})");
+  auto rules = KeywordRouter::rulesFromJson (json);
+  ASSERT_EQ (rules.size (), 1u);
+  EXPECT_EQ (rules[0].channelId, 42u);
+  EXPECT_TRUE (rules[0].embedded);
+  EXPECT_EQ (rules[0].include, (std::vector<std::string>{ "linux" }));
+  EXPECT_EQ (KeywordRouter::compile (rules)->getRouteChannels (), (std::vector<uint64_t>{ 42 }));
+}
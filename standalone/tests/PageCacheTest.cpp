@@ -0,0 +1,72 @@
+// MIT License
+// Copyright (c) 2024-2025 Tomáš Mark
+// Paginator and page cache tests
+
+#include "../../src/DiscordBot/PageCache.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+TEST (PageCacheTest, SplitsAtLineBreaks) {
+  std::string text = "alpha\nbravo\ncharlie\ndelta";
+  auto pages = Paginator::splitPages (text, 13);
+  ASSERT_EQ (pages.size (), 2u);
+  EXPECT_EQ (pages[0], "alpha\nbravo");
+  EXPECT_EQ (pages[1], "charlie\ndelta");
+  // views into the original text, nothing copied
+  EXPECT_EQ (pages[0].data (), text.data ());
+}
+
+TEST (PageCacheTest, LongLineKeepsUtf8Intact) {
+  std::string text;
+  for (int i = 0; i < 10; ++i)
+    text += "č"; // 2 bytes each
+  auto pages = Paginator::splitPages (text, 5);
+  ASSERT_EQ (pages.size (), 5u);
+  for (auto page : pages)
+    EXPECT_EQ (page, "čč");
+}
+
+TEST (PageCacheTest, ShortTextIsOnePage) {
+  auto pages = Paginator::splitPages ("short", 2000);
+  ASSERT_EQ (pages.size (), 1u);
+  EXPECT_EQ (pages[0], "short");
+  EXPECT_TRUE (Paginator::splitPages ("", 2000).empty ());
+}
+
+TEST (PageCacheTest, PagesAreFramedAndClamped) {
+  PageCache cache;
+  cache.put ("42", "one\ntwo\nthree", "[", "]", 7);
+  auto first = cache.get ("42", 0);
+  ASSERT_TRUE (first.has_value ());
+  EXPECT_EQ (first->content, "[one]");
+  EXPECT_EQ (first->count, 3u);
+  auto last = cache.get ("42", 99);
+  ASSERT_TRUE (last.has_value ());
+  EXPECT_EQ (last->index, 2u);
+  EXPECT_EQ (last->content, "[three]");
+  EXPECT_FALSE (cache.get ("unknown", 0).has_value ());
+}
+
+TEST (PageCacheTest, ExpiresAndEvictsLeastRecentlyUsed) {
+  PageCache cache (2, std::chrono::seconds (60));
+  auto now = PageCache::Clock::now ();
+  cache.put ("a", "A", "", "", 2000, now);
+  cache.put ("b", "B", "", "", 2000, now + std::chrono::seconds (1));
+  cache.get ("a", 0, now + std::chrono::seconds (2)); // "b" is now the least recently used
+  cache.put ("c", "C", "", "", 2000, now + std::chrono::seconds (3));
+  EXPECT_EQ (cache.size (), 2u);
+  EXPECT_FALSE (cache.get ("b", 0, now + std::chrono::seconds (3)).has_value ());
+  EXPECT_TRUE (cache.get ("a", 0, now + std::chrono::seconds (3)).has_value ());
+  EXPECT_FALSE (cache.get ("a", 0, now + std::chrono::seconds (61)).has_value ());
+}
+
+TEST (PageCacheTest, ButtonIdRoundTrip) {
+  std::string key;
+  size_t index = 0;
+  ASSERT_TRUE (PageCache::parseButtonId (PageCache::buttonId ("123456", 4), key, index));
+  EXPECT_EQ (key, "123456");
+  EXPECT_EQ (index, 4u);
+  EXPECT_FALSE (PageCache::parseButtonId ("other:1:2", key, index));
+  EXPECT_FALSE (PageCache::parseButtonId ("page:123:x", key, index));
+}
@@ -0,0 +1,71 @@
+// MIT License
+// Copyright (c) 2024-2025 Tomáš Mark
+// Adaptive posting interval tests
+
+#include "../../src/DiscordBot/PostingRate.hpp"
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+namespace {
+  std::tm atHour (int hour) {
+    std::tm tm{};
+    tm.tm_hour = hour;
+    return tm;
+  }
+}
+
+TEST (PostingRateTest, EmptyQueueWaitsForItems) {
+  PostingRate rate;
+  EXPECT_EQ (rate.nextInterval (0, 0s, atHour (12)), 0s);
+}
+
+TEST (PostingRateTest, QuietHoursKeepSlowCadence) {
+  PostingRate rate;
+  EXPECT_TRUE (rate.isQuietHours (atHour (23)));
+  EXPECT_TRUE (rate.isQuietHours (atHour (3)));
+  EXPECT_FALSE (rate.isQuietHours (atHour (6)));
+  EXPECT_EQ (rate.nextInterval (500, 24h, atHour (2)), rate.getConfig ().quietInterval);
+}
+
+TEST (PostingRateTest, IntervalShrinksWithBacklog) {
+  PostingRate rate;
+  const auto& config = rate.getConfig ();
+  EXPECT_EQ (rate.nextInterval (1, 0s, atHour (12)), config.maxInterval);
+  EXPECT_EQ (rate.nextInterval (60, 0s, atHour (12)), 8min); // 8 h / 60 items
+  EXPECT_EQ (rate.nextInterval (1000, 0s, atHour (12)), config.minInterval);
+}
+
+TEST (PostingRateTest, OldItemsRaisePressure) {
+  PostingRate rate;
+  auto fresh = rate.nextInterval (60, 1h, atHour (12));
+  auto aging = rate.nextInterval (60, 9h, atHour (12));
+  EXPECT_LT (aging, fresh);
+  EXPECT_EQ (rate.nextInterval (60, 12h, atHour (12)), rate.getConfig ().minInterval);
+}
+
+TEST (PostingRateTest, LaneSectionOverridesBase) {
+  PostingRateConfig base;
+  base.minInterval = 120s;
+  auto lane = nlohmann::json::parse (R"({"maxIntervalSeconds": 600, "quietStartHour": 22})");
+  PostingRateConfig config = PostingRate::configFromJson (lane, base);
+  EXPECT_EQ (config.minInterval, 120s); // inherited
+  EXPECT_EQ (config.maxInterval, 600s);
+  EXPECT_EQ (config.quietStartHour, 22);
+  EXPECT_EQ (config.quietEndHour, base.quietEndHour);
+
+  // an inverted range is repaired
+  auto inverted
+      = nlohmann::json::parse (R"({"minIntervalSeconds": 900, "maxIntervalSeconds": 60})");
+  config = PostingRate::configFromJson (inverted);
+  EXPECT_EQ (config.maxInterval, config.minInterval);
+}
+
+TEST (PostingRateTest, BacklogBeyondDrainTargetIsBatched) {
+  PostingRate rate; // 8 h drain target at 5 min is 96 posts
+  EXPECT_EQ (rate.batchSize (50, atHour (12)), 1u);
+  EXPECT_EQ (rate.batchSize (96, atHour (12)), 1u);
+  EXPECT_EQ (rate.batchSize (200, atHour (12)), 3u);
+  EXPECT_EQ (rate.batchSize (5000, atHour (12)), rate.getConfig ().maxBatch);
+  EXPECT_EQ (rate.batchSize (5000, atHour (2)), 1u); // quiet hours
+}
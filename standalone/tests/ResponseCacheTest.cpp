@@ -0,0 +1,41 @@
+// MIT License
+// Copyright (c) 2024-2025 Tomáš Mark
+// Response cache tests
+
+#include "../../src/DiscordBot/ResponseCache.hpp"
+#include <gtest/gtest.h>
+#include <string>
+
+TEST (ResponseCacheTest, RendersOncePerToken) {
+  ResponseCache<std::string> cache;
+  int renders = 0;
+  auto render = [&renders] () { return "sun times #" + std::to_string (++renders); };
+
+  EXPECT_EQ (cache.getOrRender ("sun", "2025-06-01", render), "sun times #1");
+  EXPECT_EQ (cache.getOrRender ("sun", "2025-06-01", render), "sun times #1");
+  EXPECT_EQ (renders, 1);
+  // next day
+  EXPECT_EQ (cache.getOrRender ("sun", "2025-06-02", render), "sun times #2");
+  EXPECT_EQ (cache.getHits (), 1u);
+  EXPECT_EQ (cache.getMisses (), 2u);
+}
+
+TEST (ResponseCacheTest, KeysAreIndependent) {
+  ResponseCache<std::string> cache;
+  cache.put ("bot", "1.0", "embed");
+  cache.put ("listsources", "3/0", "- feed");
+  EXPECT_EQ (cache.get ("bot", "1.0"), "embed");
+  EXPECT_FALSE (cache.get ("listsources", "4/0").has_value ()); // a source was added
+  cache.invalidate ("bot");
+  EXPECT_FALSE (cache.get ("bot", "1.0").has_value ());
+  EXPECT_EQ (cache.get ("listsources", "3/0"), "- feed");
+}
+
+TEST (ResponseCacheTest, LookupCountsAndLeavesTheRenderToTheCaller) {
+  ResponseCache<std::string> cache;
+  EXPECT_FALSE (cache.lookup ("sun", "2025-06-01").has_value ());
+  cache.put ("sun", "2025-06-01", "rendered on a worker");
+  EXPECT_EQ (cache.lookup ("sun", "2025-06-01"), "rendered on a worker");
+  EXPECT_EQ (cache.getHits (), 1u);
+  EXPECT_EQ (cache.getMisses (), 1u);
+}
@@ -0,0 +1,109 @@
+// MIT License
+// Copyright (c) 2024-2025 Tomáš Mark
+// Timer wheel scheduler tests
+
+#include "../../src/Scheduler/Scheduler.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <future>
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+  template <typename Predicate>
+  bool waitFor (Predicate predicate, std::chrono::milliseconds limit) {
+    auto deadline = std::chrono::steady_clock::now () + limit;
+    while (std::chrono::steady_clock::now () < deadline) {
+      if (predicate ())
+        return true;
+      std::this_thread::sleep_for (1ms);
+    }
+    return predicate ();
+  }
+}
+
+TEST (SchedulerTest, OneShotRunsOnceAndIsRemoved) {
+  Scheduler scheduler (1ms);
+  scheduler.start ();
+  std::atomic<int> runs{ 0 };
+  auto id = scheduler.scheduleOnce (5ms, [&] () { runs++; }, "once");
+  EXPECT_TRUE (waitFor ([&] () { return runs.load () == 1; }, 1000ms));
+  EXPECT_TRUE (waitFor ([&] () { return !scheduler.isScheduled (id); }, 1000ms));
+  std::this_thread::sleep_for (20ms);
+  EXPECT_EQ (runs.load (), 1);
+}
+
+TEST (SchedulerTest, PeriodicRepeatsUntilCancelled) {
+  Scheduler scheduler (1ms);
+  scheduler.start ();
+  std::atomic<int> runs{ 0 };
+  auto id = scheduler.scheduleEvery (3ms, [&] () { runs++; }, "every", 0ms);
+  EXPECT_TRUE (waitFor ([&] () { return runs.load () >= 3; }, 1000ms));
+  EXPECT_TRUE (scheduler.cancel (id));
+  int afterCancel = runs.load ();
+  std::this_thread::sleep_for (20ms);
+  EXPECT_LE (runs.load (), afterCancel + 1); // a run in progress may still finish
+  EXPECT_FALSE (scheduler.isScheduled (id));
+}
+
+TEST (SchedulerTest, CancelledTaskNeverRuns) {
+  Scheduler scheduler (1ms);
+  scheduler.start ();
+  std::atomic<bool> ran{ false };
+  auto id = scheduler.scheduleOnce (10ms, [&] () { ran = true; });
+  EXPECT_TRUE (scheduler.cancel (id));
+  EXPECT_FALSE (scheduler.cancel (id));
+  std::this_thread::sleep_for (30ms);
+  EXPECT_FALSE (ran.load ());
+}
+
+TEST (SchedulerTest, RescheduleBringsFarTimerForward) {
+  Scheduler scheduler (1ms);
+  scheduler.start ();
+  std::promise<void> fired;
+  // far enough to sit in an upper wheel level
+  auto id = scheduler.scheduleOnce (1h, [&] () { fired.set_value (); }, "far");
+  EXPECT_TRUE (scheduler.reschedule (id, 2ms));
+  EXPECT_EQ (fired.get_future ().wait_for (1s), std::future_status::ready);
+}
+
+TEST (SchedulerTest, CascadedTimerFiresAfterItsDueTime) {
+  Scheduler scheduler (1ms);
+  scheduler.start ();
+  // 70 ticks crosses the first level boundary and has to cascade
+  auto scheduledAt = Scheduler::Clock::now ();
+  std::promise<Scheduler::Clock::time_point> fired;
+  scheduler.scheduleOnce (70ms, [&] () { fired.set_value (Scheduler::Clock::now ()); });
+  auto future = fired.get_future ();
+  ASSERT_EQ (future.wait_for (2s), std::future_status::ready);
+  EXPECT_GE (future.get () - scheduledAt, 70ms);
+}
+
+TEST (SchedulerTest, DynamicTaskChoosesNextDelayAndRecordsStats) {
+  Scheduler scheduler (1ms);
+  scheduler.start ();
+  std::atomic<int> runs{ 0 };
+  auto id = scheduler.scheduleDynamic (
+      0ms,
+      [&] () -> std::optional<Scheduler::Clock::duration> {
+        if (++runs == 3)
+          return 1h; // park it so the stats stay readable
+        return 2ms;
+      },
+      "dynamic");
+  EXPECT_TRUE (waitFor ([&] () { return runs.load () == 3; }, 1000ms));
+  EXPECT_TRUE (waitFor (
+      [&] () {
+        auto stats = scheduler.getStats ();
+        return stats.size () == 1 && stats[0].runs == 3;
+      },
+      1000ms));
+  auto stats = scheduler.getStats ();
+  ASSERT_EQ (stats.size (), 1u);
+  EXPECT_EQ (stats[0].id, id);
+  EXPECT_EQ (stats[0].name, "dynamic");
+  EXPECT_GE (stats[0].maxLateness, stats[0].meanLateness);
+  EXPECT_GE (stats[0].lastLateness.count (), 0);
+}
@@ -0,0 +1,137 @@
+// MIT License
+// Copyright (c) 2024-2025 Tomáš Mark
+// Full-text search index and tokenizer tests
+
+#include "../../src/Search/SearchIndex.hpp"
+#include "../../src/Search/Tokenizer.hpp"
+#include <gtest/gtest.h>
+#include <filesystem>
+
+namespace {
+  SearchDocument document (const std::string& title, const std::string& link,
+                           const std::string& description = "") {
+    SearchDocument doc;
+    doc.title = title;
+    doc.link = link;
+    doc.description = description;
+    doc.channelId = 1;
+    doc.postedAt = 1700000000;
+    return doc;
+  }
+}
+
+class SearchIndexTest : public ::testing::Test {
+protected:
+  void SetUp () override {
+    directory_ = std::filesystem::temp_directory_path () / "botpp_search_test";
+    std::filesystem::remove_all (directory_);
+  }
+  void TearDown () override {
+    std::filesystem::remove_all (directory_);
+  }
+  std::filesystem::path directory_;
+};
+
+TEST (SearchTokenizerTest, FoldsCzechDiacritics) {
+  EXPECT_EQ (Search::tokenize ("Příliš žluťoučký kůň úpěl ďábelské ódy"),
+             (std::vector<std::string>{ "prilis", "zlutoucky", "kun", "upel", "dabelske", "ody" }));
+  EXPECT_EQ (Search::fold ("ŘEŠENÍ"), "reseni");
+}
+
+TEST (SearchTokenizerTest, SplitsOnPunctuationAndSkipsMarkup) {
+  EXPECT_EQ (Search::tokenize ("<p>Kernel 6.12 – „vydán“</p>"),
+             (std::vector<std::string>{ "kernel", "6", "12", "vydan" }));
+}
+
+TEST_F (SearchIndexTest, FindsDocumentsContainingAllTerms) {
+  SearchIndex index;
+  ASSERT_EQ (index.open (directory_), 0);
+  index.add (document ("Vyšel Linux kernel 6.12", "https://a/1", "Nové ovladače"));
+  index.add (document ("GNOME 47", "https://a/2", "Nové prostředí"));
+  index.add (document ("Kernel 6.13 rc1", "https://a/3"));
+
+  auto hits = index.search ("kernel 6");
+  ASSERT_EQ (hits.size (), 2u);
+  EXPECT_EQ (hits[0].document.link, "https://a/3"); // newest first
+  EXPECT_EQ (hits[1].document.link, "https://a/1");
+
+  hits = index.search ("NOVE ovladace");
+  ASSERT_EQ (hits.size (), 1u);
+  EXPECT_EQ (hits[0].document.title, "Vyšel Linux kernel 6.12");
+  EXPECT_TRUE (index.search ("windows").empty ());
+}
+
+TEST_F (SearchIndexTest, SameLinkIsReportedOnce) {
+  SearchIndex index;
+  ASSERT_EQ (index.open (directory_), 0);
+  index.add (document ("Rust 2024", "https://a/rust"));
+  index.add (document ("Rust 2024", "https://a/rust")); // fanned out to another channel
+  EXPECT_EQ (index.search ("rust").size (), 1u);
+}
+
+TEST_F (SearchIndexTest, SurvivesReopenWithAndWithoutFlush) {
+  {
+    SearchIndex index;
+    ASSERT_EQ (index.open (directory_), 0);
+    for (size_t i = 0; i < SearchIndex::FLUSH_DOCS + 3; ++i)
+      index.add (document ("zprava " + std::to_string (i), "https://a/" + std::to_string (i)));
+    EXPECT_EQ (index.getSegmentCount (), 1u);
+    // no close: the tail has to be recovered from the document store
+    std::filesystem::copy (directory_, directory_.string () + "_crash");
+  }
+  std::filesystem::remove_all (directory_);
+  std::filesystem::rename (directory_.string () + "_crash", directory_);
+
+  SearchIndex index;
+  ASSERT_EQ (index.open (directory_), 0);
+  EXPECT_EQ (index.getDocumentCount (), SearchIndex::FLUSH_DOCS + 3);
+  EXPECT_EQ (index.search ("zprava").size (), 10u);
+  auto last = index.search ("zprava " + std::to_string (SearchIndex::FLUSH_DOCS + 2));
+  ASSERT_EQ (last.size (), 1u);
+  EXPECT_EQ (index.search ("zprava 0").size (), 1u);
+}
+
+TEST_F (SearchIndexTest, SegmentsAreMerged) {
+  SearchIndex index;
+  ASSERT_EQ (index.open (directory_), 0);
+  for (size_t segment = 0; segment < SearchIndex::MERGE_FACTOR; ++segment) {
+    index.add (document ("spolecne slovo", "https://a/" + std::to_string (segment),
+                         "segment" + std::to_string (segment)));
+    index.flush ();
+  }
+  EXPECT_EQ (index.getSegmentCount (), 1u);
+  EXPECT_EQ (index.search ("spolecne", 100).size (), SearchIndex::MERGE_FACTOR);
+  EXPECT_EQ (index.search ("segment0").size (), 1u);
+  index.close ();
+
+  ASSERT_EQ (index.open (directory_), 0);
+  EXPECT_EQ (index.search ("spolecne slovo", 100).size (), SearchIndex::MERGE_FACTOR);
+}
+
+TEST_F (SearchIndexTest, OnlySimilarlySizedSegmentsAreMerged) {
+  SearchIndex index;
+  ASSERT_EQ (index.open (directory_), 0);
+  const size_t big = SearchIndex::MERGE_FACTOR * SearchIndex::MERGE_FACTOR;
+  for (size_t i = 0; i < big; ++i) {
+    index.add (document ("spolecne", "https://a/" + std::to_string (i)));
+    index.flush ();
+  }
+  ASSERT_EQ (index.getSegmentCount (), 1u);
+  auto bigSegment = directory_ / "seg_0000000000_0000000015.idx";
+  ASSERT_TRUE (std::filesystem::exists (bigSegment));
+  auto written = std::filesystem::last_write_time (bigSegment);
+
+  // Small segments merge among themselves, the big one is left alone
+  for (size_t i = big; i < big + SearchIndex::MERGE_FACTOR; ++i) {
+    index.add (document ("spolecne", "https://a/" + std::to_string (i)));
+    index.flush ();
+  }
+  EXPECT_EQ (index.getSegmentCount (), 2u);
+  EXPECT_EQ (std::filesystem::last_write_time (bigSegment), written);
+  EXPECT_EQ (index.search ("spolecne", 100).size (), big + SearchIndex::MERGE_FACTOR);
+
+  index.close ();
+  ASSERT_EQ (index.open (directory_), 0);
+  EXPECT_EQ (index.getSegmentCount (), 2u);
+  EXPECT_EQ (index.search ("spolecne", 100).size (), big + SearchIndex::MERGE_FACTOR);
+}
@@ -0,0 +1,176 @@
+// MIT License
+// Copyright (c) 2024-2025 Tomáš Mark
+// Rate-limit-aware send pipeline tests
+
+#include "../../src/DiscordBot/SendPipeline.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+  OutboundMessage item (const std::string& content, bool embedded = true) {
+    OutboundMessage message;
+    message.channelId = 1;
+    message.content = content;
+    message.embedded = embedded;
+    message.digestible = true;
+    return message;
+  }
+
+  template <typename Predicate>
+  bool waitFor (Predicate predicate, std::chrono::milliseconds limit) {
+    auto deadline = std::chrono::steady_clock::now () + limit;
+    while (std::chrono::steady_clock::now () < deadline) {
+      if (predicate ())
+        return true;
+      std::this_thread::sleep_for (1ms);
+    }
+    return predicate ();
+  }
+
+  // Records every request and answers with the prepared rate limit state
+  struct FakeTransport {
+    std::mutex mutex;
+    std::vector<std::string> sent;
+    std::vector<Scheduler::Clock::time_point> sentAt;
+    std::vector<RateLimitInfo> replies; // consumed in order, then plain success
+    uint64_t nextId = 100;
+
+    SendPipeline::Transport transport () {
+      return [this] (const OutboundMessage& message, SendPipeline::Done done) {
+        SendResult result;
+        {
+          std::lock_guard<std::mutex> lock (mutex);
+          sent.push_back (message.content);
+          sentAt.push_back (Scheduler::Clock::now ());
+          if (!replies.empty ()) {
+            result.limit = replies.front ();
+            replies.erase (replies.begin ());
+          }
+          result.ok = !result.limit.limited;
+          result.messageId = result.ok ? nextId++ : 0;
+        }
+        done (result);
+      };
+    }
+    size_t count () {
+      std::lock_guard<std::mutex> lock (mutex);
+      return sent.size ();
+    }
+  };
+}
+
+TEST (SendPipelineTest, TakeBatchMergesWithinLimit) {
+  std::deque<OutboundMessage> queue{ item ("aaaa"), item ("bbbb"), item ("cccc") };
+  size_t merged = 0;
+  OutboundMessage batch = SendPipeline::takeBatch (queue, 9, &merged);
+  EXPECT_EQ (batch.content, "aaaa\nbbbb");
+  EXPECT_EQ (merged, 2u);
+  ASSERT_EQ (queue.size (), 1u);
+  EXPECT_EQ (queue.front ().content, "cccc");
+}
+
+TEST (SendPipelineTest, TakeBatchMergesFailureCallbacks) {
+  int failed = 0;
+  std::deque<OutboundMessage> queue{ item ("a"), item ("b") };
+  for (auto& message : queue)
+    message.onFailed = [&failed] (uint16_t httpStatus) { failed += httpStatus == 403; };
+  OutboundMessage batch = SendPipeline::takeBatch (queue, 100);
+  ASSERT_TRUE (batch.onFailed);
+  batch.onFailed (403);
+  EXPECT_EQ (failed, 2);
+}
+
+TEST (SendPipelineTest, TakeBatchKeepsEmbedFlagsAndPlainMessagesApart) {
+  OutboundMessage plain = item ("notice");
+  plain.digestible = false;
+  std::deque<OutboundMessage> queue{ item ("a"), item ("b", false), plain, item ("c") };
+  EXPECT_EQ (SendPipeline::takeBatch (queue, 2000).content, "a");
+  EXPECT_EQ (SendPipeline::takeBatch (queue, 2000).content, "b");
+  EXPECT_EQ (SendPipeline::takeBatch (queue, 2000).content, "notice");
+  EXPECT_EQ (SendPipeline::takeBatch (queue, 2000).content, "c");
+}
+
+TEST (SendPipelineTest, WebhookMessagesUseTheirOwnBucket) {
+  OutboundMessage hooked = item ("a");
+  hooked.webhook = true;
+  hooked.username = "root.cz";
+  OutboundMessage other = item ("b");
+  other.webhook = true;
+  other.username = "lupa.cz";
+  EXPECT_NE (SendPipeline::routeOf (hooked), SendPipeline::routeOf (item ("a")));
+  EXPECT_EQ (SendPipeline::routeOf (item ("a")), SendPipeline::messagesRoute (1));
+
+  std::deque<OutboundMessage> queue{ hooked, other, item ("c") };
+  OutboundMessage batch = SendPipeline::takeBatch (queue, 2000);
+  EXPECT_EQ (batch.content, "a\nb");
+  EXPECT_TRUE (batch.webhook);
+  EXPECT_EQ (batch.username, ""); // several sources, the webhook's own name
+  EXPECT_EQ (SendPipeline::takeBatch (queue, 2000).content, "c");
+}
+
+TEST (SendPipelineTest, DigestReportsMessageIdToEveryItem) {
+  Scheduler scheduler (1ms);
+  FakeTransport fake;
+  SendPipeline pipeline (scheduler, fake.transport (), 2000);
+  std::atomic<int> created{ 0 };
+  for (int i = 0; i < 3; ++i) {
+    OutboundMessage message = item ("link" + std::to_string (i));
+    message.onCreated = [&] (uint64_t messageId) {
+      if (messageId == 100)
+        created++;
+    };
+    pipeline.enqueue (std::move (message));
+  }
+  scheduler.start (); // everything is queued before the first drain runs
+  EXPECT_TRUE (waitFor ([&] () { return created.load () == 3; }, 1000ms));
+  EXPECT_EQ (fake.count (), 1u);
+  EXPECT_EQ (pipeline.getDigestCount (), 1u);
+}
+
+TEST (SendPipelineTest, ExhaustedBucketDelaysNextRequest) {
+  Scheduler scheduler (1ms);
+  scheduler.start ();
+  FakeTransport fake;
+  RateLimitInfo exhausted;
+  exhausted.remaining = 0;
+  exhausted.resetAfter = 50ms;
+  fake.replies.push_back (exhausted);
+  SendPipeline pipeline (scheduler, fake.transport (), 2000);
+
+  OutboundMessage first = item ("first");
+  first.digestible = false;
+  OutboundMessage second = item ("second");
+  second.digestible = false;
+  pipeline.enqueue (std::move (first));
+  pipeline.enqueue (std::move (second));
+  ASSERT_TRUE (waitFor ([&] () { return fake.count () == 2; }, 1000ms));
+  EXPECT_GE (fake.sentAt[1] - fake.sentAt[0], 50ms);
+  EXPECT_EQ (fake.sent, (std::vector<std::string>{ "first", "second" }));
+}
+
+TEST (SendPipelineTest, RejectedRequestIsRetriedFirst) {
+  Scheduler scheduler (1ms);
+  scheduler.start ();
+  FakeTransport fake;
+  RateLimitInfo tooMany;
+  tooMany.limited = true;
+  tooMany.retryAfter = 20ms;
+  fake.replies.push_back (tooMany);
+  SendPipeline pipeline (scheduler, fake.transport (), 2000);
+
+  OutboundMessage first = item ("first");
+  first.digestible = false;
+  pipeline.enqueue (std::move (first));
+  ASSERT_TRUE (waitFor ([&] () { return fake.count () == 1; }, 1000ms));
+  OutboundMessage second = item ("second");
+  second.digestible = false;
+  pipeline.enqueue (std::move (second));
+  ASSERT_TRUE (waitFor ([&] () { return fake.count () == 3; }, 1000ms));
+  EXPECT_EQ (fake.sent, (std::vector<std::string>{ "first", "first", "second" }));
+  EXPECT_EQ (pipeline.getQueuedCount (), 0u);
+}
@@ -0,0 +1,85 @@
+// MIT License
+// Copyright (c) 2024-2025 Tomáš Mark
+// Service start-once and ordered shutdown tests
+
+#include "../../src/Lifecycle/ServiceLifecycle.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST (ServiceLifecycleTest, StartsOnceStopsInReverse) {
+  ServiceLifecycle services;
+  std::vector<std::string> log;
+  services.add ("store", nullptr, [&log] () { log.push_back ("stop store"); });
+  services.add ("fetch", [&log] () { log.push_back ("start fetch"); }, nullptr);
+  services.add (
+      "scheduler", [&log] () { log.push_back ("start scheduler"); },
+      [&log] () { log.push_back ("stop scheduler"); });
+
+  EXPECT_TRUE (services.startAll ());
+  EXPECT_FALSE (services.startAll ()); // a reconnect fires ready again
+  EXPECT_TRUE (services.isStarted ());
+  EXPECT_TRUE (services.stopAll (std::chrono::seconds (5)).empty ());
+  EXPECT_FALSE (services.isStarted ());
+  EXPECT_FALSE (services.startAll ());
+
+  EXPECT_EQ (log, (std::vector<std::string>{ "start fetch", "start scheduler", "stop scheduler",
+                                             "stop store" }));
+}
+
+TEST (ServiceLifecycleTest, StopsRunningServicesWithoutStart) {
+  ServiceLifecycle services;
+  int flushed = 0;
+  int stopped = 0;
+  services.add ("store", nullptr, [&flushed] () { flushed++; });
+  services.add ("scheduler", [] () {}, [&stopped] () { stopped++; });
+
+  // Signal before the bot was ready
+  EXPECT_TRUE (services.stopAll (std::chrono::seconds (5)).empty ());
+  EXPECT_TRUE (services.stopAll (std::chrono::seconds (5)).empty ());
+  EXPECT_EQ (flushed, 1);
+  EXPECT_EQ (stopped, 0);
+}
+
+TEST (ServiceLifecycleTest, DeadlineReportsHangingStop) {
+  ServiceLifecycle services;
+  auto release = std::make_shared<std::atomic<bool>> (false);
+  auto flushed = std::make_shared<std::atomic<bool>> (false);
+  services.add ("store", nullptr, [flushed] () { *flushed = true; });
+  services.add ("hanging", nullptr, [release] () {
+    while (!*release)
+      std::this_thread::sleep_for (std::chrono::milliseconds (5));
+  });
+
+  auto unfinished = services.stopAll (std::chrono::milliseconds (50));
+  EXPECT_EQ (unfinished, (std::vector<std::string>{ "hanging", "store" }));
+  EXPECT_FALSE (*flushed);
+
+  *release = true;
+  for (int i = 0; i < 200 && !*flushed; ++i)
+    std::this_thread::sleep_for (std::chrono::milliseconds (5));
+  EXPECT_TRUE (*flushed);
+}
+
+TEST (ServiceLifecycleTest, EssentialStopRunsWhenAnEarlierStepHangs) {
+  ServiceLifecycle services;
+  auto release = std::make_shared<std::atomic<bool>> (false);
+  auto flushed = std::make_shared<std::atomic<bool>> (false);
+  auto stopped = std::make_shared<std::atomic<bool>> (false);
+  services.add ("store", nullptr, [flushed] () { *flushed = true; }, true);
+  services.add ("gateway", nullptr, [stopped] () { *stopped = true; });
+  services.add ("hanging", nullptr, [release] () {
+    while (!*release)
+      std::this_thread::sleep_for (std::chrono::milliseconds (5));
+  });
+
+  auto unfinished
+      = services.stopAll (std::chrono::milliseconds (200), std::chrono::milliseconds (100));
+  EXPECT_EQ (unfinished, (std::vector<std::string>{ "hanging", "gateway" }));
+  EXPECT_TRUE (*flushed); // within the deadline
+  *release = true;
+  std::this_thread::sleep_for (std::chrono::milliseconds (20));
+  EXPECT_FALSE (*stopped); // the abandoned sequence does not go on
+}
@@ -0,0 +1,63 @@
+// MIT License
+// Copyright (c) 2024-2025 Tomáš Mark
+// Shard and channel ownership tests
+
+#include "../../src/DiscordBot/ShardOwnership.hpp"
+#include <gtest/gtest.h>
+
+namespace {
+  // Smallest guild id that lands on the shard
+  uint64_t guildOnShard (uint32_t shard) {
+    return static_cast<uint64_t> (shard) << 22;
+  }
+}
+
+TEST (ShardOwnershipTest, ShardOfFollowsDiscordFormula) {
+  EXPECT_EQ (ShardOwnership::shardOf (guildOnShard (3), 4), 3u);
+  EXPECT_EQ (ShardOwnership::shardOf (guildOnShard (5), 4), 1u);
+  EXPECT_EQ (ShardOwnership::shardOf (197038439483310086ull, 1), 0u);
+  EXPECT_EQ (ShardOwnership::shardOf (197038439483310086ull, 0), 0u);
+}
+
+TEST (ShardOwnershipTest, SingleClusterOwnsEverything) {
+  ShardOwnership ownership;
+  EXPECT_TRUE (ownership.isSingleCluster ());
+  EXPECT_TRUE (ownership.ownsChannel (12345));
+}
+
+TEST (ShardOwnershipTest, ClustersSplitChannelsByGuildShard) {
+  ShardConfig config;
+  config.shardCount = 4;
+  config.maxClusters = 2;
+  config.clusterId = 1;
+  ShardOwnership ownership (config);
+
+  EXPECT_TRUE (ownership.ownsShard (1));
+  EXPECT_TRUE (ownership.ownsShard (3));
+  EXPECT_FALSE (ownership.ownsShard (2));
+
+  ownership.addGuild (guildOnShard (3), { 10, 11 });
+  ownership.addGuild (guildOnShard (2), { 20 });
+  EXPECT_TRUE (ownership.ownsChannel (10));
+  EXPECT_FALSE (ownership.ownsChannel (20));
+  EXPECT_FALSE (ownership.ownsChannel (99)); // unknown until its guild arrives
+
+  ownership.addChannel (guildOnShard (3), 12);
+  EXPECT_TRUE (ownership.ownsChannel (12));
+  ownership.removeGuild (guildOnShard (3));
+  EXPECT_FALSE (ownership.ownsChannel (10));
+  EXPECT_EQ (ownership.getKnownChannelCount (), 1u);
+}
+
+TEST (ShardOwnershipTest, NormalizeFixesInconsistentConfig) {
+  ShardConfig config;
+  config.maxClusters = 3;
+  config.clusterId = 5;
+  EXPECT_EQ (config.normalize (), -1);
+  EXPECT_EQ (config.clusterId, 0u);
+  EXPECT_EQ (config.shardCount, 3u); // every process has to agree on it
+
+  ShardConfig single;
+  EXPECT_EQ (single.normalize (), 0);
+  EXPECT_EQ (single.shardCount, 0u);
+}
@@ -0,0 +1,71 @@
+// MIT License
+// Copyright (c) 2024-2025 Tomáš Mark
+// Single-flight fetch coordinator tests
+
+#include "../../src/RssManager/SingleFlight.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+TEST (SingleFlightTest, ConcurrentCallersShareOneRun) {
+  SingleFlight<int> flight;
+  std::atomic<int> runs{ 0 };
+  std::atomic<bool> release{ false };
+
+  auto slowFetch = [&] () {
+    runs++;
+    while (!release.load ())
+      std::this_thread::sleep_for (1ms);
+    return 42;
+  };
+
+  std::vector<std::thread> callers;
+  std::vector<int> results (8, 0);
+  callers.emplace_back ([&] () { results[0] = flight.run (slowFetch).get (); });
+  while (!flight.isInFlight ())
+    std::this_thread::sleep_for (1ms);
+  for (size_t i = 1; i < results.size (); ++i)
+    callers.emplace_back ([&, i] () { results[i] = flight.run (slowFetch).get (); });
+
+  std::this_thread::sleep_for (20ms);
+  release = true;
+  for (auto& caller : callers)
+    caller.join ();
+
+  EXPECT_EQ (runs.load (), 1);
+  for (int result : results)
+    EXPECT_EQ (result, 42);
+}
+
+TEST (SingleFlightTest, FreshResultIsReused) {
+  SingleFlight<int> flight (1h);
+  int runs = 0;
+  bool started = false;
+  EXPECT_EQ (flight.run ([&] () { return ++runs; }, &started).get (), 1);
+  EXPECT_TRUE (started);
+  EXPECT_EQ (flight.run ([&] () { return ++runs; }, &started).get (), 1);
+  EXPECT_FALSE (started);
+
+  flight.setFreshness (0s);
+  EXPECT_EQ (flight.run ([&] () { return ++runs; }).get (), 2);
+}
+
+TEST (SingleFlightTest, ForgottenResultIsNotReused) {
+  SingleFlight<int> flight (1h);
+  int runs = 0;
+  EXPECT_EQ (flight.run ([&] () { return ++runs; }).get (), 1);
+  flight.forget ();
+  EXPECT_EQ (flight.run ([&] () { return ++runs; }).get (), 2);
+  EXPECT_EQ (flight.run ([&] () { return ++runs; }).get (), 2);
+}
+
+TEST (SingleFlightTest, FailedRunIsNotReused) {
+  SingleFlight<int> flight (1h);
+  auto failing = flight.run ([] () -> int { throw std::runtime_error ("offline"); });
+  EXPECT_THROW (failing.get (), std::runtime_error);
+  EXPECT_EQ (flight.run ([] () { return 7; }).get (), 7);
+}
@@ -0,0 +1,81 @@
+// MIT License
+// Copyright (c) 2024-2025 Tomáš Mark
+// Native system information collector tests
+
+#include "../../src/SysInfo/SysInfo.hpp"
+#include <gtest/gtest.h>
+#include <string>
+
+TEST (SysInfoTest, ParsesMemInfo) {
+  const std::string sample = "MemTotal:       16257536 kB\n"
+                             "MemFree:         2412544 kB\n"
+                             "MemAvailable:   10387456 kB\n"
+                             "Buffers:          524288 kB\n"
+                             "Cached:          7340032 kB\n"
+                             "Shmem:            524288 kB\n"
+                             "SReclaimable:     524288 kB\n"
+                             "SwapTotal:       2097152 kB\n"
+                             "SwapFree:        2097152 kB\n";
+  SysInfo::MemInfo memory = SysInfo::parseMemInfo (sample);
+  EXPECT_EQ (memory.totalKb, 16257536u);
+  EXPECT_EQ (memory.availableKb, 10387456u);
+  EXPECT_EQ (memory.cachedKb, 7340032u + 524288u); // SReclaimable counts as cache
+  EXPECT_EQ (memory.swapFreeKb, 2097152u);
+
+  std::string table = SysInfo::renderFree (memory);
+  EXPECT_NE (table.find ("Mem:"), std::string::npos);
+  EXPECT_NE (table.find ("16Gi"), std::string::npos);
+  EXPECT_NE (table.find ("0B"), std::string::npos); // no swap used
+}
+
+TEST (SysInfoTest, ParsesLoadAvgAndCpuInfo) {
+  SysInfo::LoadAvg load = SysInfo::parseLoadAvg ("0.52 0.48 0.40 2/987 12345\n");
+  EXPECT_DOUBLE_EQ (load.one, 0.52);
+  EXPECT_DOUBLE_EQ (load.fifteen, 0.40);
+  EXPECT_EQ (load.running, 2u);
+  EXPECT_EQ (load.total, 987u);
+
+  SysInfo::CpuInfo cpu
+      = SysInfo::parseCpuInfo ("processor\t: 0\nmodel name\t: AMD Ryzen 7 5800X\n\n"
+                               "processor\t: 1\nmodel name\t: AMD Ryzen 7 5800X\n");
+  EXPECT_EQ (cpu.model, "AMD Ryzen 7 5800X");
+  EXPECT_EQ (cpu.threads, 2u);
+}
+
+TEST (SysInfoTest, ParsesOsReleaseAndMounts) {
+  auto os = SysInfo::parseOsRelease ("# comment\nNAME=\"Fedora Linux\"\nVERSION_ID=42\n"
+                                     "PRETTY_NAME='Fedora Linux 42'\n");
+  EXPECT_EQ (os["NAME"], "Fedora Linux");
+  EXPECT_EQ (os["VERSION_ID"], "42");
+  EXPECT_EQ (os["PRETTY_NAME"], "Fedora Linux 42");
+
+  auto mounts = SysInfo::parseMounts ("proc /proc proc rw 0 0\n"
+                                      "/dev/nvme0n1p2 / btrfs rw 0 0\n"
+                                      "tmpfs /tmp tmpfs rw 0 0\n"
+                                      "/dev/nvme0n1p2 /home btrfs rw 0 0\n"
+                                      "/dev/nvme0n1p1 /boot/efi vfat rw 0 0\n");
+  ASSERT_EQ (mounts.size (), 2u);
+  EXPECT_EQ (mounts[0].second, "/");
+  EXPECT_EQ (mounts[1].second, "/boot/efi");
+}
+
+TEST (SysInfoTest, FormatsLikeCoreutils) {
+  EXPECT_EQ (SysInfo::formatDf (500), "500");
+  EXPECT_EQ (SysInfo::formatDf (10ull << 30), "10G");
+  EXPECT_EQ (SysInfo::formatDf (9ull << 29), "4.5G");
+  EXPECT_EQ (SysInfo::formatFree (512ull << 20), "512Mi");
+  EXPECT_EQ (SysInfo::formatUptime (90061), "1 day, 1 hour, 1 min");
+  EXPECT_EQ (SysInfo::formatUptime (120), "2 mins");
+
+  SysInfo::FsUsage root{ "/dev/sda1", "/", 100ull << 30, 25ull << 30, 75ull << 30 };
+  std::string table = SysInfo::renderDf ({ root });
+  EXPECT_NE (table.find ("/dev/sda1"), std::string::npos);
+  EXPECT_NE (table.find ("25%"), std::string::npos);
+}
+
+TEST (SysInfoTest, CollectorServesFromCache) {
+  SysInfo::Collector collector (std::chrono::minutes (1));
+  std::string first = collector.get (SysInfo::Report::Summary);
+  EXPECT_NE (first.find ("Load:"), std::string::npos);
+  EXPECT_EQ (collector.get (SysInfo::Report::Summary), first); // within the TTL
+}
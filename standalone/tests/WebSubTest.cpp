@@ -0,0 +1,265 @@
+// MIT License
+// Copyright (c) 2024-2025 Tomáš Mark
+// WebSub push ingestion end to end with a local stand-in hub
+
+#include "../../src/Assets/AssetContext.hpp"
+#include "../../src/RssManager/RssManager.hpp"
+#include "../../src/WebSub/HttpServer.hpp"
+#include "../../src/WebSub/WebSubSubscriber.hpp"
+#include <gtest/gtest.h>
+#include <curl/curl.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace {
+  size_t CollectCallback (void* contents, size_t size, size_t nmemb, void* userp) {
+    static_cast<std::string*> (userp)->append (static_cast<char*> (contents), size * nmemb);
+    return size * nmemb;
+  }
+
+  // GET (body empty) or POST to url, returns HTTP status
+  long httpRequest (const std::string& url, const std::string& body, std::string* response,
+                    const std::string& signature = "") {
+    CURL* curl = curl_easy_init ();
+    std::string sink;
+    struct curl_slist* headers = nullptr;
+    headers = curl_slist_append (headers, "Content-Type: application/rss+xml");
+    if (!signature.empty ())
+      headers = curl_slist_append (headers, ("X-Hub-Signature: " + signature).c_str ());
+    curl_easy_setopt (curl, CURLOPT_URL, url.c_str ());
+    curl_easy_setopt (curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt (curl, CURLOPT_WRITEFUNCTION, CollectCallback);
+    curl_easy_setopt (curl, CURLOPT_WRITEDATA, response ? response : &sink);
+    if (!body.empty ())
+      curl_easy_setopt (curl, CURLOPT_POSTFIELDS, body.c_str ());
+    long status = 0;
+    if (curl_easy_perform (curl) == CURLE_OK)
+      curl_easy_getinfo (curl, CURLINFO_RESPONSE_CODE, &status);
+    curl_slist_free_all (headers);
+    curl_easy_cleanup (curl);
+    return status;
+  }
+
+  std::string rssDocument (const std::string& base, std::initializer_list<std::string> titles) {
+    std::string doc = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                      "<rss version=\"2.0\" xmlns:atom=\"http://www.w3.org/2005/Atom\"><channel>"
+                      "<title>Local</title><link>"
+                      + base + "</link><description>stand-in</description>"
+                      + "<atom:link rel=\"hub\" href=\"" + base + "/hub\"/>"
+                      + "<atom:link rel=\"self\" href=\"" + base + "/feed.xml\"/>";
+    for (const auto& title : titles)
+      doc += "<item><title>" + title + "</title><link>" + base + "/" + title
+             + "</link><description>d</description></item>";
+    return doc + "</channel></rss>";
+  }
+
+  // Serves the feed and acts as its hub: verifies the subscriber's intent, then pushes
+  class StandInHub {
+  public:
+    ~StandInHub () {
+      server.stop ();
+      if (worker.joinable ())
+        worker.join ();
+    }
+
+    void start () {
+      ASSERT_EQ (server.start ("127.0.0.1", 0,
+                               [this] (const HttpRequest& request) { return handle (request); }),
+                 0);
+      base = "http://127.0.0.1:" + std::to_string (server.port ());
+    }
+
+    HttpResponse handle (const HttpRequest& request) {
+      if (request.method == "GET" && request.path == "/feed.xml") {
+        feedRequests++;
+        return { 200, "application/rss+xml", rssDocument (base, { "first" }) };
+      }
+      if (request.method == "POST" && request.path == "/hub") {
+        auto form = HttpServer::parseQuery (request.body);
+        if (form["hub.mode"] != "subscribe")
+          return { 400, "text/plain", "" };
+        // verification and distribution happen asynchronously, like a real hub
+        worker = std::thread ([this, form] () mutable {
+          std::string challenge = "challenge-123";
+          std::string echoed;
+          std::string verifyUrl = form["hub.callback"] + "?hub.mode=subscribe&hub.topic="
+                                  + form["hub.topic"] + "&hub.challenge=" + challenge
+                                  + "&hub.lease_seconds=3600";
+          if (httpRequest (verifyUrl, "", &echoed) != 200 || echoed != challenge)
+            return;
+          verified = true;
+
+          std::string push = rssDocument (base, { "pushed-one", "pushed-two" });
+          httpRequest (form["hub.callback"], push, nullptr,
+                       WebSubSubscriber::signature (form["hub.secret"], push));
+          // a forged distribution must be ignored
+          httpRequest (form["hub.callback"], rssDocument (base, { "forged" }), nullptr,
+                       "sha256=00");
+          pushed = true;
+        });
+        return { 202, "text/plain", "" };
+      }
+      return { 404, "text/plain", "" };
+    }
+
+    HttpServer server;
+    std::string base;
+    std::thread worker;
+    std::atomic<int> feedRequests{ 0 };
+    std::atomic<bool> verified{ false };
+    std::atomic<bool> pushed{ false };
+  };
+}
+
+class WebSubTest : public ::testing::Test {
+protected:
+  void SetUp () override {
+    assetsDir_ = std::filesystem::temp_directory_path () / "botpp_websub_test";
+    std::filesystem::remove_all (assetsDir_);
+    std::filesystem::create_directories (assetsDir_);
+    AssetContext::setAssetsPath (assetsDir_);
+  }
+
+  void TearDown () override {
+    AssetContext::clearAssetsPath ();
+    std::filesystem::remove_all (assetsDir_);
+  }
+
+  std::filesystem::path assetsDir_;
+};
+
+TEST_F (WebSubTest, SignatureFormat) {
+  std::string sig = WebSubSubscriber::signature ("key", "body");
+  EXPECT_EQ (sig.rfind ("sha256=", 0), 0u);
+  EXPECT_EQ (sig.size (), 7u + 64u);
+  EXPECT_EQ (WebSubSubscriber::signature ("key", "body", "md4"), "");
+}
+
+TEST_F (WebSubTest, SlowClientIsCutOffAtTheRequestDeadline) {
+  HttpServer server;
+  server.setRequestTimeout (std::chrono::milliseconds (200));
+  auto handler = [] (const HttpRequest&) { return HttpResponse{ 200, "text/plain", "ok" }; };
+  ASSERT_EQ (server.start ("127.0.0.1", 0, handler), 0);
+
+  // Trickles a header byte at a time, each recv alone would stay within any per-call timeout
+  int slowFd = ::socket (AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons (server.port ());
+  ::inet_pton (AF_INET, "127.0.0.1", &addr.sin_addr);
+  ASSERT_EQ (::connect (slowFd, reinterpret_cast<sockaddr*> (&addr), sizeof (addr)), 0);
+  std::atomic<bool> done{ false };
+  std::thread slow ([&] () {
+    while (!done && ::send (slowFd, "X", 1, MSG_NOSIGNAL) == 1)
+      std::this_thread::sleep_for (std::chrono::milliseconds (20));
+  });
+  std::this_thread::sleep_for (std::chrono::milliseconds (50));
+
+  auto start = std::chrono::steady_clock::now ();
+  std::string response;
+  EXPECT_EQ (httpRequest ("http://127.0.0.1:" + std::to_string (server.port ()) + "/", "",
+                          &response),
+             200);
+  EXPECT_EQ (response, "ok");
+  EXPECT_LT (std::chrono::steady_clock::now () - start, std::chrono::seconds (2));
+
+  done = true;
+  slow.join ();
+  ::close (slowFd);
+  server.stop ();
+}
+
+TEST_F (WebSubTest, SecretGoesOnlyToHttpsOrLocalHubs) {
+  EXPECT_TRUE (WebSubSubscriber::isSecureHub ("https://pubsubhubbub.appspot.com/"));
+  EXPECT_TRUE (WebSubSubscriber::isSecureHub ("HTTPS://hub.example.com"));
+  EXPECT_TRUE (WebSubSubscriber::isSecureHub ("http://127.0.0.1:8080/hub"));
+  EXPECT_TRUE (WebSubSubscriber::isSecureHub ("http://localhost/hub"));
+  EXPECT_TRUE (WebSubSubscriber::isSecureHub ("http://[::1]:9000/hub"));
+  EXPECT_FALSE (WebSubSubscriber::isSecureHub ("http://hub.example.com/"));
+  EXPECT_FALSE (WebSubSubscriber::isSecureHub ("http://localhost.example.com/"));
+  EXPECT_FALSE (WebSubSubscriber::isSecureHub ("http://[::1].example.com/"));
+  EXPECT_FALSE (WebSubSubscriber::isSecureHub ("ftp://hub.example.com/"));
+}
+
+TEST_F (WebSubTest, PushedItemsAreQueuedAndPollingIsDemoted) {
+  StandInHub hub;
+  hub.start ();
+  const std::string feedUrl = hub.base + "/feed.xml";
+
+  std::ofstream (assetsDir_ / "rssUrls.json")
+      << "[{\"url\": \"" << feedUrl << "\", \"embedded\": false, \"discordChannelId\": 42}]";
+
+  RssManager rss;
+  ASSERT_EQ (rss.initialize (), 0);
+  WebSubOptions options;
+  options.bindAddress = "127.0.0.1";
+  options.port = 0;
+  ASSERT_EQ (rss.enableWebSub (options), 0);
+
+  // first poll discovers the hub and subscribes
+  EXPECT_EQ (rss.fetchAllFeeds (), 1);
+
+  auto deadline = std::chrono::steady_clock::now () + std::chrono::seconds (10);
+  while (!hub.pushed && std::chrono::steady_clock::now () < deadline)
+    std::this_thread::sleep_for (std::chrono::milliseconds (20));
+
+  EXPECT_TRUE (hub.verified);
+  EXPECT_TRUE (rss.isWebSubActive (feedUrl));
+  EXPECT_EQ (rss.getItemCount (), 3u); // polled item + two pushed, forged push dropped
+
+  // subscribed feed is not polled again until the safety net interval elapses
+  rss.fetchAllFeeds ();
+  EXPECT_EQ (hub.feedRequests, 1);
+
+  rss.disableWebSub ();
+}
+
+TEST_F (WebSubTest, UnverifiedSubscriptionIsRetriedAndUnsignedPushesDropped) {
+  // Accepts the subscription but never sends the verification GET
+  HttpServer silentHub;
+  ASSERT_EQ (silentHub.start ("127.0.0.1", 0,
+                              [] (const HttpRequest&) { return HttpResponse{ 202, "", "" }; }),
+             0);
+  std::string hubUrl = "http://127.0.0.1:" + std::to_string (silentHub.port ()) + "/hub";
+
+  std::atomic<int> received{ 0 };
+  auto onContent = [&received] (const std::string&, const std::string&, const std::string&) {
+    received++;
+  };
+  WebSubOptions options;
+  options.bindAddress = "127.0.0.1";
+  options.port = 0;
+
+  WebSubSubscriber patient;
+  ASSERT_EQ (patient.start (options, onContent), 0);
+  ASSERT_EQ (patient.subscribe (hubUrl, "https://example.org/a.xml"), 0);
+  EXPECT_FALSE (patient.needsRenewal ("https://example.org/a.xml", std::chrono::hours (24)));
+
+  options.verifyTimeoutSeconds = 0;
+  WebSubSubscriber impatient;
+  ASSERT_EQ (impatient.start (options, onContent), 0);
+  ASSERT_EQ (impatient.subscribe (hubUrl, "https://example.org/b.xml"), 0);
+  EXPECT_TRUE (impatient.needsRenewal ("https://example.org/b.xml", std::chrono::hours (24)));
+
+  // Callback ids are the hex hash of the topic
+  std::ostringstream id;
+  id << std::hex << std::hash<std::string>{}("https://example.org/a.xml");
+  std::string push = rssDocument (hubUrl, { "unsigned" });
+  EXPECT_EQ (httpRequest (patient.getCallbackUrl (id.str ()), push, nullptr), 200);
+  EXPECT_EQ (httpRequest (patient.getCallbackUrl (id.str ()), push, nullptr, "sha256=00"), 200);
+  EXPECT_EQ (received, 0);
+  EXPECT_EQ (httpRequest (patient.getCallbackUrl (id.str ()), push, nullptr,
+                          WebSubSubscriber::signature ("guessed", push)),
+             200);
+  EXPECT_EQ (received, 0);
+  silentHub.stop ();
+}
@@ -0,0 +1,54 @@
+// MIT License
+// Copyright (c) 2024-2025 Tomáš Mark
+// Webhook delivery mode tests
+
+#include "../../src/DiscordBot/WebhookCache.hpp"
+#include <gtest/gtest.h>
+
+TEST (WebhookCacheTest, ReusesOwnExecutableWebhook) {
+  std::vector<WebhookCandidate> candidates{ { 1, "Bot++ feeds", "" },
+                                            { 2, "someone else", "t2" },
+                                            { 3, "Bot++ feeds", "t3" } };
+  auto picked = WebhookCache::pick (candidates, "Bot++ feeds");
+  ASSERT_TRUE (picked.has_value ());
+  EXPECT_EQ (picked->id, 3u);
+  EXPECT_EQ (picked->token, "t3");
+  EXPECT_FALSE (WebhookCache::pick (candidates, "other").has_value ());
+}
+
+TEST (WebhookCacheTest, ForgetsDeletedWebhook) {
+  WebhookCache cache;
+  EXPECT_FALSE (cache.get (10).has_value ());
+  cache.set (10, { 3, "t3" });
+  ASSERT_TRUE (cache.get (10).has_value ());
+  EXPECT_EQ (cache.get (10)->id, 3u);
+  cache.remove (10);
+  EXPECT_FALSE (cache.get (10).has_value ());
+  EXPECT_EQ (cache.size (), 0u);
+}
+
+TEST (WebhookCacheTest, FailureIsCachedForItsTtl) {
+  WebhookCache cache (std::chrono::minutes (10));
+  auto now = WebhookCache::Clock::now ();
+  EXPECT_FALSE (cache.hasFailed (10, now));
+  EXPECT_TRUE (cache.markFailed (10, now));
+  EXPECT_TRUE (cache.hasFailed (10, now + std::chrono::minutes (9)));
+  EXPECT_FALSE (cache.markFailed (10, now + std::chrono::minutes (1))); // logged already
+  EXPECT_FALSE (cache.hasFailed (10, now + std::chrono::minutes (12)));
+  EXPECT_TRUE (cache.markFailed (10, now + std::chrono::minutes (12)));
+
+  cache.set (10, { 3, "t3" }); // e.g. the permission was granted and a retry succeeded
+  EXPECT_FALSE (cache.hasFailed (10, now + std::chrono::minutes (13)));
+
+  EXPECT_TRUE (cache.disable (20));
+  EXPECT_FALSE (cache.disable (20));
+  EXPECT_TRUE (cache.isDisabled (20));
+  EXPECT_FALSE (cache.isDisabled (10));
+}
+
+TEST (WebhookCacheTest, SourceNameIsTheFeedHost) {
+  EXPECT_EQ (WebhookCache::sourceName ("https://www.root.cz/rss/clanky/"), "root.cz");
+  EXPECT_EQ (WebhookCache::sourceName ("https://9to5Linux.com/feed/atom"), "9to5linux.com");
+  EXPECT_EQ (WebhookCache::sourceName ("http://example.org:8080?x=1"), "example.org");
+  EXPECT_EQ (WebhookCache::sourceName (""), "");
+}
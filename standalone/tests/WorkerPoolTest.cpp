@@ -0,0 +1,104 @@
+// MIT License
+// Copyright (c) 2024-2025 Tomáš Mark
+// Bounded worker pool tests
+
+#include "../../src/WorkerPool/WorkerPool.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+
+using namespace std::chrono_literals;
+
+TEST (WorkerPoolTest, RunsEverySubmittedTask) {
+  std::atomic<int> done{ 0 };
+  {
+    WorkerPool pool (3, 100);
+    for (int i = 0; i < 50; ++i)
+      EXPECT_TRUE (pool.submit ("job", [&] () { done++; }));
+    for (int i = 0; i < 200 && done.load () < 50; ++i)
+      std::this_thread::sleep_for (5ms);
+  }
+  EXPECT_EQ (done.load (), 50);
+}
+
+TEST (WorkerPoolTest, StopDropsQueuedTasks) {
+  std::atomic<int> done{ 0 };
+  WorkerPool pool (1, 100);
+  std::promise<void> release;
+  std::shared_future<void> gate = release.get_future ().share ();
+  std::promise<void> started;
+  ASSERT_TRUE (pool.submit ("fetch", [&, gate] () {
+    started.set_value ();
+    gate.wait ();
+    done++;
+  }));
+  started.get_future ().wait ();
+  for (int i = 0; i < 5; ++i)
+    EXPECT_TRUE (pool.submit ("fetch", [&] () { done++; }));
+
+  auto stopped = std::async (std::launch::async, [&pool] () { pool.stop (); });
+  std::this_thread::sleep_for (20ms);
+  release.set_value (); // the running task finishes, the queued ones never start
+  stopped.get ();
+  EXPECT_EQ (done.load (), 1);
+  EXPECT_EQ (pool.getQueued (), 0u);
+}
+
+TEST (WorkerPoolTest, KeyLimitCapsConcurrency) {
+  WorkerPool pool (4, 100);
+  pool.setLimit ("slow", 1);
+  std::atomic<int> running{ 0 };
+  std::atomic<int> peak{ 0 };
+  std::atomic<int> done{ 0 };
+  for (int i = 0; i < 6; ++i) {
+    pool.submit ("slow", [&] () {
+      int now = ++running;
+      int seen = peak.load ();
+      while (now > seen && !peak.compare_exchange_weak (seen, now)) {
+      }
+      std::this_thread::sleep_for (2ms);
+      running--;
+      done++;
+    });
+  }
+  for (int i = 0; i < 200 && done.load () < 6; ++i)
+    std::this_thread::sleep_for (5ms);
+  pool.stop ();
+  EXPECT_EQ (done.load (), 6);
+  EXPECT_EQ (peak.load (), 1);
+}
+
+TEST (WorkerPoolTest, SaturatedKeyDoesNotBlockOthers) {
+  WorkerPool pool (2, 100);
+  pool.setLimit ("slow", 1);
+  std::promise<void> release;
+  std::shared_future<void> gate = release.get_future ().share ();
+  pool.submit ("slow", [gate] () { gate.wait (); });
+  pool.submit ("slow", [gate] () { gate.wait (); }); // waits for the first one
+  std::promise<void> fast;
+  pool.submit ("fast", [&] () { fast.set_value (); });
+  EXPECT_EQ (fast.get_future ().wait_for (1s), std::future_status::ready);
+  release.set_value ();
+}
+
+TEST (WorkerPoolTest, FullQueueRefusesTasks) {
+  WorkerPool pool (1, 2);
+  std::promise<void> release;
+  std::shared_future<void> gate = release.get_future ().share ();
+  std::promise<void> started;
+  ASSERT_TRUE (pool.submit ("block", [&, gate] () {
+    started.set_value ();
+    gate.wait ();
+  }));
+  started.get_future ().wait (); // the worker holds the first task, the queue is empty
+  EXPECT_TRUE (pool.submit ("a", [] () {}));
+  EXPECT_TRUE (pool.submit ("b", [] () {}));
+  EXPECT_FALSE (pool.submit ("c", [] () {}));
+  EXPECT_EQ (pool.getQueued (), 2u);
+  EXPECT_EQ (pool.getRunning (), 1u);
+  release.set_value ();
+  pool.stop ();
+  EXPECT_FALSE (pool.submit ("late", [] () {}));
+}